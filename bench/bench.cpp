@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "assemble.h"
+#include "context.h"
+#include "corpus.h"
+#include "dksh.h"
+#include "nxas.h"
+#include "opcode.h"
+#include "parse.h"
+#include "regalloc.h"
+#include "token.h"
+
+struct family
+{
+    const char* name;
+
+    // Instructions repeated to build the corpus, '#' is replaced by the index of the repetition
+    // to keep labels unique
+    std::span<const char* const> lines;
+};
+
+static constexpr const char* integer_lines[]{
+    "IADD R0, R1, R2",
+    "IADD32I R3, R0, 0x10",
+    "ISCADD R4, R0, R3, 0x2",
+    "LOP.AND PT, R5, R4, 0xff",
+    "SHL R6, R5, 0x3",
+    "SHR.U32 R7, R6, 0x1",
+    "XMAD R8, R7, R6, RZ",
+    "ISETP.LT.AND P0, PT, R8, R1, PT",
+};
+
+static constexpr const char* float_lines[]{
+    "FADD R0, R1, R2",
+    "FMUL R3, R0, 0.5",
+    "FFMA R4, R0, R3, R1",
+    "FMUL32I R5, R4, 2.5",
+    "FSETP.LT.AND P0, PT, R5, R4, PT",
+    "MUFU.RCP R6, R5",
+    "F2I.S32.F32 R7, R6",
+    "I2F.F32.S32 R8, R7",
+};
+
+static constexpr const char* memory_lines[]{
+    "LDG.E R0, [R2]",
+    "STG.E [R2+0x4], R0",
+    "LDS R1, [R3+0x10]",
+    "STS [R3+0x20], R1",
+    "LDC.32 R4, c[0x0][R5+0x8]",
+    "ALD R6, a[0x70]",
+    "AST a[0x80], R6",
+};
+
+static constexpr const char* texture_lines[]{
+    "TEXS R2, R4, R6, R8, 0x28, 2D, RGBA",
+    "TLDS.LZ R4, R6, R8, R2, 0x28, 1D, RGBA",
+    "TEX P3, R0, R2, R4, 0x13, 2D, 0xf",
+    "TLD.LZ P4, R4, R2, R7, 0x28, 2D, 0xf",
+};
+
+static constexpr const char* control_flow_lines[]{
+    "SSY end_#",
+    "@P0 BRA skip_#",
+    "skip_#:",
+    "SYNC",
+    "end_#:",
+    "@P1 BRA end_#",
+    "KIL",
+};
+
+static constexpr family families[]{
+    {"integer", integer_lines},
+    {"float", float_lines},
+    {"memory", memory_lines},
+    {"texture", texture_lines},
+    {"control flow", control_flow_lines},
+};
+
+// Program with a DKSH header so write_dksh can pack it, lines ending with ':' are labels
+static std::string build_corpus(const family& family, size_t num_instructions)
+{
+    std::string code = ".dksh fragment\nmain:\n";
+    size_t num_emitted = 0;
+    for (size_t index = 0; num_emitted < num_instructions; ++index) {
+        const std::string_view line = family.lines[index % family.lines.size()];
+        const std::string repetition = std::to_string(index / family.lines.size());
+        const bool is_label = line.ends_with(':');
+        if (!is_label) {
+            code += "    ";
+            ++num_emitted;
+        }
+        for (const char character : line) {
+            if (character == '#') {
+                code += repetition;
+            } else {
+                code += character;
+            }
+        }
+        code += is_label ? "\n" : ";\n";
+    }
+    code += "    EXIT;\n";
+    return code;
+}
+
+struct statistics
+{
+    double median;
+    double min;
+    double max;
+
+    // Median absolute deviation relative to the median
+    double spread;
+};
+
+static statistics compute_statistics(std::vector<double> samples)
+{
+    std::ranges::sort(samples);
+    const double median = samples[samples.size() / 2];
+    std::vector<double> deviations;
+    for (const double sample : samples) {
+        deviations.push_back(sample > median ? sample - median : median - sample);
+    }
+    std::ranges::sort(deviations);
+    return {
+        .median = median,
+        .min = samples.front(),
+        .max = samples.back(),
+        .spread = deviations[deviations.size() / 2] / median,
+    };
+}
+
+static void print_header()
+{
+    std::printf("%-16s %-13s %8s %10s %10s %10s %8s %13s\n", "stage", "family", "insns",
+                "median ns", "min ns", "max ns", "spread", "insns/s");
+}
+
+// Runs a stage once to warm it up and then as many times as repetitions, setup runs untimed before
+// each run and returns the state the stage works on
+template <typename Setup, typename Stage>
+static void measure(const char* stage_name, const char* family_name, size_t num_instructions,
+                    int repetitions, Setup&& setup, Stage&& stage)
+{
+    std::vector<double> samples;
+    for (int repetition = 0; repetition <= repetitions; ++repetition) {
+        auto state = setup();
+        const auto start = std::chrono::steady_clock::now();
+        stage(state);
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (repetition > 0) {
+            samples.push_back(elapsed.count() / static_cast<double>(num_instructions));
+        }
+    }
+    const statistics stats = compute_statistics(std::move(samples));
+    std::printf("%-16s %-13s %8zu %10.1f %10.1f %10.1f %7.1f%% %13.0f\n", stage_name, family_name,
+                num_instructions, stats.median, stats.min, stats.max, stats.spread * 100,
+                1e9 / stats.median);
+}
+
+// Peak resident memory of the process in bytes, zero where it isn't known
+static size_t peak_memory()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Keeps results alive so stages aren't optimized away
+static volatile uint64_t sink;
+
+static void run_family(const family& family, size_t num_instructions, int repetitions)
+{
+    const std::string code = build_corpus(family, num_instructions);
+    const char* const text = code.c_str();
+    const size_t count = num_instructions + 1;
+
+    measure(
+        "tokenize", family.name, count, repetitions,
+        [&] { return std::make_unique<context>("bench", text); },
+        [](auto& ctx) {
+            uint64_t num_tokens = 0;
+            while (ctx->tokenize().type != token_type::none) {
+                ++num_tokens;
+            }
+            sink = num_tokens;
+        });
+
+    // Labels are generated when a context is created
+    measure(
+        "generate_labels", family.name, count, repetitions, [] { return 0; },
+        [&](int) {
+            context ctx("bench", text);
+            sink = ctx.label_addresses().size();
+        });
+
+    measure(
+        "parse", family.name, count, repetitions,
+        [&] { return std::make_unique<context>("bench", text); },
+        [&](auto& ctx) {
+            std::vector<virtual_gpr> virtual_gprs;
+            ctx->virtual_gprs = &virtual_gprs;
+            std::vector<opcode> opcodes(count + 1);
+            size_t index = 0;
+            while (parse_instruction(*ctx, opcodes[index++])) {
+                ctx->skip_line_end();
+            }
+            sink = index;
+        });
+
+    context ctx("bench", text);
+    const encoded_program program =
+        finish_program(ctx, parse_program(ctx, code).opcodes, {}, nullptr);
+    measure(
+        "bundle", family.name, count, repetitions, [] { return 0; },
+        [&](int) { sink = bundle(program.opcodes).size(); });
+
+    const dksh_program dksh = ctx.dksh(bundle(program.opcodes), program.usage);
+    measure(
+        "write_dksh", family.name, count, repetitions, [] { return 0; },
+        [&](int) { sink = write_dksh(std::span(&dksh, 1)).size(); });
+
+    measure(
+        "assemble", family.name, count, repetitions, [] { return 0; },
+        [&](int) { sink = nxas::assemble(code, "bench").size(); });
+}
+
+// Emits the same program a code generator would as text and through a builder, the text is
+// formatted on each run because generators pay for formatting it too. The builder encodes each
+// instruction as it's added and saves formatting, lexing, the label scan and mnemonic lookups.
+static void run_builder(size_t num_instructions, int repetitions)
+{
+    const size_t count = num_instructions + 1;
+    measure(
+        "format+assemble", "builder", count, repetitions, [] { return 0; },
+        [&](int) {
+            std::string code = ".dksh compute\nmain:\n";
+            for (size_t index = 0; index < num_instructions; ++index) {
+                const int dst = static_cast<int>(index % 32);
+                code += "    FFMA R" + std::to_string(dst) + ", R" + std::to_string(dst + 1) +
+                        ", -R" + std::to_string(dst + 2) + ", c[0x0][" +
+                        std::to_string(index % 64 * 4) + "];\n";
+            }
+            code += "    EXIT;\n";
+            sink = nxas::assemble(code, "bench").size();
+        });
+    measure(
+        "build+finish", "builder", count, repetitions, [] { return 0; },
+        [&](int) {
+            nxas::builder emit(".dksh compute\n", "bench");
+            emit.place(emit.make_label("main"));
+            for (size_t index = 0; index < num_instructions; ++index) {
+                const int dst = static_cast<int>(index % 32);
+                emit.ffma(nxas::gpr(dst), nxas::gpr(dst + 1), nxas::neg(nxas::gpr(dst + 2)),
+                          nxas::constant_buffer(0, static_cast<int64_t>(index % 64 * 4)));
+            }
+            emit.exit();
+            sink = emit.finish().size();
+        });
+}
+
+// Assembles generated programs growing ten times each step, sizes run from small to large so the
+// peak memory of the process is the peak of the largest program assembled so far
+static void run_scaling(size_t max_instructions, int repetitions)
+{
+    for (size_t size = 1000;; size = std::min(size * 10, max_instructions)) {
+        const std::string code = generate_corpus({.num_instructions = size});
+        const size_t count = size + 1;
+
+        // Large programs take long enough to time with fewer runs
+        const int num_runs = static_cast<int>(
+            std::clamp<size_t>(1'000'000 / size, 1, static_cast<size_t>(repetitions)));
+        measure(
+            "assemble", "corpus", count, num_runs, [] { return 0; },
+            [&](int) { sink = nxas::assemble(code, "corpus").size(); });
+        std::printf("%-16s %-13s %8zu %10.1f MiB peak\n", "memory", "corpus", count,
+                    static_cast<double>(peak_memory()) / (1024 * 1024));
+        if (size == max_instructions) {
+            break;
+        }
+    }
+}
+
+static void usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "%s usage: [--instructions <count>] [--repetitions <count>] "
+                 "[--scaling <max instructions>]\n",
+                 program);
+    std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_instructions = 3000;
+    int repetitions = 10;
+    size_t max_scaling = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--instructions") == 0 && i + 1 < argc) {
+            num_instructions = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--scaling") == 0 && i + 1 < argc) {
+            max_scaling = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (num_instructions == 0 || repetitions <= 0) {
+        usage(argv[0]);
+    }
+
+    print_header();
+    if (max_scaling > 0) {
+        run_scaling(max_scaling, repetitions);
+        return 0;
+    }
+    for (const family& family : families) {
+        run_family(family, num_instructions, repetitions);
+    }
+    run_builder(num_instructions, repetitions);
+}
@@ -0,0 +1,25 @@
+# Assembles shaders while building a target into headers defining a constexpr std::array named
+# after each shader, programs include "<shader name>.h" and pay no cost to assemble them at runtime.
+#
+#   nxas_embed_shaders(<target> [OPTIONS <nxas options>...] SOURCES <shader>...)
+function(nxas_embed_shaders target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "" "OPTIONS;SOURCES")
+    set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/nxas_shaders/${target}")
+    set(headers)
+    foreach(source IN LISTS ARG_SOURCES)
+        get_filename_component(path "${source}" ABSOLUTE)
+        get_filename_component(name "${source}" NAME_WE)
+        set(header "${output_dir}/${name}.h")
+        add_custom_command(
+            OUTPUT "${header}"
+            COMMAND "${CMAKE_COMMAND}" -E make_directory "${output_dir}"
+            COMMAND nxas ${ARG_OPTIONS} --format header -o "${header}" "${path}"
+            DEPENDS nxas "${path}"
+            COMMENT "Assembling shader ${source}"
+            VERBATIM
+        )
+        list(APPEND headers "${header}")
+    endforeach()
+    target_sources(${target} PRIVATE ${headers})
+    target_include_directories(${target} PRIVATE "${output_dir}")
+endfunction()
@@ -0,0 +1,210 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#else
+#include <cerrno>
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "nxas.h"
+
+// Larger inputs only take longer without reaching new code, budgets are tuned for this size
+constexpr size_t MAX_INPUT_SIZE = size_t{1} << 20;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (size > MAX_INPUT_SIZE) {
+        return -1;
+    }
+    const std::string code(reinterpret_cast<const char*>(data), size);
+    try {
+        const std::vector<uint64_t> binary = nxas::assemble(code, "fuzz");
+
+        // Code that assembles has to disassemble, disassembly is not fed back because
+        // directives are lost
+        static_cast<void>(nxas::disassemble(binary));
+    } catch (const nxas::assembly_error&) {
+        // Rejecting the input is a valid outcome
+    }
+    return 0;
+}
+
+#ifndef NXAS_LIBFUZZER
+
+// Runs inputs through the harness when nxas isn't linked with libFuzzer, flags take the syntax of
+// libFuzzer so both builds run the corpus with the same command. Without inputs a single one is
+// read from stdin, the way AFL feeds inputs.
+
+struct budget
+{
+    // Seconds an input can take, zero disables it
+    unsigned timeout = 0;
+
+    // Peak resident memory of an input in MiB, zero disables it
+    unsigned rss_limit_mb = 0;
+};
+
+#ifdef _WIN32
+
+// Inputs run in the driver's process, a watchdog ends it when one runs past the timeout. Peak
+// memory isn't known and isn't checked.
+static bool run_budgeted(const std::string& name, const std::string& data, const budget& budget)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool is_done = false;
+    std::thread watchdog([&] {
+        if (budget.timeout == 0) {
+            return;
+        }
+        std::unique_lock lock{mutex};
+        const std::chrono::seconds timeout{budget.timeout};
+        if (!condition.wait_for(lock, timeout, [&] { return is_done; })) {
+            std::fprintf(stderr, "%s: timeout after %u s\n", name.c_str(), budget.timeout);
+            std::_Exit(EXIT_FAILURE);
+        }
+    });
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    {
+        const std::scoped_lock lock{mutex};
+        is_done = true;
+    }
+    condition.notify_one();
+    watchdog.join();
+    return true;
+}
+
+#else
+
+// Each input runs in a child process, the alarm ends it once the timeout passes and its peak
+// memory is its own rather than the driver's lifetime peak. The child starts with the memory of
+// the driver, which only holds the input and the tables built before forking.
+static bool run_budgeted(const std::string& name, const std::string& data, const budget& budget)
+{
+    std::fflush(nullptr);
+    const pid_t child = fork();
+    if (child < 0) {
+        std::fprintf(stderr, "%s: failed to fork: %s\n", name.c_str(), std::strerror(errno));
+        return false;
+    }
+    if (child == 0) {
+        alarm(budget.timeout);
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+        std::_Exit(0);
+    }
+    int status = 0;
+    rusage usage{};
+    while (wait4(child, &status, 0, &usage) < 0) {
+        if (errno != EINTR) {
+            std::fprintf(stderr, "%s: failed to wait: %s\n", name.c_str(), std::strerror(errno));
+            return false;
+        }
+    }
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        std::fprintf(stderr, "%s: timeout after %u s\n", name.c_str(), budget.timeout);
+        return false;
+    }
+    if (WIFSIGNALED(status)) {
+        std::fprintf(stderr, "%s: crashed: %s\n", name.c_str(), strsignal(WTERMSIG(status)));
+        return false;
+    }
+    if (WEXITSTATUS(status) != 0) {
+        std::fprintf(stderr, "%s: exited with status %d\n", name.c_str(), WEXITSTATUS(status));
+        return false;
+    }
+    const size_t peak = static_cast<size_t>(usage.ru_maxrss) / 1024;
+    if (budget.rss_limit_mb != 0 && peak > budget.rss_limit_mb) {
+        std::fprintf(stderr, "%s: peak memory of %zu MiB exceeds %u MiB\n", name.c_str(), peak,
+                     budget.rss_limit_mb);
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+// Returns true when the input runs within the budget, inputs without a budget run in the driver's
+// process so fuzzers see their crashes
+static bool run_input(const std::string& name, const std::string& data, const budget& budget)
+{
+    if (budget.timeout == 0 && budget.rss_limit_mb == 0) {
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+        return true;
+    }
+    return run_budgeted(name, data, budget);
+}
+
+static bool parse_flag(const char* argument, const char* name, unsigned& value)
+{
+    const size_t length = std::strlen(name);
+    if (std::strncmp(argument, name, length) != 0 || argument[length] != '=') {
+        return false;
+    }
+    value = static_cast<unsigned>(std::strtoul(argument + length + 1, nullptr, 10));
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    budget budget;
+    std::vector<std::filesystem::path> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (parse_flag(argv[i], "-timeout", budget.timeout) ||
+            parse_flag(argv[i], "-rss_limit_mb", budget.rss_limit_mb)) {
+            continue;
+        }
+        // Other libFuzzer flags only matter when mutating inputs
+        if (argv[i][0] == '-') {
+            continue;
+        }
+        const std::filesystem::path path = argv[i];
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                inputs.push_back(entry.path());
+            }
+        } else {
+            inputs.push_back(path);
+        }
+    }
+    // Build the tables once, children forked for each input share them
+    static_cast<void>(nxas::assemble("EXIT;\n", "warm-up"));
+
+    if (inputs.empty()) {
+        const std::string data{std::istreambuf_iterator<char>(std::cin), {}};
+        return run_input("stdin", data, budget) ? 0 : EXIT_FAILURE;
+    }
+
+    size_t num_failures = 0;
+    for (const std::filesystem::path& input : inputs) {
+        std::ifstream file(input, std::ios::binary);
+        if (!file.is_open()) {
+            std::fprintf(stderr, "%s: failed to open\n", input.string().c_str());
+            return EXIT_FAILURE;
+        }
+        const std::string data{std::istreambuf_iterator<char>(file), {}};
+        if (!run_input(input.string(), data, budget)) {
+            ++num_failures;
+        }
+    }
+    std::printf("%zu/%zu inputs ran within budget\n", inputs.size() - num_failures, inputs.size());
+    return num_failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+#endif
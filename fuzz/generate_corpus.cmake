@@ -0,0 +1,35 @@
+# Writes the seeds too large to keep in git into OUTPUT_DIR, at the sizes that found regressions:
+# - label_run holds 100K labels, that many overflowed the stack while labels were skipped by
+#   recursion
+# - virtual_registers chains 40K virtual registers, the count at which liveness as a bitset of
+#   every register for every instruction took seconds
+#
+#   cmake -DOUTPUT_DIR=<directory> -P generate_corpus.cmake
+
+# Appends a line for each number from first to last, @i@ in the line is the number and @previous@
+# the number before it. Lines are written in chunks, appending all of them to one string is
+# quadratic.
+function(append_lines path first last line)
+    set(chunk "")
+    foreach(i RANGE ${first} ${last})
+        math(EXPR previous "${i} - 1")
+        string(CONFIGURE "${line}" expanded @ONLY)
+        string(APPEND chunk "${expanded}\n")
+        math(EXPR in_chunk "${i} % 1000")
+        if (in_chunk EQUAL 0)
+            file(APPEND "${path}" "${chunk}")
+            set(chunk "")
+        endif()
+    endforeach()
+    file(APPEND "${path}" "${chunk}")
+endfunction()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+file(WRITE "${OUTPUT_DIR}/label_run" "")
+append_lines("${OUTPUT_DIR}/label_run" 0 99999 "L@i@:")
+file(APPEND "${OUTPUT_DIR}/label_run" "EXIT;\n")
+
+file(WRITE "${OUTPUT_DIR}/virtual_registers" "MOV32I %v0,0x1;\n")
+append_lines("${OUTPUT_DIR}/virtual_registers" 1 39999 "IADD %v@i@,%v@previous@,RZ;")
+file(APPEND "${OUTPUT_DIR}/virtual_registers" "STG.E [RZ],%v39999;\nEXIT;\n")
@@ -1,11 +1,419 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace nxas {
 
-std::vector<uint64_t> assemble(const std::string& code, const char* filename = "file");
+// Thrown by every function of the library when its input is invalid, what() is formatted like the
+// command line prints it, terminal colors included
+class assembly_error : public std::runtime_error
+{
+  public:
+    assembly_error(const std::string& what, std::string file_, int line_, int column_,
+                   std::string message_)
+        : std::runtime_error{what}, file{std::move(file_)}, line{line_}, column{column_},
+          message{std::move(message_)}
+    {
+    }
+
+    // Source the error is at, empty with a zero line and column when it isn't at a position.
+    // Lines and columns start at one.
+    std::string file;
+    int line = 0;
+    int column = 0;
+
+    // Message without its position and without terminal colors
+    std::string message;
+};
+
+// Resources programmed in the header of an assembled program
+struct program_resources
+{
+    int num_gprs = 0;
+    std::array<unsigned, 3> block_dimensions = {1, 1, 1};
+    int shared_mem_size = 0;
+    int local_mem_size = 0;
+    int crs_size = 0;
+    int per_warp_scratch_size = 0;
+    int num_barriers = 0;
+    bool is_compute = false;
+};
+
+enum class occupancy_limit
+{
+    warps,
+    blocks,
+    registers,
+    shared_memory,
+};
+
+struct occupancy
+{
+    int warps_per_block = 0;
+    int blocks_per_sm = 0;
+    int warps_per_sm = 0;
+    int max_warps_per_sm = 0;
+    occupancy_limit limit = occupancy_limit::warps;
+
+    // Scratch memory backing the resident warps of a single SM
+    int64_t scratch_per_sm = 0;
+};
+
+struct options
+{
+    // Place a yield hint at least every this many instructions inside loops, zero disables it
+    int yield_interval = 0;
+
+    // Remove self moves, moves overwritten before being read and NOPs without side effects
+    bool optimize = false;
+
+    // Share identical functions and program tails between programs packed together
+    bool deduplicate = true;
+};
+
+// Yield hints placed inside a loop, addresses are byte offsets in the code
+struct yield_change
+{
+    uint32_t loop_begin = 0;
+    uint32_t loop_end = 0;
+    std::vector<uint32_t> addresses;
+};
+
+// Source position an instruction was assembled from, lines and columns start at one
+struct source_position
+{
+    // Byte offset of the instruction in the code of its program, headers aren't included
+    uint32_t address = 0;
+    int line = 0;
+    int column = 0;
+};
+
+// Allocations made for a kind of data while assembling, counted by the replaced global operator
+// new. Bytes are the sizes requested, the overhead of the allocator isn't counted.
+struct memory_usage
+{
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+// Memory the assembler allocated for a program, split by what it was used for. Nothing is counted
+// when nxas is built without NXAS_COUNT_ALLOCATIONS.
+struct memory_statistics
+{
+    // Label names and addresses, kept for the whole program
+    memory_usage labels;
+
+    // Decoded instructions and their source spans, sized by the semicolons of the source
+    memory_usage opcodes;
+
+    // Bundled code and the binary written from it. Binaries written to a mapped file and
+    // containers shared by programs assembled together aren't allocated for a single program.
+    memory_usage output;
+
+    // Error messages formatted for the candidates of an instruction none of them matched, the
+    // candidates of instructions that assemble fail without formatting one
+    memory_usage diagnostics;
+
+    // Everything else, such as tokens and virtual registers
+    memory_usage other;
+
+    // Highest number of bytes the program had allocated and not freed at once
+    size_t peak_bytes = 0;
+};
+
+// Information gathered while assembling a program
+struct report
+{
+    program_resources resources;
+    std::vector<yield_change> yields;
+
+    // Position of each instruction in the source, sorted by address
+    std::vector<source_position> lines;
+    size_t removed_instructions = 0;
+
+    // Instructions replaced by references to identical code of another program
+    size_t shared_instructions = 0;
+
+    memory_statistics memory;
+};
+
+// Source of a program assembled together with others
+struct source
+{
+    std::string code;
+    std::string filename;
+};
+
+std::vector<uint64_t> assemble(const std::string& code, const char* filename = "file",
+                               const options& options = {}, report* report = nullptr);
+
+// Assembled program kept in memory to apply edits to its source. Edits that keep the layout of
+// the program only encode the instructions on the edited lines again, the rest of the program
+// is reused and its label operands are moved when instructions are inserted or removed.
+class session
+{
+  public:
+    explicit session(std::string code, std::string filename = "file",
+                     const options& options = {});
+    ~session();
+
+    session(const session&) = delete;
+    session& operator=(const session&) = delete;
+
+    // Replaces num_lines lines starting at the zero based line with text, the text needs a
+    // trailing new line to keep the line after the edited ones separate
+    void edit(int line, int num_lines, std::string_view text);
+
+    const std::string& code() const;
+
+    const std::vector<uint64_t>& binary() const;
+
+    // Instructions encoded by the last edit, every instruction when it assembled it all again
+    size_t encoded_instructions() const;
+
+  private:
+    struct state;
+    std::unique_ptr<state> impl;
+};
+
+// Relocatable object read from a file
+struct object_file
+{
+    std::vector<uint8_t> data;
+    std::string filename;
+};
+
+// Assembles a relocatable object, label operands naming labels it doesn't define are resolved
+// when objects are linked
+std::vector<uint8_t> assemble_object(const std::string& code, const char* filename = "file",
+                                     const options& options = {});
+
+// Links relocatable objects into a program, the options of the first object configure it
+std::vector<uint64_t> link(std::span<const object_file> objects);
+
+// Packs DKSH programs in a single container, their code shares one section and each program
+// header points to its own entrypoint inside it
+std::vector<uint64_t> assemble_dksh(std::span<const source> sources, const options& options = {},
+                                    std::vector<report>* reports = nullptr);
+
+// Register that reads as zero and predicate that is always true
+inline constexpr int RZ = 255;
+inline constexpr int PT = 7;
+
+// Position in a program being built, branches can name it before it's placed
+struct label
+{
+    uint32_t index = 0;
+};
+
+// Operand of an instruction built without text, spelled as the tokens the assembler reads from
+// its text. Names are referenced until the operand is added to an instruction.
+class operand
+{
+  public:
+    enum class piece_type : uint8_t
+    {
+        gpr,
+        virtual_gpr,
+        predicate,
+        immediate,
+        float_immediate,
+        keyword,
+        modifier,
+        label,
+        minus,
+        tilde,
+        vbar,
+        bracket_left,
+        bracket_right,
+    };
+
+    struct piece
+    {
+        piece_type type;
+        bool negated;
+        uint32_t name_size;
+        union
+        {
+            int64_t integer;
+            double floating;
+        };
+        const char* name_data;
+
+        std::string_view name() const
+        {
+            return {name_data, name_size};
+        }
+    };
+
+    operand() = default;
+
+    operand(label target);
+
+    // Appends a modifier written after the operand, like CC in R0.CC
+    operand& modifier(std::string_view name);
+
+    operand& append(const piece& value)
+    {
+        if (num_pieces == storage.size()) {
+            overflow();
+        }
+        storage[num_pieces++] = value;
+        return *this;
+    }
+
+    std::span<const piece> pieces() const
+    {
+        return {storage.data(), num_pieces};
+    }
+
+  private:
+    [[noreturn]] static void overflow();
+
+    std::array<piece, 12> storage{};
+    size_t num_pieces = 0;
+};
+
+operand gpr(int index, bool reuse = false);
+
+// Register allocated by the assembler, spelled %name:component in text
+operand virtual_register(std::string_view name, int component = 0);
+
+operand predicate(int index, bool negated = false);
+
+operand immediate(int64_t value);
+
+operand float_immediate(double value);
+
+// Special registers and operands written as a name, like SR_LANEID or RGBA
+operand keyword(std::string_view name);
+
+operand constant_buffer(int index, int64_t offset);
+
+operand constant_buffer(int index, const operand& gpr, int64_t offset = 0);
+
+// Memory address, [R2+0x4] is address(gpr(2), 4)
+operand address(const operand& gpr, int64_t offset = 0);
+
+operand address(int64_t offset);
+
+operand attribute(int64_t offset);
+
+operand attribute(const operand& gpr, int64_t offset);
+
+operand neg(const operand& value);
+
+operand abs(const operand& value);
+
+// Bitwise inversion, ~R1 in text
+operand inv(const operand& value);
+
+// Scheduling of an instruction, fields left empty take the values of an instruction without
+// scheduling directives
+struct scheduling
+{
+    std::optional<int> stall = std::nullopt;
+    std::optional<int> write_barrier = std::nullopt;
+    std::optional<int> read_barrier = std::nullopt;
+
+    // Dependency barriers the instruction waits on, one bit each
+    uint32_t wait_barriers = 0;
+    bool yield = false;
+};
+
+// Builds a program instruction by instruction without writing its text. Each instruction is
+// encoded when it's added by the operand encoders of the first table entry of its mnemonic that
+// accepts its operands, in the order text tries them, so it encodes to the same value, reuse and
+// scheduling bits. Finishing the program only resolves its labels and virtual registers before
+// the passes and output text goes through. A function is generated from the table for each
+// mnemonic and number of operands, like ffma(dst, a, b, c, {"FTZ"}), and add takes any entry.
+// Errors are located at the index of the instruction as their line and the index of the token of
+// its modifiers and operands as their column, both starting at one.
+class builder
+{
+  public:
+    // Options are written like they are in text, the filename names the program in errors
+    explicit builder(std::string options = {}, std::string filename = "builder");
+    ~builder();
+
+    builder(const builder&) = delete;
+    builder& operator=(const builder&) = delete;
+
+    // Named labels can be the entrypoint of a program, unnamed ones are only branched to
+    label make_label(std::string_view name = {});
+
+    // Places a label at the next instruction added
+    void place(label target);
+
+    // Guards the next instruction added by a predicate
+    builder& guard(int predicate, bool negated = false);
+
+    // Schedules the next instruction added
+    builder& schedule(const scheduling& value);
+
+    // Adds any instruction of the table, modifiers are written without their dot
+    void add(std::string_view mnemonic, std::initializer_list<std::string_view> modifiers,
+             std::initializer_list<operand> operands);
+
+    // Functions named after each mnemonic in lowercase, generated from the table
+#include "nxas_emitters.inc"
+
+    // Instructions added so far
+    size_t size() const;
+
+    // Assembles the program like assemble does with its text
+    std::vector<uint64_t> finish(const options& options = {}, report* report = nullptr) const;
+
+  private:
+    // Adds an instruction with the first of the table entries that accepts its operands
+    void add_entries(std::span<const uint16_t> entries,
+                     std::initializer_list<std::string_view> modifiers,
+                     std::span<const operand* const> operands);
+
+    struct state;
+    std::unique_ptr<state> impl;
+};
+
+// Instructions of a program and the file they were assembled from
+struct line_sequence
+{
+    std::string filename;
+    std::vector<source_position> positions;
+};
+
+// Encodes a compact table mapping the address of each instruction to its source, addresses and
+// lines are delta encoded in a small program like DWARF line tables do
+std::vector<uint8_t> encode_line_table(std::span<const line_sequence> sequences);
+
+std::vector<line_sequence> decode_line_table(std::span<const uint8_t> data);
+
+// Prints code as text that assembles back to the same code. Code starts with a scheduling word
+// and has one every four words like assemble writes it, words no instruction decodes to are
+// printed as RAW instructions. Labels are named L_ followed by the address they point to.
+std::string disassemble(std::span<const uint64_t> code);
+
+// Estimates how many warps and blocks of a program fit in a Maxwell SM
+occupancy compute_occupancy(const program_resources& resources);
+
+// Records a span for each file assembled and each of its phases on every thread, in the Chrome
+// trace event format Perfetto also reads. Threads append to buffers of their own and the buffers
+// are merged when the trace is finished. Events of an earlier trace are dropped, so like
+// finish_trace it must not be called while a thread is still assembling.
+void start_trace();
+
+// Stops tracing and returns the JSON of the spans recorded since the trace started, threads
+// still assembling must be done before it's called
+std::string finish_trace();
 
 } // namespace nxas
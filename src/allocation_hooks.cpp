@@ -0,0 +1,103 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "memory_usage.h"
+
+// The global operator new and delete are replaced to count the memory of assemblies. Blocks
+// start with their size and the accounting that allocated them, so freeing them is counted too.
+namespace {
+
+struct alignas(std::max_align_t) allocation_header
+{
+    size_t bytes;
+    uint64_t owner;
+};
+
+} // namespace
+
+static void* allocate(size_t bytes) noexcept
+{
+    void* const block = std::malloc(sizeof(allocation_header) + bytes);
+    if (!block) {
+        return nullptr;
+    }
+    allocation_header* const header = static_cast<allocation_header*>(block);
+    header->bytes = bytes;
+    header->owner = account_allocation(bytes);
+    return header + 1;
+}
+
+static void deallocate(void* pointer) noexcept
+{
+    if (!pointer) {
+        return;
+    }
+    allocation_header* const header = static_cast<allocation_header*>(pointer) - 1;
+    account_deallocation(header->owner, header->bytes);
+    std::free(header);
+}
+
+void* operator new(size_t bytes)
+{
+    // Failed allocations call the new handler until it frees enough memory or there's none left
+    while (true) {
+        if (void* const pointer = allocate(bytes)) {
+            return pointer;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new[](size_t bytes)
+{
+    return ::operator new(bytes);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+    try {
+        return ::operator new(bytes);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept
+{
+    return ::operator new(bytes, std::nothrow);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
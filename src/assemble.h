@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "context.h"
+#include "nxas.h"
+#include "opcode.h"
+#include "resources.h"
+
+// Text an instruction was parsed from, it includes the options and blank lines before it
+struct instruction_span
+{
+    size_t begin;
+    size_t end;
+    int line;
+};
+
+// Instructions of a program as they were parsed, before any pass runs on them
+struct parsed_program
+{
+    std::vector<opcode> opcodes;
+    std::vector<instruction_span> spans;
+    bool has_virtual_gprs = false;
+};
+
+// Instructions of a program before they are bundled and its headers are written
+struct encoded_program
+{
+    std::vector<opcode> opcodes;
+    resource_usage usage;
+};
+
+// Parses every instruction of a program and allocates its virtual registers
+parsed_program parse_program(context& ctx, std::string_view code);
+
+// Parses at most max_instructions instructions from the tokens of a context
+parsed_program parse_program(context& ctx, size_t max_instructions);
+
+// Runs the passes enabled in the options and analyzes the resources of the program
+encoded_program finish_program(context& ctx, std::vector<opcode> opcodes,
+                               const nxas::options& options, nxas::report* report);
+
+// Assembles the program a context tokenizes into the binary its options describe
+std::vector<uint64_t> assemble_program(context& ctx, size_t max_instructions, const char* filename,
+                                       const nxas::options& options, nxas::report* report);
+void assemble_program(context& ctx, size_t max_instructions, const char* filename,
+                      const nxas::options& options, nxas::report* report,
+                      const binary_storage& storage);
+
+// Assembles instructions encoded without a context tokenizing them, like a builder adds them,
+// through the same passes and output as text. Their virtual registers are already allocated.
+std::vector<uint64_t> assemble_opcodes(context& ctx, std::vector<opcode> opcodes,
+                                       const char* filename, const nxas::options& options,
+                                       nxas::report* report);
+
+// Assemble a program or pack many in a DKSH like the public entry points, but write the binary in
+// place to storage sized by the assembler, such as a mapped output file
+void assemble_in_place(const std::string& code, const char* filename,
+                       const nxas::options& options, nxas::report* report,
+                       const binary_storage& storage);
+void assemble_dksh_in_place(std::span<const nxas::source> sources, const nxas::options& options,
+                            std::vector<nxas::report>* reports, const binary_storage& storage);
+
+// Groups instructions in bundles of three with their scheduling word
+std::vector<uint64_t> bundle(std::span<const opcode> opcodes);
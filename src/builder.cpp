@@ -0,0 +1,581 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "assemble.h"
+#include "context.h"
+#include "error.h"
+#include "helper.h"
+#include "memory_usage.h"
+#include "nxas.h"
+#include "object.h"
+#include "opcode.h"
+#include "parse.h"
+#include "regalloc.h"
+#include "token.h"
+#include "trace.h"
+
+namespace nxas {
+
+using piece_type = operand::piece_type;
+
+static operand::piece make_piece(piece_type type, int64_t integer = 0)
+{
+    operand::piece result{};
+    result.type = type;
+    result.integer = integer;
+    return result;
+}
+
+static operand::piece make_piece(piece_type type, std::string_view name, int64_t integer = 0)
+{
+    operand::piece result = make_piece(type, integer);
+    result.name_data = name.data();
+    result.name_size = static_cast<uint32_t>(name.size());
+    return result;
+}
+
+operand::operand(label target)
+{
+    append(make_piece(piece_type::label, target.index));
+}
+
+operand& operand::modifier(std::string_view name)
+{
+    return append(make_piece(piece_type::modifier, name));
+}
+
+void operand::overflow()
+{
+    fatal_error("operand has more than %zu tokens", std::tuple_size_v<decltype(storage)>);
+}
+
+static operand& append(operand& result, std::span<const operand::piece> pieces)
+{
+    for (const operand::piece& piece : pieces) {
+        result.append(piece);
+    }
+    return result;
+}
+
+// Offsets are written after the register the way the lexer reads [R2+0x4], zero is left out
+static void append_offset(operand& result, const operand& gpr, int64_t offset, bool keep_zero)
+{
+    append(result, gpr.pieces());
+    if (offset != 0 || keep_zero) {
+        result.append(make_piece(piece_type::immediate, offset));
+    }
+}
+
+operand gpr(int index, bool reuse)
+{
+    operand result;
+    result.append(make_piece(piece_type::gpr, index));
+    if (reuse) {
+        result.modifier("reuse");
+    }
+    return result;
+}
+
+operand virtual_register(std::string_view name, int component)
+{
+    operand result;
+    return result.append(make_piece(piece_type::virtual_gpr, name, component));
+}
+
+operand predicate(int index, bool negated)
+{
+    operand::piece value = make_piece(piece_type::predicate, index);
+    value.negated = negated;
+    operand result;
+    return result.append(value);
+}
+
+operand immediate(int64_t value)
+{
+    operand result;
+    return result.append(make_piece(piece_type::immediate, value));
+}
+
+operand float_immediate(double value)
+{
+    operand::piece piece = make_piece(piece_type::float_immediate);
+    piece.floating = value;
+    operand result;
+    return result.append(piece);
+}
+
+operand keyword(std::string_view name)
+{
+    operand result;
+    return result.append(make_piece(piece_type::keyword, name));
+}
+
+operand constant_buffer(int index, int64_t offset)
+{
+    operand result;
+    result.append(make_piece(piece_type::keyword, "c"));
+    result.append(make_piece(piece_type::bracket_left));
+    result.append(make_piece(piece_type::immediate, index));
+    result.append(make_piece(piece_type::bracket_right));
+    result.append(make_piece(piece_type::bracket_left));
+    result.append(make_piece(piece_type::immediate, offset));
+    return result.append(make_piece(piece_type::bracket_right));
+}
+
+operand constant_buffer(int index, const operand& gpr, int64_t offset)
+{
+    operand result;
+    result.append(make_piece(piece_type::keyword, "c"));
+    result.append(make_piece(piece_type::bracket_left));
+    result.append(make_piece(piece_type::immediate, index));
+    result.append(make_piece(piece_type::bracket_right));
+    result.append(make_piece(piece_type::bracket_left));
+    append_offset(result, gpr, offset, false);
+    return result.append(make_piece(piece_type::bracket_right));
+}
+
+operand address(const operand& gpr, int64_t offset)
+{
+    operand result;
+    result.append(make_piece(piece_type::bracket_left));
+    append_offset(result, gpr, offset, false);
+    return result.append(make_piece(piece_type::bracket_right));
+}
+
+operand address(int64_t offset)
+{
+    operand result;
+    result.append(make_piece(piece_type::bracket_left));
+    result.append(make_piece(piece_type::immediate, offset));
+    return result.append(make_piece(piece_type::bracket_right));
+}
+
+operand attribute(int64_t offset)
+{
+    operand result;
+    result.append(make_piece(piece_type::keyword, "a"));
+    result.append(make_piece(piece_type::bracket_left));
+    result.append(make_piece(piece_type::immediate, offset));
+    return result.append(make_piece(piece_type::bracket_right));
+}
+
+operand attribute(const operand& gpr, int64_t offset)
+{
+    operand result;
+    result.append(make_piece(piece_type::keyword, "a"));
+    result.append(make_piece(piece_type::bracket_left));
+    append_offset(result, gpr, offset, true);
+    return result.append(make_piece(piece_type::bracket_right));
+}
+
+operand neg(const operand& value)
+{
+    operand result;
+    result.append(make_piece(piece_type::minus));
+    return append(result, value.pieces());
+}
+
+operand abs(const operand& value)
+{
+    operand result;
+    result.append(make_piece(piece_type::vbar));
+    append(result, value.pieces());
+    return result.append(make_piece(piece_type::vbar));
+}
+
+operand inv(const operand& value)
+{
+    operand result;
+    result.append(make_piece(piece_type::tilde));
+    return append(result, value.pieces());
+}
+
+struct builder::state
+{
+    state(std::string filename_, std::string options_)
+        : filename{std::move(filename_)}, options{std::move(options_)}, ctx{filename.c_str(), ""}
+    {
+        ctx.virtual_gprs = &virtual_gprs;
+        ctx.external_labels = &label_references;
+    }
+
+    std::string filename;
+    std::string options;
+
+    // Reads the tokens of each instruction to the operand encoders. Labels are defined in it when
+    // they are placed, operands naming labels placed later are left for finish to resolve.
+    context ctx;
+
+    std::vector<opcode> opcodes;
+    std::vector<virtual_gpr> virtual_gprs;
+    std::vector<external_label> label_references;
+
+    // Tokens of the modifiers and operands of the instruction being added, errors are located by
+    // the number pushed
+    packed_tokens tokens;
+    int column = 0;
+
+    // Names the tokens point to, the deque keeps them in place as more are added
+    std::deque<std::string> name_storage;
+    std::unordered_map<std::string_view, uint32_t> name_indices;
+    std::string scratch;
+
+    std::vector<uint32_t> label_names;
+    std::vector<std::optional<int64_t>> label_addresses;
+    std::set<uint32_t> named_labels;
+
+    std::optional<operand::piece> guard;
+    std::optional<scheduling> schedule;
+
+    uint32_t intern(std::string_view name)
+    {
+        const auto it = name_indices.find(name);
+        if (it != name_indices.end()) {
+            return it->second;
+        }
+        const uint32_t index = static_cast<uint32_t>(tokens.names.size());
+        tokens.names.push_back(name_storage.emplace_back(name));
+        name_indices.emplace(tokens.names.back(), index);
+        return index;
+    }
+
+    // Token errors found while adding an instruction are reported at
+    token location(token_type type) const
+    {
+        token result{};
+        result.filename = filename.c_str();
+        result.type = type;
+        result.line = static_cast<int>(opcodes.size());
+        result.column = column;
+        return result;
+    }
+
+    void push(token_type type)
+    {
+        tokens.push(type);
+        ++column;
+    }
+
+    void push_identifier(uint32_t name)
+    {
+        tokens.push_name(token_type::identifier, name);
+        ++column;
+    }
+
+    // Modifiers are read with their dot, like .SAT
+    void push_modifier(std::string_view name)
+    {
+        scratch.assign(1, '.');
+        scratch += name;
+        push_identifier(intern(scratch));
+    }
+
+    void push_piece(const operand::piece& piece);
+
+    // Guard bits of the next instruction, PT when it isn't guarded
+    uint64_t guard_bits() const;
+
+    // Scheduling bits of the next instruction, checked like the directives of text
+    uint32_t schedule_bits() const;
+
+    // The next instruction added takes neither the guard nor the scheduling, even when it fails
+    void reset()
+    {
+        guard.reset();
+        schedule.reset();
+    }
+
+    // Encodes an instruction with the first of its table entries that accepts its operands
+    void encode(std::span<const uint16_t> entries, std::span<const std::string_view> modifiers,
+                std::span<const operand* const> operands);
+};
+
+void builder::state::push_piece(const operand::piece& piece)
+{
+    switch (piece.type) {
+    case piece_type::gpr:
+        if (piece.integer < 0 || piece.integer > RZ) {
+            fatal_error(location(token_type::regster), "register R%lld is out of range",
+                        static_cast<long long>(piece.integer));
+        }
+        tokens.push_register(static_cast<uint8_t>(piece.integer));
+        ++column;
+        break;
+    case piece_type::virtual_gpr:
+        scratch.assign(1, '%');
+        scratch += piece.name();
+        if (piece.integer != 0) {
+            scratch += ':';
+            scratch += std::to_string(piece.integer);
+        }
+        tokens.push_name(token_type::virtual_register, intern(scratch));
+        ++column;
+        break;
+    case piece_type::predicate:
+        if (piece.integer < 0 || piece.integer > PT) {
+            fatal_error(location(token_type::predicate), "out of range predicate");
+        }
+        tokens.push_predicate(static_cast<int>(piece.integer), piece.negated);
+        ++column;
+        break;
+    case piece_type::immediate:
+        tokens.push_immediate(piece.integer);
+        ++column;
+        break;
+    case piece_type::float_immediate:
+        tokens.push_float_immediate(piece.floating);
+        ++column;
+        break;
+    case piece_type::keyword:
+        push_identifier(intern(piece.name()));
+        break;
+    case piece_type::modifier:
+        push_modifier(piece.name());
+        break;
+    case piece_type::label:
+        if (piece.integer < 0 || static_cast<size_t>(piece.integer) >= label_names.size()) {
+            fatal_error(location(token_type::identifier), "label %lld wasn't made by this builder",
+                        static_cast<long long>(piece.integer));
+        }
+        push_identifier(label_names[static_cast<size_t>(piece.integer)]);
+        break;
+    case piece_type::minus:
+        push(token_type::minus);
+        break;
+    case piece_type::tilde:
+        push(token_type::tilde);
+        break;
+    case piece_type::vbar:
+        push(token_type::vbar);
+        break;
+    case piece_type::bracket_left:
+        push(token_type::bracket_left);
+        break;
+    case piece_type::bracket_right:
+        push(token_type::bracket_right);
+        break;
+    }
+}
+
+uint64_t builder::state::guard_bits() const
+{
+    if (!guard) {
+        return static_cast<uint64_t>(PT) << 16;
+    }
+    if (guard->integer < 0 || guard->integer > PT) {
+        fatal_error(location(token_type::predicate), "out of range predicate");
+    }
+    return static_cast<uint64_t>(guard->integer | (guard->negated ? 8 : 0)) << 16;
+}
+
+uint32_t builder::state::schedule_bits() const
+{
+    const scheduling value = schedule.value_or(scheduling{});
+    const auto check = [this](std::optional<int> field, int max, const char* message) {
+        if (field && (*field < 0 || *field > max)) {
+            fatal_error(location(token_type::immediate), "%s", message);
+        }
+    };
+    check(value.stall, 15, "number of waited clocks must be between 0 and 15 inclusively");
+    check(value.write_barrier, 5, "barrier index must be between 0 and 5 inclusively");
+    check(value.read_barrier, 5, "barrier index must be between 0 and 5 inclusively");
+    if (value.wait_barriers >> 6) {
+        fatal_error(location(token_type::immediate),
+                    "dependency barrier index must be between 0 and 5 inclusively");
+    }
+    opcode op;
+    op.sched.values = {
+        .stall = static_cast<uint32_t>(value.stall.value_or(0)),
+        .yield = value.yield ? 1U : 0U,
+        .write_barrier = static_cast<uint32_t>(value.write_barrier.value_or(7)),
+        .read_barrier = static_cast<uint32_t>(value.read_barrier.value_or(7)),
+        .wait_barrier = value.wait_barriers,
+        .padding = 0,
+    };
+    return op.sched.raw;
+}
+
+void builder::state::encode(std::span<const uint16_t> entries,
+                            std::span<const std::string_view> modifiers,
+                            std::span<const operand* const> operands)
+{
+    const size_t index = opcodes.size();
+    tokens.bytes.clear();
+    column = 0;
+    opcode op;
+    op.line = static_cast<int>(index);
+    try {
+        op.add_bits(guard_bits());
+        const uint32_t sched = schedule_bits();
+        for (const std::string_view modifier : modifiers) {
+            push_modifier(modifier);
+        }
+        for (size_t position = 0; position < operands.size(); ++position) {
+            if (position > 0) {
+                push(token_type::comma);
+            }
+            for (const operand::piece& piece : operands[position]->pieces()) {
+                push_piece(piece);
+            }
+        }
+        push(token_type::semicolon);
+
+        ctx.pc = instruction_address(index);
+        ctx.feed(tokens, static_cast<int>(index));
+        parse_operands(ctx, op, entries);
+        // Parsing schedules instructions without directives, the scheduling is written over it
+        op.sched.raw = sched;
+    } catch (const assembly_error&) {
+        // The builder stays usable without the rejected instruction
+        reset();
+        throw;
+    }
+    reset();
+    opcodes.push_back(op);
+}
+
+builder::builder(std::string options, std::string filename)
+    : impl{std::make_unique<state>(std::move(filename), std::move(options))}
+{
+}
+
+builder::~builder() = default;
+
+label builder::make_label(std::string_view name)
+{
+    state& s = *impl;
+    const label result{static_cast<uint32_t>(s.label_names.size())};
+    if (name.empty()) {
+        // Labels in text can't start with @, generated names don't collide with named labels
+        s.scratch.assign(1, '@');
+        s.scratch += std::to_string(result.index);
+        s.label_names.push_back(s.intern(s.scratch));
+    } else {
+        const uint32_t interned = s.intern(name);
+        if (!s.named_labels.insert(interned).second) {
+            fatal_error("%s: label \33[1m%.*s\33[0m is already made", s.filename.c_str(),
+                        static_cast<int>(name.size()), name.data());
+        }
+        s.label_names.push_back(interned);
+    }
+    s.label_addresses.emplace_back();
+    return result;
+}
+
+void builder::place(label target)
+{
+    state& s = *impl;
+    if (target.index >= s.label_addresses.size()) {
+        fatal_error("%s: label %u wasn't made by this builder", s.filename.c_str(), target.index);
+    }
+    std::optional<int64_t>& address = s.label_addresses[target.index];
+    const std::string_view name = s.tokens.names[s.label_names[target.index]];
+    if (address) {
+        fatal_error("%s: label \33[1m%.*s\33[0m is already placed", s.filename.c_str(),
+                    static_cast<int>(name.size()), name.data());
+    }
+    address = instruction_address(s.opcodes.size());
+    s.ctx.define_label(std::string{name}, *address);
+}
+
+builder& builder::guard(int predicate, bool negated)
+{
+    impl->guard = nxas::predicate(predicate, negated).pieces()[0];
+    return *this;
+}
+
+builder& builder::schedule(const scheduling& value)
+{
+    impl->schedule = value;
+    return *this;
+}
+
+void builder::add(std::string_view mnemonic, std::initializer_list<std::string_view> modifiers,
+                  std::initializer_list<operand> operands)
+{
+    state& s = *impl;
+    std::array<const operand*, 16> pointers;
+    if (operands.size() > pointers.size()) {
+        s.reset();
+        fatal_error("%s: instruction has more than %zu operands", s.filename.c_str(),
+                    pointers.size());
+    }
+    const std::span<const uint16_t> entries = find_candidates(mnemonic);
+    if (entries.empty()) {
+        s.reset();
+        fatal_error(s.location(token_type::identifier), "unknown mnemonic \33[1m%.*s\33[0m",
+                    static_cast<int>(mnemonic.size()), mnemonic.data());
+    }
+    std::ranges::transform(operands, pointers.begin(), [](const operand& value) { return &value; });
+    s.encode(entries, modifiers, std::span(pointers).first(operands.size()));
+}
+
+void builder::add_entries(std::span<const uint16_t> entries,
+                          std::initializer_list<std::string_view> modifiers,
+                          std::span<const operand* const> operands)
+{
+    impl->encode(entries, modifiers, operands);
+}
+
+size_t builder::size() const
+{
+    return impl->opcodes.size();
+}
+
+std::vector<uint64_t> builder::finish(const options& options, report* report) const
+{
+    const state& s = *impl;
+    const char* const filename = s.filename.c_str();
+    TRACE_FILE(filename);
+    memory_accounting accounting(report ? &report->memory : nullptr);
+    const active_accounting counting(accounting);
+    context ctx(filename, s.options.c_str());
+    ctx.parse_options();
+    for (const auto& [name, address] : s.ctx.label_addresses()) {
+        ctx.define_label(name, address);
+    }
+    std::vector<opcode> opcodes;
+    {
+        ACCOUNT_MEMORY(opcodes);
+        opcodes = s.opcodes;
+    }
+
+    // Operands naming labels placed after their instruction were left empty when it was added,
+    // labels that aren't placed are reported as not defined by the instructions naming them
+    for (const external_label& reference : s.label_references) {
+        token location{};
+        location.filename = filename;
+        location.type = token_type::identifier;
+        location.line = static_cast<int>(reference.instruction);
+        const std::optional target = ctx.find_label(reference.name);
+        if (!target) {
+            fatal_error(location, "label \33[1m%s\33[0m not defined", reference.name.c_str());
+        }
+        const int64_t address = instruction_address(reference.instruction);
+        const int64_t offset = *target - address - 8;
+        if (offset > static_cast<int64_t>(max_bits(23)) ||
+            offset < -static_cast<int64_t>(max_bits(23)) - 1) {
+            fatal_error(location, "label out of range");
+        }
+        opcode& op = opcodes[reference.instruction];
+        op.value = set_label_target(op.value, address, *target);
+    }
+    if (!s.virtual_gprs.empty()) {
+        allocate_registers(opcodes, s.virtual_gprs);
+    }
+    return assemble_opcodes(ctx, std::move(opcodes), filename, options, report);
+}
+
+} // namespace nxas
@@ -1,17 +1,32 @@
+#include <algorithm>
+#include <cinttypes>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <optional>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "assemble.h"
+#include "embed.h"
 #include "error.h"
 #include "nxas.h"
+#include "output.h"
+#include "parse.h"
+#include "server.h"
+#include "time_report.h"
+#include "trace.h"
 
 static std::string read_file(const char* filename)
 {
+    TRACE_PHASE("read", filename);
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
-        fatal_error(nullptr, "%s: failed to open", filename);
+        fatal_error("%s: failed to open", filename);
     }
     file.seekg(0, std::ios::end);
     std::string text(file.tellg(), ' ');
@@ -21,12 +36,233 @@ static std::string read_file(const char* filename)
     return text;
 }
 
-int main(int argc, char** argv)
+// Counts of previous runs are kept so a profile can be recorded over many programs
+static void write_candidate_profile(const char* filename, candidate_profile& profile)
+{
+    if (std::ifstream(filename).is_open()) {
+        read_candidate_profile(read_file(filename), profile);
+    }
+    const std::string text = format_candidate_profile(profile);
+    write_output(filename, text.data(), text.size());
+}
+
+static const char* limit_name(nxas::occupancy_limit limit)
+{
+    switch (limit) {
+    case nxas::occupancy_limit::warps:
+        return "warps";
+    case nxas::occupancy_limit::blocks:
+        return "blocks";
+    case nxas::occupancy_limit::registers:
+        return "registers";
+    case nxas::occupancy_limit::shared_memory:
+        return "shared memory";
+    }
+    return "unknown";
+}
+
+static void print_occupancy(const nxas::program_resources& resources)
+{
+    const nxas::occupancy result = nxas::compute_occupancy(resources);
+    std::printf("registers:      %d per thread\n", resources.num_gprs);
+    if (resources.is_compute) {
+        const auto& dims = resources.block_dimensions;
+        std::printf("block size:     %ux%ux%u (%d warps)\n", dims[0], dims[1], dims[2],
+                    result.warps_per_block);
+        std::printf("shared memory:  %d bytes per block\n", resources.shared_mem_size);
+    }
+    std::printf("scratch:        %d bytes per warp, %" PRId64 " bytes per SM\n",
+                resources.per_warp_scratch_size, result.scratch_per_sm);
+    std::printf("occupancy:      %d/%d warps per SM (%d%%), %d blocks per SM, limited by %s\n",
+                result.warps_per_sm, result.max_warps_per_sm,
+                result.warps_per_sm * 100 / result.max_warps_per_sm, result.blocks_per_sm,
+                limit_name(result.limit));
+
+    // Find how many registers can be added before losing occupancy
+    nxas::program_resources more = resources;
+    while (more.num_gprs < 255) {
+        ++more.num_gprs;
+        const nxas::occupancy next = nxas::compute_occupancy(more);
+        if (next.warps_per_sm < result.warps_per_sm) {
+            std::printf("                %d registers drop it to %d warps per SM\n",
+                        more.num_gprs, next.warps_per_sm);
+            break;
+        }
+    }
+}
+
+static void print_yields(const std::vector<nxas::yield_change>& changes)
+{
+    for (const nxas::yield_change& change : changes) {
+        std::printf("yield: loop 0x%04x-0x%04x, placed %zu hint%s at", change.loop_begin,
+                    change.loop_end, change.addresses.size(),
+                    change.addresses.size() == 1 ? "" : "s");
+        for (const uint32_t address : change.addresses) {
+            std::printf(" 0x%04x", address);
+        }
+        std::printf("\n");
+    }
+}
+
+static void print_memory(const nxas::memory_statistics& memory)
+{
+    const auto print = [](const char* name, const nxas::memory_usage& usage) {
+        std::printf("memory: %-12s %10zu allocations %12zu bytes\n", name, usage.allocations,
+                    usage.bytes);
+    };
+    print("labels", memory.labels);
+    print("opcodes", memory.opcodes);
+    print("output", memory.output);
+    print("diagnostics", memory.diagnostics);
+    print("other", memory.other);
+    std::printf("memory: %-12s %35zu bytes\n", "peak", memory.peak_bytes);
+}
+
+// Output file the binary is written to in place once the assembler knows its size
+struct binary_output
+{
+    const char* filename;
+    std::optional<output_file> file;
+
+    std::span<uint64_t> allocate(size_t num_words)
+    {
+        file.emplace(filename, num_words * sizeof(uint64_t));
+        return {reinterpret_cast<uint64_t*>(file->data().data()), num_words};
+    }
+};
+
+// The time report is printed and the trace written once everything else is written
+static bool is_time_report = false;
+static const char* trace_file = nullptr;
+
+static int run(int argc, char** argv)
 {
-    const char* input_file = nullptr;
+    std::vector<const char*> input_files;
     const char* output_file = nullptr;
+    bool report_occupancy = false;
+    bool report_memory = false;
+    bool is_object = false;
+    bool is_disassembly = false;
+    bool is_embedded = false;
+    embed_format format = embed_format::header;
+    const char* symbol_name = nullptr;
+    bool write_line_table = false;
+    const char* profile_file = nullptr;
+    bool is_server = false;
+    const char* socket_path = nullptr;
+    unsigned num_workers = std::max(std::thread::hardware_concurrency(), 1U);
+    nxas::options options;
 
     for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--time-report") == 0) {
+            if (!has_time_report) {
+                fatal_error("--time-report needs nxas built with NXAS_TIME_REPORT enabled");
+            }
+            is_time_report = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--record-candidates") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--record-candidates\" <profile>");
+            }
+            profile_file = argv[i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--server") == 0) {
+            is_server = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--socket") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--socket\" <path>");
+            }
+            socket_path = argv[i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--jobs") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--jobs\" <workers>");
+            }
+            char* end;
+            num_workers = static_cast<unsigned>(std::strtoul(argv[i], &end, 10));
+            if (*end != '\0' || num_workers == 0) {
+                fatal_error("number of workers \"%s\" is not a positive integer", argv[i]);
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--trace\" <trace file>");
+            }
+            trace_file = argv[i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--mem-report") == 0) {
+            report_memory = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--occupancy") == 0) {
+            report_occupancy = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "-c") == 0) {
+            is_object = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "-d") == 0 || std::strcmp(argv[i], "--disassemble") == 0) {
+            is_disassembly = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--no-dedup") == 0) {
+            options.deduplicate = false;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--line-table") == 0) {
+            write_line_table = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "-O") == 0) {
+            options.optimize = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--yield") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--yield\" <interval>");
+            }
+            char* end;
+            options.yield_interval = static_cast<int>(std::strtol(argv[i], &end, 10));
+            if (*end != '\0' || options.yield_interval <= 0) {
+                fatal_error("yield interval \"%s\" is not a positive integer", argv[i]);
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--format") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--format\" <binary|header|asm>");
+            }
+            if (std::strcmp(argv[i], "binary") == 0) {
+                is_embedded = false;
+            } else if (std::strcmp(argv[i], "header") == 0) {
+                is_embedded = true;
+                format = embed_format::header;
+            } else if (std::strcmp(argv[i], "asm") == 0) {
+                is_embedded = true;
+                format = embed_format::assembly;
+            } else {
+                fatal_error("unknown output format \"%s\"", argv[i]);
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--name") == 0) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"--name\" <symbol>");
+            }
+            if (!is_valid_symbol_name(argv[i])) {
+                fatal_error("\"%s\" is not a valid symbol name", argv[i]);
+            }
+            symbol_name = argv[i];
+            continue;
+        }
         // Parse output file
         if (std::strcmp(argv[i], "-o") == 0) {
             if (output_file) {
@@ -39,26 +275,146 @@ int main(int argc, char** argv)
             continue;
         }
         // There's no modifier, it's an input file
-        if (input_file) {
-            fatal_error("command line input file already provided");
+        input_files.push_back(argv[i]);
+    }
+    if (trace_file) {
+        nxas::start_trace();
+    }
+    if (is_server) {
+        // The trace is written once the server shuts down
+        if (!input_files.empty() || output_file) {
+            fatal_error("the server reads programs from requests, not files");
         }
-        input_file = argv[i];
+        return run_server(socket_path, num_workers);
+    }
+    if (socket_path) {
+        fatal_error("\"--socket\" is only used by \"--server\"");
     }
-    if (!input_file) {
+    if (input_files.empty()) {
         fatal_error("no input file");
     }
     if (!output_file) {
         fatal_error("no output file");
     }
-    const std::string input_text = read_file(input_file);
-    const std::vector<uint64_t> binary = nxas::assemble(input_text.c_str(), input_file);
+    if (is_disassembly) {
+        // Code assembled by nxas, without headers, is printed as text it assembles back from
+        if (input_files.size() != 1 || is_object || is_embedded || write_line_table ||
+            profile_file || report_memory) {
+            fatal_error("disassembly reads a single code file and writes text");
+        }
+        const std::string data = read_file(input_files[0]);
+        if (data.size() % sizeof(uint64_t) != 0) {
+            fatal_error("%s: size is not a multiple of 8 bytes", input_files[0]);
+        }
+        std::vector<uint64_t> code(data.size() / sizeof(uint64_t));
+        std::memcpy(code.data(), data.data(), data.size());
+        const std::string text = nxas::disassemble(code);
+        write_output(output_file, text.data(), text.size());
+        return 0;
+    }
+    candidate_profile profile;
+    if (profile_file) {
+        record_candidates(&profile);
+    }
+    if (is_object) {
+        if (input_files.size() != 1) {
+            fatal_error("relocatable objects are assembled from a single input file");
+        }
+        if (is_embedded) {
+            fatal_error("relocatable objects can't be embedded in source code");
+        }
+        if (write_line_table) {
+            fatal_error("line tables are written for linked programs, not objects");
+        }
+        if (report_memory) {
+            fatal_error("memory reports are written for linked programs, not objects");
+        }
+        const std::vector<uint8_t> object =
+            nxas::assemble_object(read_file(input_files[0]), input_files[0], options);
+        write_output(output_file, object.data(), object.size());
+        if (profile_file) {
+            write_candidate_profile(profile_file, profile);
+        }
+        return 0;
+    }
+    // Many input files are packed as programs of a single DKSH
+    std::vector<nxas::source> sources;
+    for (const char* const input_file : input_files) {
+        sources.push_back({.code = read_file(input_file), .filename = input_file});
+    }
+    // Binaries are written straight to the mapped output, embedded ones are formatted from memory
+    std::vector<nxas::report> reports(1);
+    std::vector<uint64_t> binary;
+    binary_output output{.filename = output_file, .file = {}};
+    const binary_storage storage = [&](size_t num_words) {
+        if (is_embedded) {
+            binary.resize(num_words);
+            return std::span(binary);
+        }
+        return output.allocate(num_words);
+    };
+    if (sources.size() == 1) {
+        assemble_in_place(sources[0].code, input_files[0], options, &reports[0], storage);
+    } else {
+        assemble_dksh_in_place(sources, options, &reports, storage);
+    }
+    if (profile_file) {
+        write_candidate_profile(profile_file, profile);
+    }
+    for (size_t index = 0; index < reports.size(); ++index) {
+        const nxas::report& report = reports[index];
+        if (reports.size() > 1) {
+            std::printf("%s:\n", input_files[index]);
+        }
+        if (options.optimize) {
+            std::printf("optimize: removed %zu instructions\n", report.removed_instructions);
+        }
+        if (report.shared_instructions > 0) {
+            std::printf("deduplicate: shared %zu instructions\n", report.shared_instructions);
+        }
+        print_yields(report.yields);
+        if (report_occupancy) {
+            print_occupancy(report.resources);
+        }
+        if (report_memory) {
+            print_memory(report.memory);
+        }
+    }
+    if (write_line_table) {
+        // The table is written next to the output with the same name and a .lines extension
+        std::vector<nxas::line_sequence> sequences;
+        for (size_t index = 0; index < reports.size(); ++index) {
+            sequences.push_back({
+                .filename = input_files[index],
+                .positions = reports[index].lines,
+            });
+        }
+        const std::vector<uint8_t> table = nxas::encode_line_table(sequences);
+        write_output((std::string{output_file} + ".lines").c_str(), table.data(), table.size());
+    }
+    if (is_embedded) {
+        const std::string name = symbol_name ? symbol_name : embed_symbol_name(output_file);
+        write_embedded(output_file, binary, name, format);
+        return 0;
+    }
+    output.file->commit();
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
     try {
-        std::ofstream outfp(output_file, std::ios::binary);
-        if (!outfp.is_open()) {
-            fatal_error("%s: failed to open", output_file);
+        const int result = run(argc, argv);
+        if (is_time_report) {
+            print_time_report(stdout);
+        }
+        if (trace_file) {
+            const std::string trace = nxas::finish_trace();
+            write_output(trace_file, trace.data(), trace.size());
         }
-        outfp.write(reinterpret_cast<const char*>(binary.data()), binary.size() * sizeof(uint64_t));
-    } catch (const std::ios_base::failure& e) {
-        fatal_error("failed to write output file: %s", e.what());
+        return result;
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return EXIT_FAILURE;
     }
 }
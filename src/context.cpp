@@ -7,11 +7,18 @@
 #include <cstdlib>
 #include <cstring>
 #include <optional>
+#include <span>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "context.h"
 #include "error.h"
+#include "memory_usage.h"
 #include "opcode.h"
+#include "time_report.h"
+#include "trace.h"
 
 static bool is_contained(std::string_view string, int character) noexcept
 {
@@ -78,6 +85,28 @@ context::context(const char* filename_, const char* text_)
 context::~context() = default;
 
 token context::tokenize()
+{
+    COUNT_EVENT(tokens);
+    if (fed_tokens) {
+        token token = fed_tokens->unpack(fed_offset);
+        token.filename = filename;
+        token.line = line;
+        token.column = column++;
+        if (token.type == token_type::semicolon) {
+            ++line;
+            column = 0;
+        }
+        return token;
+    }
+    // Labels are skipped in a loop, recursing through them would overflow the stack on long runs
+    // of labels
+    std::optional<token> token;
+    while (!(token = scan_token())) {
+    }
+    return *token;
+}
+
+std::optional<token> context::scan_token()
 {
     while (is_contained(" \t\r\n", *text)) {
         next();
@@ -169,6 +198,31 @@ token context::tokenize()
         }
         return token;
     }
+    if (character == '%') {
+        // Virtual registers are spelled %name or %name:component
+        token.type = token_type::virtual_register;
+        do {
+            next();
+        } while (is_alnum(*text) || *text == '_');
+
+        if (text - contents == 1) {
+            fatal_error(token, "expected virtual register name after '%%'");
+        }
+        if (*text == ':') {
+            next();
+            if (!is_decimal(*text)) {
+                fatal_error(token, "expected virtual register component after ':'");
+            }
+            while (is_decimal(*text)) {
+                next();
+            }
+        }
+        if (!is_separator(*text)) {
+            fatal_error(token, "no separator after virtual register");
+        }
+        token.data.string = std::string_view(contents, static_cast<size_t>(text - contents));
+        return token;
+    }
     if (character == 'R') {
         token.type = token_type::regster;
 
@@ -216,7 +270,7 @@ token context::tokenize()
 
     if (text[-1] == ':') {
         // ignore labels
-        return tokenize();
+        return std::nullopt;
     }
     token.type = token_type::identifier;
     token.data.string = std::string_view(contents, static_cast<size_t>(text - contents));
@@ -232,6 +286,56 @@ std::optional<int64_t> context::find_label(std::string_view label) const
     return it->second;
 }
 
+void context::define_label(std::string name, int64_t address)
+{
+    ACCOUNT_MEMORY(labels);
+    labels.insert_or_assign(std::move(name), address);
+}
+
+std::vector<size_t> context::labeled_instructions() const
+{
+    std::vector<size_t> result;
+    for (const auto& [name, address] : labels) {
+        if (const std::optional index = instruction_index(address)) {
+            result.push_back(*index);
+        }
+    }
+    return result;
+}
+
+void context::relocate_labels(std::span<const size_t> new_indices)
+{
+    for (auto& [name, address] : labels) {
+        const std::optional index = instruction_index(address);
+        if (index && *index < new_indices.size()) {
+            address = instruction_address(new_indices[*index]);
+        }
+    }
+}
+
+void context::skip_line_end()
+{
+    while (is_contained(" \t\r", *text)) {
+        next();
+    }
+    if (*text == '\n') {
+        next();
+    }
+}
+
+void context::seek(const char* text_, size_t offset, int line_, int64_t pc_)
+{
+    text_begin = text_;
+    text = text_ + offset;
+    line = line_;
+    pc = pc_;
+
+    column = 0;
+    for (const char* it = text; it != text_begin && it[-1] != '\n'; --it) {
+        column += it[-1] == '\t' ? 4 : 1;
+    }
+}
+
 void context::next() noexcept
 {
     const char character = text++[0];
@@ -259,6 +363,7 @@ void context::reset()
 
 void context::generate_labels()
 {
+    PROFILE_PHASE(labels, "label pass", filename);
     const auto advance = [this] {
         if (*text == ';') {
             pc += 8;
@@ -288,6 +393,7 @@ void context::generate_labels()
             advance();
         }
         if (*text == ':') {
+            ACCOUNT_MEMORY(labels);
             std::string label;
             label.append(potential_label, static_cast<size_t>(text - potential_label));
             labels.insert({std::move(label), pc});
@@ -3,6 +3,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <optional>
 #include <span>
 #include <string>
@@ -10,8 +11,18 @@
 #include <unordered_map>
 #include <vector>
 
+#include "nxas.h"
 #include "token.h"
 
+struct dksh_program;
+struct dksh_program_header;
+struct external_label;
+struct resource_usage;
+struct virtual_gpr;
+
+// Storage a binary is written to in place once its size in words is known
+using binary_storage = std::function<std::span<uint64_t>(size_t num_words)>;
+
 class context
 {
   public:
@@ -20,14 +31,105 @@ class context
 
     token tokenize();
 
+    // Reads tokens packed by a builder instead of the text, lines count instructions from the
+    // first one. The tokens have to outlive the tokenizing.
+    void feed(const packed_tokens& tokens, int first_line)
+    {
+        fed_tokens = &tokens;
+        fed_offset = 0;
+        line = first_line;
+        column = 0;
+    }
+
     void parse_option(token& token);
 
+    // Parses a text made only of options
+    void parse_options();
+
+    // Text of the options parsed so far, one per line
+    const std::string& option_text() const
+    {
+        return options;
+    }
+
+    // Offset in the text and line of the next character to tokenize
+    size_t offset() const
+    {
+        return static_cast<size_t>(text - text_begin);
+    }
+
+    int current_line() const
+    {
+        return line;
+    }
+
+    // State of the tokenizer, parsing rewinds to it to try the next entry of a mnemonic
+    struct position
+    {
+        const char* text;
+        int line;
+        int column;
+        size_t fed_offset;
+    };
+
+    position tell() const
+    {
+        return {text, line, column, fed_offset};
+    }
+
+    void rewind(const position& position)
+    {
+        text = position.text;
+        line = position.line;
+        column = position.column;
+        fed_offset = position.fed_offset;
+    }
+
+    // Skips the blanks and the new line after the last token, instructions own their line
+    void skip_line_end();
+
+    // Continues tokenizing an edited copy of the text from the given offset, labels and options
+    // are kept as they are
+    void seek(const char* text_, size_t offset, int line_, int64_t pc_);
+
     std::optional<int64_t> find_label(std::string_view label) const;
 
-    std::vector<uint64_t> binary(std::span<const uint64_t> code) const;
+    const std::unordered_map<std::string, int64_t>& label_addresses() const
+    {
+        return labels;
+    }
+
+    void define_label(std::string name, int64_t address);
+
+    // Address of the label the program is entered through
+    std::optional<int64_t> entrypoint_address() const;
+
+    // Indices of the instructions named by a label
+    std::vector<size_t> labeled_instructions() const;
+
+    // Moves labels to the instruction indices they have after removing instructions
+    void relocate_labels(std::span<const size_t> new_indices);
+
+    std::vector<uint64_t> binary(std::span<const uint64_t> code, const resource_usage& usage,
+                                 nxas::program_resources* resources) const;
+    void binary(std::span<const uint64_t> code, const resource_usage& usage,
+                nxas::program_resources* resources, const binary_storage& storage) const;
+
+    // Resolves the resources of a DKSH program to pack it with others
+    dksh_program dksh(std::span<const uint64_t> code, const resource_usage& usage) const;
+
+    // Header describing this program when its code is placed at the given offset of a DKSH
+    dksh_program_header dksh_header(size_t code_offset,
+                                    const nxas::program_resources& resources) const;
 
     int64_t pc = 0;
 
+    // Virtual register operands found while parsing, owned by the caller
+    std::vector<virtual_gpr>* virtual_gprs = nullptr;
+
+    // Label operands left for the linker, labels must be defined in the text when it's null
+    std::vector<external_label>* external_labels = nullptr;
+
   private:
     enum class program_type
     {
@@ -41,13 +143,27 @@ class context
 
     void next() noexcept;
 
+    // Reads the next token, label definitions are skipped and read as nothing
+    std::optional<token> scan_token();
+
     void reset();
 
     void generate_labels();
 
-    void write_gfx_header(std::vector<uint64_t>& output) const;
+    void write_gfx_header(const resource_usage& usage, const nxas::program_resources& resources,
+                          std::span<uint64_t> output) const;
+
+    // Words of the graphics header written before the code, if the program has one
+    size_t header_words() const;
 
-    void write_dksh(size_t code_size, std::vector<uint64_t>& output) const;
+    // Code of the program, prefixed by its graphics header when it has one
+    std::vector<uint64_t> program_code(std::span<const uint64_t> code, const resource_usage& usage,
+                                       const nxas::program_resources& resources) const;
+    void write_program_code(std::span<const uint64_t> code, const resource_usage& usage,
+                            const nxas::program_resources& resources,
+                            std::span<uint64_t> output) const;
+
+    nxas::program_resources resolve_resources(const resource_usage& usage) const;
 
     const char* filename;
     const char* text_begin;
@@ -55,26 +171,40 @@ class context
     int line = 0;
     int column = 0;
     std::unordered_map<std::string, int64_t> labels;
+    std::string options;
+
+    // Tokens read instead of the text when they aren't null
+    const packed_tokens* fed_tokens = nullptr;
+    size_t fed_offset = 0;
 
     std::optional<program_type> type;
     bool is_dksh = false;
 
     // generic dksh
     std::optional<std::string> entrypoint;
-    int num_gprs = 8;
-    int local_mem_size = 0;
+    std::optional<int> num_gprs;
+    std::optional<int> local_mem_size;
 
     // vertex shader
     std::optional<std::string> second_entrypoint;
     int second_num_gprs = 0;
 
+    // tessellation control and geometry shaders
+    int threads_per_primitive = 1;
+
+    // geometry shader
+    int output_topology = 0;
+    int max_output_vertices = 0;
+
     // fragment shader
+    int num_render_targets = 1;
+    bool writes_depth = false;
     bool early_fragment_tests = false;
     bool post_depth_coverage = false;
     bool persample_invocation = false;
 
     // compute shader
     std::array<unsigned, 3> block_dimensions = {1, 1, 1};
-    int shared_mem_size = 0;
+    std::optional<int> shared_mem_size;
     int num_barriers = 0;
 };
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "disassemble.h"
+#include "helper.h"
+#include "table.h"
+
+// Random words tried for an entry before drawing another entry, most entries decode almost any
+// word but a few reject combinations like reserved formats
+constexpr int MAX_ATTEMPTS = 64;
+
+constexpr int MEMORY_SIZE = 0x1000;
+
+// Instructions a branch can jump over, branch offsets have 24 bits and scheduling words take
+// a fourth of the code
+constexpr size_t BRANCH_RANGE = 0x40000;
+
+constexpr int PREDICATE_SHIFT = 16;
+constexpr uint64_t PREDICATE_MASK = 0xFULL << PREDICATE_SHIFT;
+
+// Generator of the random numbers, the standard distributions aren't used because they generate
+// different programs on each standard library
+class random_generator
+{
+  public:
+    explicit random_generator(uint64_t seed) : state{seed}
+    {
+    }
+
+    // SplitMix64
+    uint64_t operator()()
+    {
+        uint64_t value = (state += 0x9E3779B97F4A7C15ULL);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    // Number from zero to count, count excluded
+    uint64_t below(uint64_t count)
+    {
+        return count == 0 ? 0 : (*this)() % count;
+    }
+
+    bool chance(double probability)
+    {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53 < probability;
+    }
+
+  private:
+    uint64_t state;
+};
+
+// Word with random operands for an entry, the predicate is kept unless an operand owns its bits
+static uint64_t random_word(random_generator& random, size_t entry, uint64_t predicate)
+{
+    const uint64_t fields = operand_fields(entry);
+    uint64_t word = table[entry].opcode | (random() & fields);
+    if (!(fields & PREDICATE_MASK)) {
+        word = (word & ~PREDICATE_MASK) | predicate << PREDICATE_SHIFT;
+    }
+    return word;
+}
+
+// Entries that can be generated from random words, label operands are generated apart to point to
+// labels in the program
+static std::vector<size_t> generated_entries(random_generator& random)
+{
+    std::vector<size_t> entries;
+    for (size_t entry = 0; entry < std::size(table); ++entry) {
+        if (std::string_view{table[entry].mnemonic} == "RAW" || has_label_operand(entry)) {
+            continue;
+        }
+        std::string text;
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+            if (disassemble_instruction(entry, random_word(random, entry, TRUE_PREDICATE), text)) {
+                entries.push_back(entry);
+                break;
+            }
+        }
+    }
+    return entries;
+}
+
+static void append_label(std::string& code, size_t label)
+{
+    char buffer[24] = "L_";
+    char* const end = std::to_chars(buffer + 2, std::end(buffer), label).ptr;
+    code.append(buffer, end);
+}
+
+std::string generate_corpus(const corpus_options& options)
+{
+    random_generator random(options.seed);
+
+    // Labels are placed first so branches can jump forward, labels are numbered in order
+    std::vector<size_t> labels;
+    for (size_t index = 0; index < options.num_instructions; ++index) {
+        if (random.chance(options.label_density)) {
+            labels.push_back(index);
+        }
+    }
+
+    std::string code;
+    code.reserve(options.num_instructions * 40);
+    if (options.is_dksh) {
+        code += ".dksh " + options.type.value_or("compute") + '\n';
+    } else if (options.type) {
+        code += ".type " + *options.type + '\n';
+    }
+    if (options.workgroup_size) {
+        const std::array<unsigned, 3>& size = *options.workgroup_size;
+        code += ".workgroup_size " + std::to_string(size[0]) + ' ' + std::to_string(size[1]) +
+                ' ' + std::to_string(size[2]) + '\n';
+    }
+    // Memory is addressed with random registers, the sizes can't be found from the code
+    code += ".local_memory " + std::to_string(MEMORY_SIZE) + '\n';
+    if (options.type == "compute" || (options.is_dksh && !options.type)) {
+        code += ".shared_memory " + std::to_string(MEMORY_SIZE) + '\n';
+    }
+    code += "main:\n";
+
+    const std::vector<size_t> entries = generated_entries(random);
+
+    size_t next_label = 0;
+    for (size_t index = 0; index < options.num_instructions; ++index) {
+        if (next_label < labels.size() && labels[next_label] == index) {
+            append_label(code, next_label++);
+            code += ":\n";
+        }
+        if (random.chance(options.branch_density)) {
+            // Branch to a label in range, instructions without one are drawn from the table
+            const size_t window_begin = index - std::min(index, BRANCH_RANGE);
+            const auto first = std::ranges::lower_bound(labels, window_begin);
+            const auto last = std::ranges::upper_bound(labels, index + BRANCH_RANGE);
+            if (first != last) {
+                code += "    @P0 BRA ";
+                append_label(code, static_cast<size_t>(first - labels.begin()) +
+                                       random.below(static_cast<uint64_t>(last - first)));
+                code += ";\n";
+                continue;
+            }
+        }
+        // Draw entries until a word decodes, a few entries reject most of their words
+        bool is_decoded = false;
+        while (!is_decoded) {
+            const size_t entry = entries[random.below(entries.size())];
+            for (int attempt = 0; attempt < MAX_ATTEMPTS && !is_decoded; ++attempt) {
+                // Most instructions are unpredicated like in real code, !PT would never run
+                const uint64_t predicate = random.chance(0.25) ? random.below(15) : TRUE_PREDICATE;
+                is_decoded =
+                    disassemble_instruction(entry, random_word(random, entry, predicate), code);
+            }
+        }
+        code += ";\n";
+    }
+    code += "    EXIT;\n";
+    return code;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Shape of a synthetic program, instructions are drawn from the instruction table
+struct corpus_options
+{
+    size_t num_instructions = 1000;
+
+    // Chance of each instruction to have a label before it
+    double label_density = 0.05;
+
+    // Chance of each instruction to be a branch to one of the labels
+    double branch_density = 0.05;
+
+    // Write the program as a DKSH, it needs a program type
+    bool is_dksh = false;
+    std::optional<std::string> type = std::nullopt;
+    std::optional<std::array<unsigned, 3>> workgroup_size = std::nullopt;
+
+    uint64_t seed = 1;
+};
+
+// Generates a random program that assembles, the same options always generate the same program
+std::string generate_corpus(const corpus_options& options);
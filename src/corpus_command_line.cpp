@@ -0,0 +1,88 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "corpus.h"
+#include "error.h"
+#include "nxas.h"
+#include "output.h"
+
+static double parse_density(const char* text)
+{
+    char* end;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0' || !(value >= 0 && value <= 1)) {
+        fatal_error("density \"%s\" is not a number between 0 and 1", text);
+    }
+    return value;
+}
+
+static uint64_t parse_count(const char* text)
+{
+    char* end;
+    const uint64_t value = std::strtoull(text, &end, 10);
+    if (*end != '\0' || *text == '-' || *text == '\0') {
+        fatal_error("\"%s\" is not a positive integer", text);
+    }
+    return value;
+}
+
+static int run(int argc, char** argv)
+{
+    corpus_options options;
+    const char* output_file = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto argument = [&](const char* syntax) {
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"%s\" %s", argv[i - 1], syntax);
+            }
+            return argv[i];
+        };
+        if (std::strcmp(argv[i], "-n") == 0 || std::strcmp(argv[i], "--instructions") == 0) {
+            options.num_instructions = parse_count(argument("<count>"));
+        } else if (std::strcmp(argv[i], "--labels") == 0) {
+            options.label_density = parse_density(argument("<density>"));
+        } else if (std::strcmp(argv[i], "--branches") == 0) {
+            options.branch_density = parse_density(argument("<density>"));
+        } else if (std::strcmp(argv[i], "--dksh") == 0) {
+            options.is_dksh = true;
+        } else if (std::strcmp(argv[i], "--type") == 0) {
+            options.type = argument("<program type>");
+        } else if (std::strcmp(argv[i], "--workgroup-size") == 0) {
+            std::array<unsigned, 3> size;
+            for (unsigned& dimension : size) {
+                dimension = static_cast<unsigned>(parse_count(argument("<x> <y> <z>")));
+            }
+            options.workgroup_size = size;
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            options.seed = parse_count(argument("<seed>"));
+        } else if (std::strcmp(argv[i], "-o") == 0) {
+            if (output_file) {
+                fatal_error("command line output file already provided");
+            }
+            output_file = argument("<output file>");
+        } else {
+            fatal_error("unknown option \"%s\"", argv[i]);
+        }
+    }
+    if (!output_file) {
+        fatal_error("no output file");
+    }
+    const std::string code = generate_corpus(options);
+    write_output(output_file, code.data(), code.size());
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    try {
+        return run(argc, argv);
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return EXIT_FAILURE;
+    }
+}
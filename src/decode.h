@@ -0,0 +1,1583 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fp16.h"
+#include "helper.h"
+#include "opcode.h"
+#include "operand.h"
+
+// Operand decoders mirroring the encoders in operand.h, the disassembler expands the instruction
+// table with them in place of the encoders. Each decoder takes the bits its encoder writes and
+// prints text the encoder reads back to the same bits, or rejects the instruction.
+
+enum class decode_pass
+{
+    // Decoders take their fields from the entry opcode to find the bits owned by operands
+    probe,
+
+    // Decoders of fields rewritten after parsing restore them as the parser writes them
+    unpack,
+
+    // Decoders print their operands
+    print,
+};
+
+struct disassembly
+{
+    // Operand bits not taken by a decoder yet
+    uint64_t value = 0;
+
+    // Bits encoded by the parser when it reaches the operand being decoded
+    uint64_t built = 0;
+
+    // Fields taken so far
+    uint64_t fields = 0;
+
+    uint32_t reuse = 0;
+    int64_t address = 0;
+    decode_pass pass = decode_pass::print;
+
+    // Set while probing by decoders that have to run in the unpack pass
+    bool needs_unpack = false;
+
+    // Texture type of TEXS and TLDS found while unpacking
+    int texture_type = 0;
+
+    // Instructions referenced by label operands, other targets are printed as addresses
+    std::vector<bool>* labels = nullptr;
+
+    std::string text;
+    bool after_number = false;
+    bool has_operand = false;
+};
+
+namespace decode
+{
+
+#define DEFINE_DECODER(name) inline bool name([[maybe_unused]] disassembly& dis)
+
+#define DECODE_FLAG(name, string, address)                                                         \
+    DEFINE_DECODER(name)                                                                           \
+    {                                                                                              \
+        return decode_flag(dis, string, address);                                                  \
+    }
+
+#define DECODE_UINT(name, max_size, address)                                                       \
+    DEFINE_DECODER(name)                                                                           \
+    {                                                                                              \
+        return decode_uint(dis, max_size, address);                                                \
+    }
+
+#define DECODE_INT(name, bits, address)                                                            \
+    DEFINE_DECODER(name)                                                                           \
+    {                                                                                              \
+        return decode_int(dis, bits, address);                                                     \
+    }
+
+// Tables leave the default value out of the text unless they are explicit
+#define DECODE_DOT_TABLE(name, default_value, address, ...)                                        \
+    DEFINE_DECODER(name)                                                                           \
+    {                                                                                              \
+        static constexpr const char* table[] = {__VA_ARGS__};                                      \
+        return decode_dot_table(dis, table, std::size(table), default_value, address, false);     \
+    }
+
+#define DECODE_EXPLICIT_DOT_TABLE(name, default_value, address, ...)                               \
+    DEFINE_DECODER(name)                                                                           \
+    {                                                                                              \
+        static constexpr const char* table[] = {__VA_ARGS__};                                      \
+        return decode_dot_table(dis, table, std::size(table), default_value, address, true);      \
+    }
+
+typedef bool (*decoder)(disassembly&);
+
+inline uint64_t take(disassembly& dis, int offset, int size)
+{
+    const uint64_t mask = max_bits(size) << offset;
+    const uint64_t bits = dis.value & mask;
+    dis.value &= ~mask;
+    dis.built |= bits;
+    dis.fields |= mask;
+    return bits >> offset;
+}
+
+// Reads bits encoded before the operand being decoded
+inline uint64_t peek(const disassembly& dis, int offset, int size)
+{
+    return (dis.built >> offset) & max_bits(size);
+}
+
+inline int64_t sign_extend(uint64_t value, int bits)
+{
+    const uint64_t sign = 1ULL << (bits - 1);
+    return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+inline void print_text(disassembly& dis, std::string_view text)
+{
+    dis.text.append(text);
+    dis.after_number = false;
+}
+
+// Starts an operand, separated from the previous one unless it follows a prefix like '-' or '['.
+// Numbers after a negation are separated or they would be read as negative numbers.
+inline void print_word(disassembly& dis, std::string_view word)
+{
+    const char last = dis.text.empty() ? ' ' : dis.text.back();
+    const bool is_number = word.front() == '-' || (word.front() >= '0' && word.front() <= '9');
+    bool is_attached;
+    switch (last) {
+    case ' ':
+    case '\n':
+    case '@':
+    case '[':
+    case '|':
+    case '~':
+        is_attached = true;
+        break;
+    case '-':
+        is_attached = !is_number;
+        break;
+    case ']':
+        is_attached = word.front() == '[';
+        break;
+    default:
+        is_attached = false;
+        break;
+    }
+    if (!is_attached) {
+        dis.text += ' ';
+    }
+    dis.text.append(word);
+    dis.after_number = false;
+    dis.has_operand = true;
+}
+
+// Prints a modifier, numbers are followed by a space or the tokenizer would read a float
+inline void print_modifier(disassembly& dis, std::string_view name)
+{
+    if (dis.after_number) {
+        dis.text += ' ';
+    }
+    dis.text += '.';
+    dis.text.append(name);
+    dis.after_number = false;
+}
+
+inline std::string_view format_hex(char (&buffer)[24], int64_t value)
+{
+    char* it = buffer;
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if (value < 0) {
+        *it++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    *it++ = '0';
+    *it++ = 'x';
+    it = std::to_chars(it, std::end(buffer), magnitude, 16).ptr;
+    return {buffer, static_cast<size_t>(it - buffer)};
+}
+
+inline void print_number(disassembly& dis, int64_t value)
+{
+    char buffer[24];
+    print_word(dis, format_hex(buffer, value));
+    dis.after_number = true;
+}
+
+inline void print_gpr(disassembly& dis, uint64_t index)
+{
+    if (index == ZERO_REGISTER) {
+        print_word(dis, "RZ");
+        return;
+    }
+    char buffer[8] = "R";
+    char* const end = std::to_chars(buffer + 1, std::end(buffer), index).ptr;
+    print_word(dis, {buffer, static_cast<size_t>(end - buffer)});
+}
+
+inline void print_reuse(disassembly& dis, int address)
+{
+    unsigned flag = 0;
+    switch (address) {
+    case 8:
+        flag = reuse_flag::gpr8;
+        break;
+    case 20:
+        flag = reuse_flag::gpr20;
+        break;
+    case 39:
+        flag = reuse_flag::gpr39;
+        break;
+    }
+    if (dis.reuse & flag) {
+        dis.reuse &= ~flag;
+        print_text(dis, ".reuse");
+    }
+}
+
+inline void print_predicate(disassembly& dis, uint64_t index, bool negated)
+{
+    char buffer[4] = "!P";
+    buffer[2] = index == TRUE_PREDICATE ? 'T' : static_cast<char>('0' + index);
+    print_word(dis, negated ? std::string_view{buffer, 3} : std::string_view{buffer + 1, 2});
+}
+
+inline bool decode_flag(disassembly& dis, const char* flag, int address)
+{
+    if (take(dis, address, 1)) {
+        print_modifier(dis, flag + 1);
+    }
+    return true;
+}
+
+inline bool decode_uint(disassembly& dis, uint64_t max_size, int address)
+{
+    const uint64_t value = take(dis, address, std::bit_width(max_size));
+    if (value > max_size) {
+        return false;
+    }
+    print_number(dis, static_cast<int64_t>(value));
+    return true;
+}
+
+inline bool decode_int(disassembly& dis, int bits, int address)
+{
+    print_number(dis, sign_extend(take(dis, address, bits), bits));
+    return true;
+}
+
+inline bool decode_dot_table(disassembly& dis, const char* const* table, size_t size,
+                             int64_t default_value, int address, bool is_explicit)
+{
+    const uint64_t max_value = std::max<uint64_t>(size - 1, std::max<int64_t>(default_value, 0));
+    const uint64_t value = take(dis, address, std::bit_width(max_value));
+    const bool is_named = value < size && *table[value] != '\0';
+    if (default_value >= 0 && value == static_cast<uint64_t>(default_value) &&
+        (!is_explicit || !is_named)) {
+        return true;
+    }
+    if (!is_named) {
+        return false;
+    }
+    print_modifier(dis, table[value]);
+    return true;
+}
+
+inline bool decode_gpr(disassembly& dis, int address)
+{
+    print_gpr(dis, take(dis, address, 8));
+    print_reuse(dis, address);
+    return true;
+}
+
+inline uint32_t float_bits(float value)
+{
+    uint32_t raw;
+    std::memcpy(&raw, &value, sizeof(raw));
+    return raw;
+}
+
+inline float bits_float(uint32_t raw)
+{
+    float value;
+    std::memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+// <cmath> isn't included, it declares an fmul function that clashes with the fmul operands
+inline bool is_negative(float value)
+{
+    return (float_bits(value) >> 31) != 0;
+}
+
+inline bool is_finite(float value)
+{
+    return (float_bits(value) & 0x7F800000) != 0x7F800000;
+}
+
+inline bool is_nan(float value)
+{
+    return !is_finite(value) && (float_bits(value) & 0x7FFFFF) != 0;
+}
+
+// Encodes a float like the parser does, keywords are QNAN and INF with their sign
+typedef uint64_t (*float_encoder)(float value, bool is_keyword);
+
+// Prints the shortest literal the parser encodes to the expected bits
+inline bool print_float(disassembly& dis, float value, uint64_t expected, float_encoder encode)
+{
+    if (!is_finite(value)) {
+        const bool negated = is_negative(value);
+        const bool nan = is_nan(value);
+        const float keyword = nan ? std::numeric_limits<float>::quiet_NaN()
+                                  : std::numeric_limits<float>::infinity();
+        if (encode(negated ? -keyword : keyword, true) != expected) {
+            return false;
+        }
+        const char* const name = nan ? "-QNAN" : "-INF";
+        print_word(dis, negated ? name : name + 1);
+        return true;
+    }
+    // The shortest literal that reads back as the same float usually encodes to the same bits
+    char buffer[192];
+    char* end = std::to_chars(buffer, buffer + 160, value, std::chars_format::fixed).ptr;
+    if (std::find(buffer, end, '.') == end) {
+        *end++ = '.';
+        *end++ = '0';
+    }
+    *end = '\0';
+    if (encode(std::strtof(buffer, nullptr), false) == expected) {
+        print_word(dis, {buffer, static_cast<size_t>(end - buffer)});
+        dis.after_number = true;
+        return true;
+    }
+    for (int precision = 1; precision < 120; ++precision) {
+        std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+        if (encode(std::strtof(buffer, nullptr), false) == expected) {
+            print_word(dis, buffer);
+            dis.after_number = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline uint64_t encode_fimm(float value, bool)
+{
+    const uint32_t raw = float_bits(value);
+    return ((raw << 1) >> 13) | static_cast<uint64_t>(raw >> 31) << 63;
+}
+
+inline uint64_t encode_fimm32(float value, bool)
+{
+    return float_bits(value);
+}
+
+inline uint64_t encode_dimm20(float value, bool is_keyword)
+{
+    const bool is_negative_keyword = is_keyword && is_negative(value);
+    const double magnitude = is_negative_keyword ? -static_cast<double>(value) : value;
+    uint64_t raw;
+    std::memcpy(&raw, &magnitude, sizeof(raw));
+    const bool negative = is_keyword ? is_negative_keyword : value < 0;
+    return ((raw << 1) >> 45) | (negative ? 1ULL : 0ULL) << 63;
+}
+
+inline uint16_t half_keyword(float value)
+{
+    return is_nan(value) ? 0x7fff : 0x7c00;
+}
+
+inline uint64_t encode_fimm9(float value, bool is_keyword)
+{
+    const uint16_t half = is_keyword ? half_keyword(value) : fp32_to_fp16(value);
+    const bool negative = is_keyword ? is_negative(value) : value < 0;
+    return (static_cast<uint16_t>(half << 1) >> 7) | (negative ? 1ULL : 0ULL) << 63;
+}
+
+inline uint64_t encode_fimm16(float value, bool is_keyword)
+{
+    if (is_keyword) {
+        return half_keyword(value) | (is_negative(value) ? 0x8000 : 0);
+    }
+    return fp32_to_fp16(value);
+}
+
+DEFINE_DECODER(comma)
+{
+    // Optional operands print nothing, a leading comma means the entry doesn't fit
+    if (!dis.has_operand) {
+        return false;
+    }
+    print_text(dis, ",");
+    return true;
+}
+
+DEFINE_DECODER(label)
+{
+    const int64_t target = label_target(take(dis, 20, 24) << 20, dis.address);
+    const std::optional<size_t> index = instruction_index(target);
+    if (dis.labels && index && *index < dis.labels->size()) {
+        (*dis.labels)[*index] = true;
+        char buffer[24] = "L_";
+        char* const end = std::to_chars(buffer + 2, std::end(buffer), target, 16).ptr;
+        print_word(dis, {buffer, static_cast<size_t>(end - buffer)});
+        return true;
+    }
+    print_number(dis, target);
+    return true;
+}
+
+DEFINE_DECODER(raw)
+{
+    const uint64_t high = take(dis, 32, 32);
+    const uint64_t low = take(dis, 0, 32);
+    print_number(dis, static_cast<int64_t>(high));
+    print_text(dis, ",");
+    print_number(dis, static_cast<int64_t>(low));
+    return true;
+}
+
+template <int address>
+DEFINE_DECODER(dgpr)
+{
+    return decode_gpr(dis, address);
+}
+
+template <int address>
+DEFINE_DECODER(sgpr)
+{
+    return decode_gpr(dis, address);
+}
+
+template <int address>
+DEFINE_DECODER(mirror_dgpr)
+{
+    print_gpr(dis, peek(dis, address, 8));
+    return true;
+}
+
+DEFINE_DECODER(cbuf)
+{
+    const uint64_t index = take(dis, 34, 5);
+    const int64_t offset = sign_extend(take(dis, 20, 14), 14) * 4;
+    char index_buffer[24];
+    char offset_buffer[24];
+    std::string word = "c[";
+    word += format_hex(index_buffer, static_cast<int64_t>(index));
+    word += "][";
+    word += format_hex(offset_buffer, offset);
+    word += ']';
+    print_word(dis, word);
+    return true;
+}
+
+DEFINE_DECODER(imm)
+{
+    const uint64_t raw = take(dis, 20, 19) | take(dis, 56, 1) << 19;
+    print_number(dis, sign_extend(raw, 20));
+    return true;
+}
+
+DEFINE_DECODER(fimm)
+{
+    const uint64_t field = take(dis, 20, 19);
+    const uint64_t sign = take(dis, 56, 1);
+    const float value = bits_float(static_cast<uint32_t>(field << 12 | sign << 31));
+    return print_float(dis, value, field | sign << 63, encode_fimm);
+}
+
+DEFINE_DECODER(fimm32)
+{
+    const uint64_t raw = take(dis, 20, 32);
+    return print_float(dis, bits_float(static_cast<uint32_t>(raw)), raw, encode_fimm32);
+}
+
+DEFINE_DECODER(dimm20)
+{
+    const uint64_t field = take(dis, 20, 19);
+    const uint64_t sign = take(dis, 56, 1);
+    const uint64_t raw = field << 44 | sign << 63;
+    double value;
+    std::memcpy(&value, &raw, sizeof(value));
+    // Literals are read as floats, doubles they can't represent are rejected
+    const float narrowed = static_cast<float>(value);
+    if (value == value && static_cast<double>(narrowed) != value) {
+        return false;
+    }
+    return print_float(dis, narrowed, field | sign << 63, encode_dimm20);
+}
+
+inline bool decode_fimm9(disassembly& dis, int offset, int neg_bit)
+{
+    const uint64_t field = take(dis, offset, 9);
+    const uint64_t negative = take(dis, neg_bit, 1);
+    const float value = fp16_to_fp32(static_cast<uint16_t>(field << 6 | negative << 15));
+    return print_float(dis, value, field | negative << 63, encode_fimm9);
+}
+
+template <int neg_bit>
+DEFINE_DECODER(fimm9_low)
+{
+    return decode_fimm9(dis, 20, neg_bit);
+}
+
+template <int neg_bit>
+DEFINE_DECODER(fimm9_high)
+{
+    return decode_fimm9(dis, 30, neg_bit);
+}
+
+inline bool decode_fimm16(disassembly& dis, int offset)
+{
+    const uint64_t raw = take(dis, offset, 16);
+    return print_float(dis, fp16_to_fp32(static_cast<uint16_t>(raw)), raw, encode_fimm16);
+}
+
+DEFINE_DECODER(fimm16_low)
+{
+    return decode_fimm16(dis, 20);
+}
+
+DEFINE_DECODER(fimm16_high)
+{
+    return decode_fimm16(dis, 36);
+}
+
+DECODE_UINT(uimm32, UINT32_MAX, 20);
+
+DECODE_INT(simm32, 32, 20);
+
+DECODE_UINT(uimm16, UINT16_MAX, 20);
+
+DEFINE_DECODER(uimm_extended)
+{
+    const uint64_t value = take(dis, 20, 19) + take(dis, 56, 1) * 0x80000;
+    print_number(dis, static_cast<int64_t>(value));
+    return true;
+}
+
+template <int address = 47>
+DECODE_FLAG(cc, ".CC", address);
+
+template <int bits, int address>
+DECODE_UINT(uinteger, max_bits(bits), address);
+
+template <int bits, int address>
+DECODE_INT(sinteger, bits, address);
+
+template <int address>
+DECODE_UINT(mask4, 0xf, address);
+
+template <int address>
+DECODE_FLAG(psl, ".PSL", address);
+
+template <int address>
+DECODE_FLAG(x, ".X", address);
+
+template <int address>
+DECODE_FLAG(mrg, ".MRG", address);
+
+template <int address>
+DECODE_DOT_TABLE(half, 0, address, "H0", "H1");
+
+template <int address>
+DECODE_FLAG(brev, ".BREV", address);
+
+template <int address>
+DECODE_FLAG(ftz, ".FTZ", address);
+
+template <int address>
+DECODE_FLAG(sat, ".SAT", address);
+
+template <int address>
+DECODE_FLAG(bf, ".BF", address);
+
+template <int address>
+DECODE_FLAG(h_and, ".H_AND", address);
+
+template <int address>
+DECODE_FLAG(u, ".U", address);
+
+template <int address>
+DECODE_FLAG(lmt, ".LMT", address);
+
+template <int address>
+DECODE_FLAG(w, ".W", address);
+
+// The default format is printed, F2F would read a lone source format as the destination
+template <int address>
+DECODE_EXPLICIT_DOT_TABLE(float_format, 2, address, "", "F16", "F32", "F64");
+
+template <int address>
+DECODE_DOT_TABLE(byte_selector, 0, address, "B0", "B1", "B2", "B3");
+
+template <int address>
+DECODE_DOT_TABLE(fp_rounding, 0, address, "RN", "RM", "RP", "RZ");
+
+template <int address>
+DECODE_DOT_TABLE(bop, -1, address, "AND", "OR", "XOR", "INVALIDBOP3");
+
+template <int address, bool negable = false>
+DEFINE_DECODER(pred)
+{
+    const uint64_t index = take(dis, address, 3);
+    const bool negated = negable && take(dis, address + 3, 1);
+    print_predicate(dis, index, negated);
+    return true;
+}
+
+template <int address>
+DEFINE_DECODER(inverted_pred)
+{
+    print_predicate(dis, 7 - take(dis, address, 3), false);
+    return true;
+}
+
+template <int address>
+DEFINE_DECODER(neg)
+{
+    if (take(dis, address, 1)) {
+        print_word(dis, "-");
+    }
+    return true;
+}
+
+template <int address>
+DEFINE_DECODER(tilde)
+{
+    if (take(dis, address, 1)) {
+        print_word(dis, "~");
+    }
+    return true;
+}
+
+template <int address>
+DECODE_FLAG(post_neg, ".NEG", address);
+
+template <int address>
+DECODE_FLAG(post_abs, ".ABS", address);
+
+template <int address, decoder inner>
+DEFINE_DECODER(abs)
+{
+    const bool is_absolute = take(dis, address, 1) != 0;
+    if (is_absolute) {
+        print_word(dis, "|");
+    }
+    if (!inner(dis)) {
+        return false;
+    }
+    if (is_absolute) {
+        print_text(dis, "|");
+    }
+    return true;
+}
+
+// Shares its bits with negations, it's taken only when both bits are set
+template <int address1, int address2>
+DEFINE_DECODER(po)
+{
+    const uint64_t mask = (1ULL << address1) | (1ULL << address2);
+    if (dis.pass == decode_pass::probe || (dis.value & mask) == mask) {
+        take(dis, address1, 1);
+        take(dis, address2, 1);
+        if (dis.pass != decode_pass::probe) {
+            print_modifier(dis, "PO");
+        }
+    }
+    return true;
+}
+
+template <int address>
+DECODE_FLAG(sh, ".SH", address);
+
+template <int address>
+DECODE_FLAG(inv, ".INV", address);
+
+template <int address>
+DEFINE_DECODER(default_rz)
+{
+    return take(dis, address, 8) == 0xFF;
+}
+
+namespace memory
+{
+    DECODE_DOT_TABLE(size, 4, 48, "U8", "S8", "U16", "S16", "32", "64", "128");
+
+    // Prints the bracketed address with its register and offset
+    inline bool decode_address(disassembly& dis, bool imm_offset, int addr, int size, int shr)
+    {
+        const uint64_t regster = take(dis, 8, 8);
+        const uint64_t field = imm_offset ? take(dis, addr, size) : 0;
+        const bool is_zero_reg = regster == ZERO_REGISTER;
+        const int64_t offset = (is_zero_reg ? static_cast<int64_t>(field)
+                                            : sign_extend(field, size)) *
+                               (int64_t{1} << shr);
+        const int64_t min = is_zero_reg ? 0 : -(int64_t{1} << (size - 1));
+        const int64_t max = static_cast<int64_t>(max_bits(is_zero_reg ? size : (size - 1)));
+        if (offset < min || offset > max) {
+            return false;
+        }
+
+        print_word(dis, "[");
+        char buffer[24];
+        if (!is_zero_reg) {
+            print_gpr(dis, regster);
+            print_reuse(dis, 8);
+            if (offset != 0) {
+                const std::string_view number = format_hex(buffer, offset);
+                print_text(dis, offset > 0 ? "+" : "");
+                print_text(dis, number);
+            }
+        } else if (imm_offset) {
+            print_text(dis, format_hex(buffer, offset));
+        } else {
+            print_text(dis, "RZ");
+        }
+        print_text(dis, "]");
+        return true;
+    }
+
+    template <bool imm_offset = true, int addr = 20, int size = 24, int shr = 0>
+    DEFINE_DECODER(address)
+    {
+        return decode_address(dis, imm_offset, addr, size, shr);
+    }
+}
+
+DEFINE_DECODER(flow_tests)
+{
+    static constexpr const char* tests[] = {
+        "F",       "LT",      "EQ",      "LE",  "GT",  "NE",   "GE",     "NUM",    "NAN",
+        "LTU",     "EQU",     "LEU",     "GTU", "NEU", "GEU",  "T",      "OFF",    "LO",
+        "SFF",     "LS",      "HI",      "SFT", "HS",  "OFT",  "CSM_TA", "CSM_TR", "CSM_MX",
+        "FCSM_TA", "FCSM_TR", "FCSM_MX", "RLE", "RGT"};
+    const uint64_t test = take(dis, 0, 5);
+    if (test != 15) {
+        print_word(dis, "CC");
+        print_modifier(dis, tests[test]);
+    }
+    return true;
+}
+
+DECODE_FLAG(keeprefcount, ".KEEPREFCOUNT", 5);
+
+template <int address>
+DECODE_DOT_TABLE(store_cache, 0, address, "", "CG", "CS", "WT");
+
+namespace rro
+{
+    DECODE_DOT_TABLE(mode, -1, 39, "SINCOS", "EX2");
+}
+
+template <int address>
+DECODE_DOT_TABLE(load_cache, 0, address, "", "CG", "CI", "CV");
+
+namespace lop
+{
+    template <int address>
+    DECODE_DOT_TABLE(bit_op, -1, address, "AND", "OR", "XOR", "PASS_B");
+
+    DECODE_DOT_TABLE(pred_op, 0, 44, "", "T", "Z", "NZ");
+}
+
+namespace amem
+{
+    DECODE_DOT_TABLE(size, 0, 47, "32", "64", "96", "128");
+}
+
+namespace ald
+{
+    DECODE_FLAG(o, ".O", 32);
+
+    DEFINE_DECODER(p)
+    {
+        if (!take(dis, 31, 1)) {
+            return false;
+        }
+        print_modifier(dis, "P");
+        return true;
+    }
+
+    DEFINE_DECODER(phys)
+    {
+        print_modifier(dis, "PHYS");
+        return true;
+    }
+
+    DECODE_DOT_TABLE(size, 0, 47, "32", "64", "96", "128");
+
+    DEFINE_DECODER(imm_attr)
+    {
+        const uint64_t attribute = take(dis, 20, 10);
+        if (take(dis, 8, 8) != 0xFF) {
+            return false;
+        }
+        char buffer[24];
+        std::string word = "a[";
+        word += format_hex(buffer, static_cast<int64_t>(attribute));
+        word += ']';
+        print_word(dis, word);
+        return true;
+    }
+
+    DEFINE_DECODER(patch_attr)
+    {
+        print_word(dis, "a[");
+        decode_gpr(dis, 8);
+        const int64_t offset = sign_extend(take(dis, 20, 11), 11);
+        char buffer[24];
+        print_text(dis, offset < 0 ? "" : "+");
+        print_text(dis, format_hex(buffer, offset));
+        print_text(dis, "]");
+        return true;
+    }
+
+    DEFINE_DECODER(phys_attr)
+    {
+        print_word(dis, "a[");
+        decode_gpr(dis, 8);
+        print_text(dis, "]");
+        return true;
+    }
+}
+
+namespace al2p
+{
+    DECODE_FLAG(o, ".O", 32);
+}
+
+namespace b2r
+{
+    DEFINE_DECODER(warp)
+    {
+        const uint64_t mode = take(dis, 32, 4);
+        if (take(dis, 8, 8) != 0xFF || mode != 0xE) {
+            return false;
+        }
+        print_modifier(dis, "WARP");
+        return true;
+    }
+
+    DEFINE_DECODER(result)
+    {
+        const uint64_t mode = take(dis, 32, 4);
+        if (take(dis, 8, 8) != 0xFF || mode != 0xD) {
+            return false;
+        }
+        print_modifier(dis, "RESULT");
+        return true;
+    }
+}
+
+namespace nop
+{
+    DECODE_FLAG(trig, ".TRIG", 13);
+    DECODE_UINT(mask, UINT16_MAX, 20);
+}
+
+DEFINE_DECODER(cc_text)
+{
+    print_word(dis, "CC");
+    return true;
+}
+
+DECODE_DOT_TABLE(cc_tests, 15, 8, "F", "LT", "EQ", "LE", "GT", "NE", "GE", "NUM", "NAN", "LTU",
+                 "EQU", "LEU", "GTU", "NEU", "GEU", "T", "OFF", "LO", "SFF", "LS", "HI", "SFT",
+                 "HS", "OFT", "CSM_TA", "CSM_TR", "CSM_MX", "FCSM_TA", "FCSM_TR", "FCSM_MX", "RLE",
+                 "RGT");
+
+namespace xmad
+{
+    DEFINE_DECODER(signs)
+    {
+        const uint64_t a = take(dis, 48, 1);
+        const uint64_t b = take(dis, 49, 1);
+        if (a || b) {
+            print_modifier(dis, a ? "S16" : "U16");
+            print_modifier(dis, b ? "S16" : "U16");
+        }
+        return true;
+    }
+
+    DECODE_DOT_TABLE(mode_a, 0, 50, "", "CLO", "CHI", "CSFU", "CBCC");
+    DECODE_DOT_TABLE(mode_b, 0, 50, "", "CLO", "CHI", "CSFU");
+}
+
+namespace lop3
+{
+    DECODE_DOT_TABLE(operation, 0, 36, "", "T", "Z", "NZ");
+
+    DEFINE_DECODER(lut)
+    {
+        print_modifier(dis, "LUT");
+        return true;
+    }
+}
+
+namespace shr
+{
+    DECODE_DOT_TABLE(format, 1, 48, "U32", "S32");
+    DECODE_DOT_TABLE(mode, 0, 39, "C", "W");
+    DECODE_DOT_TABLE(xmode, 0, 43, "", "INVALIDSHRXMODE1", "X", "XHI");
+}
+
+namespace bfe
+{
+    DECODE_DOT_TABLE(format, 1, 48, "U32", "S32");
+}
+
+namespace bpt
+{
+    DECODE_DOT_TABLE(mode, -1, 6, "DRAIN_ILLEGAL", "CAL", "PAUSE", "TRAP", "INT", "DRAIN");
+}
+
+namespace stg
+{
+    DECODE_FLAG(e, ".E", 45);
+
+    DECODE_DOT_TABLE(size, 4, 48, "U8", "S8", "U16", "S16", "32", "64", "128");
+}
+
+namespace f2f
+{
+    // Bit 41 between the rounding bits belongs to the source half
+    DEFINE_DECODER(rounding)
+    {
+        const uint64_t value = take(dis, 39, 2) | take(dis, 42, 1) << 3;
+        if (peek(dis, 8, 2) == peek(dis, 10, 2)) {
+            switch (value) {
+            case 0b0000:
+                return true;
+            case 0b1000:
+                print_modifier(dis, "ROUND");
+                return true;
+            case 0b1001:
+                print_modifier(dis, "FLOOR");
+                return true;
+            case 0b1010:
+                print_modifier(dis, "CEIL");
+                return true;
+            case 0b1011:
+                print_modifier(dis, "TRUNC");
+                return true;
+            case 0b0011:
+                print_modifier(dis, "PASS");
+                return true;
+            }
+            return false;
+        }
+        static constexpr const char* table[] = {"RN", "RM", "RP", "RZ"};
+        if (value >= std::size(table)) {
+            return false;
+        }
+        if (value != 0) {
+            print_modifier(dis, table[value]);
+        }
+        return true;
+    }
+}
+
+namespace fmul
+{
+    template <int address>
+    DECODE_DOT_TABLE(fmz, 0, address, "", "FTZ", "FMZ", "INVALIDFMZ3");
+
+    DECODE_DOT_TABLE(scale, 0, 41, "", "D2", "D4", "D8", "M8", "M4", "M2", "INVALIDSCALE37");
+}
+
+namespace iadd3
+{
+    DECODE_DOT_TABLE(shift, 0, 37, "", "RS", "LS");
+
+    template <int address>
+    DECODE_DOT_TABLE(half, 0, address, "", "H0", "H1");
+}
+
+namespace f2i
+{
+    DEFINE_DECODER(int_format)
+    {
+        static constexpr const char* table_unsigned[] = {"INVALID0", "U16", "U32", "U64"};
+        static constexpr const char* table_signed[] = {"INVALID1", "S16", "S32", "S64"};
+        const uint64_t index = take(dis, 8, 2);
+        print_modifier(dis, take(dis, 12, 1) ? table_signed[index] : table_unsigned[index]);
+        return true;
+    }
+
+    DECODE_DOT_TABLE(rounding, 0, 39, "", "FLOOR", "CEIL", "TRUNC");
+}
+
+namespace p2r
+{
+    template <int address>
+    DEFINE_DECODER(mode)
+    {
+        print_word(dis, take(dis, address, 1) ? "CC" : "PR");
+        return true;
+    }
+}
+
+namespace fp16
+{
+    template <int address>
+    DECODE_DOT_TABLE(merge, 0, address, "", "F32", "MRG_H0", "MRG_H1");
+
+    template <int address>
+    DECODE_DOT_TABLE(control, 0, address, "", "FTZ", "FMZ");
+
+    template <int address>
+    DECODE_DOT_TABLE(swizzle, 0, address, "H1_H0", "F32", "H0_H0", "H1_H1");
+}
+
+namespace stl
+{
+    DECODE_DOT_TABLE(cache, 0, 44, "", "CG", "CS", "WT");
+}
+
+namespace lds
+{
+    DECODE_FLAG(u, ".U", 44);
+}
+
+template <int address>
+DECODE_DOT_TABLE(float_compare, -1, address, "F", "LT", "EQ", "LE", "GT", "NE", "GE", "NUM", "NAN",
+                 "LTU", "EQU", "LEU", "GTU", "NEU", "GEU", "T");
+
+template <int address>
+DECODE_DOT_TABLE(integer_compare, -1, address, "F", "LT", "EQ", "LE", "GT", "NE", "GE", "T");
+
+namespace vsetp
+{
+    // Bits between the halves of the comparison belong to the boolean operation
+    template <int address>
+    DEFINE_DECODER(integer_compare)
+    {
+        static constexpr const char* table[] = {"F", "LT", "EQ", "LE", "GT", "NE", "GE", "T"};
+        const uint64_t value = take(dis, address, 2) | take(dis, address + 4, 1) << 2;
+        print_modifier(dis, table[value]);
+        return true;
+    }
+}
+
+namespace mufu
+{
+    DECODE_DOT_TABLE(operation, -1, 20, "COS", "SIN", "EX2", "LG2", "RCP", "RSQ", "RCP64H",
+                     "RSQ64H", "SQRT");
+}
+
+namespace imnmx
+{
+    DECODE_DOT_TABLE(mode, 0, 43, "", "XLO", "XMED", "XHI");
+}
+
+namespace ldc
+{
+    DECODE_DOT_TABLE(mode, 0, 44, "", "IL", "IS", "ISL");
+    DECODE_DOT_TABLE(size, -1, 48, "U8", "S8", "U16", "S16", "32", "64");
+
+    DEFINE_DECODER(address)
+    {
+        char buffer[24];
+        std::string word = "c[";
+        word += format_hex(buffer, static_cast<int64_t>(take(dis, 36, 5)));
+        word += ']';
+        print_word(dis, word);
+        return memory::decode_address(dis, true, 20, 16, 0);
+    }
+}
+
+namespace image
+{
+    DEFINE_DECODER(p)
+    {
+        print_modifier(dis, "P");
+        return true;
+    }
+
+    DEFINE_DECODER(d)
+    {
+        if (!take(dis, 52, 1)) {
+            return false;
+        }
+        print_modifier(dis, "D");
+        return true;
+    }
+
+    template <int address>
+    DECODE_FLAG(ba, ".BA", address);
+
+    DECODE_DOT_TABLE(type, -1, 33, "1D", "1D_BUFFER", "1D_ARRAY", "2D", "2D_ARRAY", "3D");
+
+    DECODE_DOT_TABLE(rgba, 15, 20, "", "R", "G", "RG", "B", "RB", "GB", "RGB", "A", "RA", "GA",
+                     "RGA", "BA", "RBA", "GBA", "RGBA");
+
+    DECODE_DOT_TABLE(size, 4, 20, "U8", "S8", "U16", "S16", "32", "64", "128");
+
+    DECODE_DOT_TABLE(clamp, 1, 49, "IGN", "", "TRAP");
+}
+
+DEFINE_DECODER(s2r)
+{
+    static constexpr const char* components[] = {"X", "Y", "Z"};
+    const uint64_t value = take(dis, 20, 8);
+    if (value == 32) {
+        print_word(dis, "SR_TID");
+    } else if (value >= 33 && value <= 35) {
+        print_word(dis, "SR_TID");
+        print_modifier(dis, components[value - 33]);
+    } else if (value >= 37 && value <= 39) {
+        print_word(dis, "SR_CTAID");
+        print_modifier(dis, components[value - 37]);
+    } else if (*system_registers[value] != '\0') {
+        print_word(dis, system_registers[value]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace shfl
+{
+    DECODE_DOT_TABLE(mode, -1, 30, "IDX", "UP", "DOWN", "BFLY");
+}
+
+DECODE_DOT_TABLE(int_sign, 1, 48, "U32", "S32");
+
+namespace ldg
+{
+    DEFINE_DECODER(size)
+    {
+        static constexpr const char* table[] = {"U8", "S8", "U16", "S16", "32", "64", "128"};
+        const uint64_t value = take(dis, 48, 3);
+        if (value == 7) {
+            print_modifier(dis, "U");
+            print_modifier(dis, "128");
+        } else if (value != 4) {
+            print_modifier(dis, table[value]);
+        }
+        return true;
+    }
+
+    DECODE_DOT_TABLE(cache, 0, 46, "", "CG", "CI", "CV");
+}
+
+// Selects bytes or shorts of the source depending on its format
+inline bool decode_selector(disassembly& dis, bool is_short, const char* const* shorts,
+                            size_t num_shorts, int address)
+{
+    static constexpr const char* bytes[] = {"B0", "B1", "B2", "B3"};
+    const uint64_t value = take(dis, address, 2);
+    if (value == 0) {
+        return true;
+    }
+    if (is_short && value >= num_shorts) {
+        return false;
+    }
+    print_modifier(dis, is_short ? shorts[value] : bytes[value]);
+    return true;
+}
+
+namespace i2f
+{
+    DEFINE_DECODER(int_format)
+    {
+        static constexpr const char* table_unsigned[] = {"U8", "U16", "U32", "U64"};
+        static constexpr const char* table_signed[] = {"S8", "S16", "S32", "S64"};
+        const uint64_t index = take(dis, 10, 2);
+        print_modifier(dis, take(dis, 13, 1) ? table_signed[index] : table_unsigned[index]);
+        return true;
+    }
+
+    DEFINE_DECODER(selector)
+    {
+        static constexpr const char* shorts[] = {"H0", "INVALIDSIZE1", "H1", "INVALIDSIZE3"};
+        return decode_selector(dis, peek(dis, 10, 3) == 1, shorts, std::size(shorts), 41);
+    }
+}
+
+namespace i2i
+{
+    template <int address, int sign_address>
+    DEFINE_DECODER(format)
+    {
+        static constexpr const char* table_unsigned[] = {"U8", "U16", "U32"};
+        static constexpr const char* table_signed[] = {"S8", "S16", "S32"};
+        const uint64_t index = take(dis, address, 2);
+        const bool is_signed = take(dis, sign_address, 1) != 0;
+        if (index == 3) {
+            return false;
+        }
+        print_modifier(dis, is_signed ? table_signed[index] : table_unsigned[index]);
+        return true;
+    }
+
+    DEFINE_DECODER(selector)
+    {
+        static constexpr const char* shorts[] = {"H0", "INVALIDSIZE1", "H1", "INVALIDSIZE3"};
+        return decode_selector(dis, peek(dis, 10, 3) == 1, shorts, std::size(shorts), 41);
+    }
+}
+
+namespace atoms
+{
+    DECODE_DOT_TABLE(operation, -1, 52, "ADD", "MIN", "MAX", "INC", "DEC", "AND", "OR", "XOR",
+                     "EXCH");
+
+    DECODE_DOT_TABLE(size, -1, 28, "U32", "S32", "U64", "S64");
+}
+
+namespace ldl
+{
+    DECODE_DOT_TABLE(cache, 0, 44, "", "LU", "CI", "CV");
+}
+
+template <int address>
+DEFINE_DECODER(atomic_size)
+{
+    const uint64_t value = take(dis, address, 3);
+    switch (value) {
+    case 0:
+        return true;
+    case 1:
+        print_modifier(dis, "S32");
+        return true;
+    case 2:
+        print_modifier(dis, "U64");
+        return true;
+    case 3:
+        print_modifier(dis, "F32");
+        print_modifier(dis, "FTZ");
+        print_modifier(dis, "RN");
+        return true;
+    case 4:
+        print_modifier(dis, "F16x2");
+        print_modifier(dis, "RN");
+        return true;
+    case 5:
+        print_modifier(dis, "S64");
+        return true;
+    }
+    return false;
+}
+
+namespace vote
+{
+    DECODE_DOT_TABLE(operation, -1, 48, "ALL", "ANY", "EQ");
+}
+
+namespace atom
+{
+    DECODE_FLAG(e, ".E", 48);
+
+    DECODE_DOT_TABLE(operation, -1, 52, "ADD", "MIN", "MAX", "INC", "DEC", "AND", "OR", "XOR",
+                     "EXCH", "SAFEADD");
+}
+
+namespace lea
+{
+    DEFINE_DECODER(hi)
+    {
+        print_modifier(dis, "HI");
+        return true;
+    }
+
+    DEFINE_DECODER(lo)
+    {
+        return true;
+    }
+}
+
+namespace shf
+{
+    DEFINE_DECODER(r)
+    {
+        print_modifier(dis, "R");
+        return true;
+    }
+
+    DEFINE_DECODER(l)
+    {
+        print_modifier(dis, "L");
+        return true;
+    }
+
+    DECODE_DOT_TABLE(max_shift, 0, 37, "32", "INVALIDMAXSHIFT3", "U64", "S64");
+
+    DECODE_DOT_TABLE(xmode, 0, 48, "", "HI", "X", "XHI");
+}
+
+DECODE_DOT_TABLE(noinc, 1, 6, "NOINC", "INC");
+
+namespace video
+{
+    DECODE_DOT_TABLE(dest_sign, 1, 54, "UD", "SD");
+
+    // Always printed, VMAD would otherwise read the format of the second source as the first
+    template <int address, int sign_address>
+    DEFINE_DECODER(src_format)
+    {
+        static constexpr const char* signed_table[] = {"S8", "", "S16", "S32"};
+        static constexpr const char* unsigned_table[] = {"U8", "", "U16", "U32"};
+        uint64_t index = take(dis, address, 2);
+        const bool is_signed = take(dis, sign_address, 1) != 0;
+        if (index == 1 && dis.pass != decode_pass::probe) {
+            // Bytes 2 and 3 of the selector share the low bit, leave it to the selector
+            dis.value |= 1ULL << address;
+            dis.built &= ~(1ULL << address);
+            index = 0;
+        }
+        print_modifier(dis, is_signed ? signed_table[index] : unsigned_table[index]);
+        return true;
+    }
+
+    template <int address>
+    DECODE_DOT_TABLE(mx, 0, address, "MN", "MX");
+
+    template <int address>
+    DECODE_DOT_TABLE(vmnmx_op, 7, address, "MRG_16H", "MRG_16L", "MRG_8B0", "MRG_8B2", "ACC",
+                     "MIN", "MAX");
+
+    template <int address, int type_address>
+    DEFINE_DECODER(selector)
+    {
+        static constexpr const char* shorts[] = {"H0", "H1"};
+        return decode_selector(dis, peek(dis, type_address, 3) == 2, shorts, std::size(shorts),
+                               address);
+    }
+
+    template <int address, int sign_address>
+    DEFINE_DECODER(imm_format)
+    {
+        if (!take(dis, sign_address, 1)) {
+            print_modifier(dis, "U16");
+        }
+        return true;
+    }
+}
+
+namespace vmad
+{
+    DECODE_DOT_TABLE(scale, 0, 51, "", "SHR_7", "SHR_15", "INVALIDVMADSCALE3");
+}
+
+namespace red
+{
+    DECODE_FLAG(e, ".E", 48);
+
+    DECODE_DOT_TABLE(operation, 0, 23, "ADD", "MIN", "MAX", "INC", "DEC", "AND", "OR", "XOR");
+}
+
+template <int address>
+DECODE_FLAG(ndv, ".NDV", address);
+
+template <int address>
+DECODE_FLAG(nodep, ".NODEP", address);
+
+template <int address>
+DECODE_FLAG(dc, ".DC", address);
+
+template <int address>
+DECODE_FLAG(aoffi, ".AOFFI", address);
+
+template <int address>
+DECODE_FLAG(lc, ".LC", address);
+
+template <int address>
+DECODE_DOT_TABLE(blod, 0, address, "", "LZ", "LB", "LL", "INVALIDBLOD4", "INVALIDBLOD5", "LBA",
+                 "LLA");
+
+template <int address>
+DEFINE_DECODER(tex_type)
+{
+    static constexpr const char* types[]{
+        "1D", "ARRAY_1D", "2D", "ARRAY_2D", "3D", "ARRAY_3D", "CUBE", "ARRAY_CUBE",
+    };
+    print_word(dis, types[take(dis, address, 3)]);
+    return true;
+}
+
+DEFINE_DECODER(b_text)
+{
+    print_modifier(dis, "B");
+    return true;
+}
+
+DEFINE_DECODER(lod_text)
+{
+    print_modifier(dis, "LOD");
+    return true;
+}
+
+DEFINE_DECODER(zero)
+{
+    print_number(dis, 0);
+    return true;
+}
+
+template <int address>
+DECODE_DOT_TABLE(sample_size, 1, address, "F16", "");
+
+template <int address>
+DECODE_DOT_TABLE(sample_size_inv, 0, address, "", "F16");
+
+// Reads the payload written by texs_type in the unpack pass
+template <int address>
+DEFINE_DECODER(texs_mode)
+{
+    const uint64_t payload = take(dis, address, 3);
+    switch (static_cast<Lod>(payload & 0b011)) {
+    case Lod::None:
+        break;
+    case Lod::LL:
+        print_modifier(dis, "LL");
+        break;
+    case Lod::LZ:
+        print_modifier(dis, "LZ");
+        break;
+    default:
+        return false;
+    }
+    if (payload & 0b100) {
+        print_modifier(dis, "DC");
+    }
+    return true;
+}
+
+template <int address>
+DEFINE_DECODER(tlds_type)
+{
+    static constexpr const char* table[]{"1D", "2D", "3D", "ARRAY_2D"};
+    struct mode
+    {
+        int type;
+        bool ll;
+        bool aoffi;
+        bool ms;
+    };
+    static constexpr std::optional<mode> modes[16]{
+        mode{0, false, false, false}, mode{0, true, false, false}, mode{1, false, false, false},
+        std::nullopt,                 mode{1, false, true, false}, mode{1, true, false, false},
+        mode{1, false, false, true},  mode{2, false, false, false}, mode{3, false, false, false},
+        std::nullopt,                 std::nullopt,                std::nullopt,
+        mode{1, true, true, false},
+    };
+    switch (dis.pass) {
+    case decode_pass::probe:
+        dis.needs_unpack = true;
+        take(dis, address, 4);
+        return true;
+    case decode_pass::unpack: {
+        const std::optional<mode> mode = modes[(dis.value >> address) & 0xF];
+        if (!mode) {
+            return false;
+        }
+        dis.value &= ~(0xFULL << address);
+        dis.value |= ((mode->ll ? 1ULL : 0ULL) | (mode->aoffi ? 2ULL : 0ULL) |
+                      (mode->ms ? 4ULL : 0ULL))
+                     << address;
+        dis.texture_type = mode->type;
+        return true;
+    }
+    case decode_pass::print:
+        print_word(dis, table[dis.texture_type]);
+        return true;
+    }
+    return false;
+}
+
+template <int address>
+DEFINE_DECODER(texs_type)
+{
+    static constexpr const char* table[]{
+        "1D", "2D", "", "", "", "", "", "ARRAY_2D", "", "", "3D", "", "CUBE", "",
+    };
+    struct mode
+    {
+        int type;
+        Lod lod;
+        bool dc;
+    };
+    static constexpr mode modes[]{
+        {0, Lod::LZ, false},   {1, Lod::None, false}, {1, Lod::LZ, false}, {1, Lod::LL, false},
+        {1, Lod::None, true},  {1, Lod::LL, true},    {1, Lod::LZ, true},  {7, Lod::None, false},
+        {7, Lod::LZ, false},   {7, Lod::LZ, true},    {10, Lod::None, false},
+        {10, Lod::LZ, false},  {12, Lod::None, false}, {12, Lod::LL, false},
+    };
+    switch (dis.pass) {
+    case decode_pass::probe:
+        dis.needs_unpack = true;
+        take(dis, address, 4);
+        return true;
+    case decode_pass::unpack: {
+        const uint64_t code = (dis.value >> address) & 0xF;
+        if (code >= std::size(modes)) {
+            return false;
+        }
+        const mode& mode = modes[code];
+        dis.value &= ~(0xFULL << address);
+        dis.value |= ((mode.dc ? 0b100ULL : 0ULL) | static_cast<uint64_t>(mode.lod)) << address;
+        dis.texture_type = mode.type;
+        return true;
+    }
+    case decode_pass::print:
+        print_word(dis, table[dis.texture_type]);
+        return true;
+    }
+    return false;
+}
+
+DEFINE_DECODER(texs_swizzle)
+{
+    static constexpr const char* single[]{"R", "G", "B", "A", "RG", "RA", "GA", "BA"};
+    static constexpr const char* pair[]{"RGB", "RGA", "RBA", "GBA", "RGBA"};
+    const uint64_t value = take(dis, 50, 3);
+    if (peek(dis, 28, 8) == 0xFF) {
+        // A lone R is read as the register R0
+        if (value == 0) {
+            return false;
+        }
+        print_word(dis, single[value]);
+        return true;
+    }
+    if (value >= std::size(pair)) {
+        return false;
+    }
+    print_word(dis, pair[value]);
+    return true;
+}
+
+namespace tld4
+{
+    template <int address>
+    DECODE_DOT_TABLE(component, -1, address, "R", "G", "B", "A");
+
+    template <int address>
+    DECODE_DOT_TABLE(offset, 0, address, "", "AOFFI", "PTP");
+}
+
+namespace tld
+{
+    template <int address>
+    DECODE_DOT_TABLE(lod, -1, address, "LZ", "LL");
+}
+
+template <int address>
+DECODE_FLAG(ms, ".MS", address);
+
+template <int address>
+DECODE_FLAG(cl, ".CL", address);
+
+namespace txq
+{
+    DEFINE_DECODER(mode)
+    {
+        static constexpr const char* modes[]{
+            "", "TEX_HEADER_DIMENSION", "TEX_HEADER_TEXTURE_TYPE", "", "", "TEX_HEADER_SAMPLER_POS",
+        };
+        const uint64_t value = take(dis, 22, 3);
+        if (value >= std::size(modes) || *modes[value] == '\0') {
+            return false;
+        }
+        print_word(dis, modes[value]);
+        return true;
+    }
+}
+
+} // namespace decode
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "context.h"
+#include "dedup.h"
+#include "dksh.h"
+#include "flow.h"
+#include "opcode.h"
+#include "table.h"
+
+// Shared tails are reached with a branch, they have to be longer than it to save space
+constexpr size_t MIN_TAIL_SIZE = 2;
+
+struct code_location
+{
+    size_t program;
+    size_t instruction;
+};
+
+static bool is_reference(const packed_program& program, size_t index)
+{
+    return std::ranges::any_of(program.references, [index](const shared_code_reference& ref) {
+        return ref.instruction == index;
+    });
+}
+
+// Instruction encoding with its label made relative to an origin instruction, so copies of
+// position independent code compare equal wherever they are
+static std::optional<uint64_t> relative_encoding(const packed_program& program, size_t index,
+                                                 size_t origin)
+{
+    const opcode& op = program.opcodes[index];
+    if (!has_label(op)) {
+        return op.value;
+    }
+    const std::optional target = branch_target(program.opcodes, index);
+    if (!target || is_reference(program, index)) {
+        return {};
+    }
+    const uint64_t distance =
+        static_cast<uint64_t>(static_cast<int64_t>(*target) - static_cast<int64_t>(origin));
+    return (op.value & ~(0xFFFFFFULL << 20)) | (distance & 0xFFFFFF) << 20;
+}
+
+static bool is_same(const packed_program& a, size_t a_index, size_t a_origin,
+                    const packed_program& b, size_t b_index, size_t b_origin)
+{
+    const opcode& a_op = a.opcodes[a_index];
+    const opcode& b_op = b.opcodes[b_index];
+    if (a_op.sched.raw != b_op.sched.raw || a_op.reuse != b_op.reuse) {
+        return false;
+    }
+    const std::optional a_value = relative_encoding(a, a_index, a_origin);
+    return a_value && a_value == relative_encoding(b, b_index, b_origin);
+}
+
+// Label operands inside [begin, end) don't leave it and none outside land past its first
+// instruction
+static bool is_self_contained(const packed_program& program, size_t begin, size_t end)
+{
+    for (size_t index = 0; index < program.opcodes.size(); ++index) {
+        if (!has_label(program.opcodes[index])) {
+            continue;
+        }
+        const bool is_inside = index >= begin && index < end;
+        if (is_reference(program, index)) {
+            if (is_inside) {
+                return false;
+            }
+            continue;
+        }
+        const std::optional target = branch_target(program.opcodes, index);
+        if (is_inside && (!target || *target < begin || *target >= end)) {
+            return false;
+        }
+        if (!is_inside && target && *target > begin && *target < end) {
+            return false;
+        }
+    }
+    // Entrypoints can't be moved to another program
+    const std::optional entry = program.ctx->entrypoint_address();
+    const std::optional entry_index = entry ? instruction_index(*entry) : std::nullopt;
+    return !entry_index || *entry_index < begin || *entry_index >= end;
+}
+
+// Reuse flags keep operands for the next instruction, that changes when code is shared
+static bool has_reuse_before(const packed_program& program, size_t index)
+{
+    return index > 0 && program.opcodes[index - 1].reuse != 0;
+}
+
+// Function starting at an instruction, assumed to run until its first RET
+static std::optional<size_t> function_end(const packed_program& program, size_t entry)
+{
+    for (size_t index = entry; index < program.opcodes.size(); ++index) {
+        const opcode& op = program.opcodes[index];
+        if (std::string_view{op.info->mnemonic} == "RET") {
+            return is_unconditional(op) ? std::optional(index + 1) : std::nullopt;
+        }
+    }
+    return {};
+}
+
+static bool is_only_called(const packed_program& program, size_t entry)
+{
+    for (size_t index = 0; index < program.opcodes.size(); ++index) {
+        const opcode& op = program.opcodes[index];
+        if (has_label(op) && !is_reference(program, index) &&
+            std::string_view{op.info->mnemonic} != "CAL" &&
+            branch_target(program.opcodes, index) == entry) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<uint64_t> function_key(const packed_program& program, size_t begin, size_t end)
+{
+    std::vector<uint64_t> key;
+    for (size_t index = begin; index < end; ++index) {
+        const opcode& op = program.opcodes[index];
+        key.push_back(*relative_encoding(program, index, begin));
+        key.push_back(op.sched.raw | static_cast<uint64_t>(op.reuse) << 32);
+    }
+    return key;
+}
+
+static void remove_instructions(packed_program& program, std::span<const char> removed)
+{
+    std::vector<size_t> new_indices(program.opcodes.size() + 1);
+    size_t kept = 0;
+    for (size_t index = 0; index < program.opcodes.size(); ++index) {
+        new_indices[index] = kept;
+        kept += removed[index] ? 0 : 1;
+    }
+    new_indices[program.opcodes.size()] = kept;
+
+    std::vector<opcode> opcodes;
+    opcodes.reserve(kept);
+    for (size_t index = 0; index < program.opcodes.size(); ++index) {
+        if (removed[index]) {
+            continue;
+        }
+        opcode op = program.opcodes[index];
+        if (has_label(op) && !is_reference(program, index)) {
+            if (const std::optional target = branch_target(program.opcodes, index)) {
+                op.value = set_label_target(op.value, instruction_address(opcodes.size()),
+                                            instruction_address(new_indices[*target]));
+            }
+        }
+        opcodes.push_back(op);
+    }
+    for (shared_code_reference& ref : program.references) {
+        ref.instruction = new_indices[ref.instruction];
+    }
+    program.ctx->relocate_labels(new_indices);
+    program.removed_instructions += program.opcodes.size() - kept;
+    program.opcodes = std::move(opcodes);
+}
+
+// Calls functions already present in previous programs and drops the local copy
+static void share_functions(std::span<packed_program> programs, size_t current,
+                            std::map<std::vector<uint64_t>, code_location>& functions)
+{
+    packed_program& program = programs[current];
+    const std::vector<std::vector<size_t>> successors = control_flow(program.opcodes);
+    std::vector<char> removed(program.opcodes.size());
+    bool has_removed = false;
+    for (size_t site = 0; site < program.opcodes.size(); ++site) {
+        if (std::string_view{program.opcodes[site].info->mnemonic} != "CAL" ||
+            is_reference(program, site)) {
+            continue;
+        }
+        const std::optional entry = branch_target(program.opcodes, site);
+        const std::optional end = entry ? function_end(program, *entry) : std::nullopt;
+        if (!end || removed[*entry] || !is_self_contained(program, *entry, *end) ||
+            has_reuse_before(program, *entry)) {
+            continue;
+        }
+        // The copy can only be dropped when CAL is the only way in
+        if (*entry == 0 || std::ranges::count(successors[*entry - 1], *entry) != 0 ||
+            std::string_view{program.opcodes[*entry - 1].info->mnemonic} == "CAL" ||
+            !is_only_called(program, *entry)) {
+            continue;
+        }
+        const auto it = functions.find(function_key(program, *entry, *end));
+        if (it == functions.end()) {
+            continue;
+        }
+        for (size_t caller = 0; caller < program.opcodes.size(); ++caller) {
+            if (std::string_view{program.opcodes[caller].info->mnemonic} == "CAL" &&
+                branch_target(program.opcodes, caller) == entry) {
+                program.references.push_back({caller, it->second.program,
+                                              it->second.instruction});
+            }
+        }
+        std::fill(removed.begin() + *entry, removed.begin() + *end, 1);
+        has_removed = true;
+    }
+    if (has_removed) {
+        remove_instructions(program, removed);
+    }
+}
+
+// Branches to the longest identical tail of a previous program
+static void share_tail(std::span<packed_program> programs, size_t current)
+{
+    packed_program& program = programs[current];
+    const size_t size = program.opcodes.size();
+    std::optional<code_location> best;
+    size_t best_length = 0;
+    for (size_t other = 0; other < current; ++other) {
+        const packed_program& previous = programs[other];
+        const size_t other_size = previous.opcodes.size();
+        size_t length = 0;
+        while (length < std::min(size, other_size) &&
+               is_same(program, size - length - 1, size, previous, other_size - length - 1,
+                       other_size)) {
+            ++length;
+        }
+        // Shrink the tail until it can be entered from a branch
+        while (length >= MIN_TAIL_SIZE &&
+               (!is_self_contained(program, size - length, size) ||
+                !is_self_contained(previous, other_size - length, other_size) ||
+                has_reuse_before(program, size - length) ||
+                has_reuse_before(previous, other_size - length))) {
+            --length;
+        }
+        if (length >= MIN_TAIL_SIZE && length > best_length) {
+            best = code_location{other, other_size - length};
+            best_length = length;
+        }
+    }
+    if (!best) {
+        return;
+    }
+    const auto bra = std::ranges::find_if(table, [](const insn& insn) {
+        return std::string_view{insn.mnemonic} == "BRA" && (insn.opcode & 0x1F) == 15;
+    });
+    const size_t start = size - best_length;
+    opcode& op = program.opcodes[start];
+    const opcode tail = op;
+    op = opcode{};
+    op.value = bra->opcode | static_cast<uint64_t>(TRUE_PREDICATE) << 16;
+    op.sched.raw = 0x7E0;
+    op.info = &*bra;
+
+    // The branch stands for the tail in the line table
+    op.line = tail.line;
+    op.column = tail.column;
+    program.references.push_back({start, best->program, best->instruction});
+
+    std::vector<char> removed(size);
+    std::fill(removed.begin() + start + 1, removed.end(), 1);
+    remove_instructions(program, removed);
+}
+
+void deduplicate(std::span<packed_program> programs)
+{
+    std::map<std::vector<uint64_t>, code_location> functions;
+    for (size_t current = 0; current < programs.size(); ++current) {
+        if (current > 0) {
+            share_functions(programs, current, functions);
+            share_tail(programs, current);
+        }
+        // Make the functions left in this program available to the next ones
+        const packed_program& program = programs[current];
+        for (size_t site = 0; site < program.opcodes.size(); ++site) {
+            if (std::string_view{program.opcodes[site].info->mnemonic} != "CAL" ||
+                is_reference(program, site)) {
+                continue;
+            }
+            const std::optional entry = branch_target(program.opcodes, site);
+            const std::optional end = entry ? function_end(program, *entry) : std::nullopt;
+            if (end && is_self_contained(program, *entry, *end) &&
+                !has_reuse_before(program, *entry)) {
+                functions.try_emplace(function_key(program, *entry, *end),
+                                      code_location{current, *entry});
+            }
+        }
+    }
+}
+
+void link_shared_code(std::span<const packed_program> programs,
+                      std::span<dksh_program> dksh_programs)
+{
+    const std::vector<size_t> offsets = dksh_code_offsets(dksh_programs);
+    const auto address = [&](size_t program, size_t instruction) {
+        return static_cast<int64_t>(offsets[program] + dksh_programs[program].header_size) +
+               instruction_address(instruction);
+    };
+    for (size_t index = 0; index < programs.size(); ++index) {
+        std::vector<uint64_t>& code = dksh_programs[index].code;
+        for (const shared_code_reference& ref : programs[index].references) {
+            uint64_t& value = code[(dksh_programs[index].header_size +
+                                    static_cast<size_t>(instruction_address(ref.instruction))) /
+                                   sizeof(uint64_t)];
+            value = set_label_target(value, address(index, ref.instruction),
+                                     address(ref.program, ref.target));
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "opcode.h"
+
+class context;
+struct dksh_program;
+
+// Label operand resolved to the code of another program once programs are laid out
+struct shared_code_reference
+{
+    size_t instruction;
+    size_t program;
+    size_t target;
+};
+
+// Instructions of a program packed in a container with others
+struct packed_program
+{
+    context* ctx;
+    std::vector<opcode> opcodes;
+    std::vector<shared_code_reference> references;
+    size_t removed_instructions = 0;
+};
+
+// Replaces functions reached through CAL and program tails identical to code of a previous
+// program with references to that code
+void deduplicate(std::span<packed_program> programs);
+
+// Encodes the label operands referencing other programs now that their code is placed
+void link_shared_code(std::span<const packed_program> programs,
+                      std::span<dksh_program> dksh_programs);
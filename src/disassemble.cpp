@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "decode.h"
+#include "disassemble.h"
+#include "nxas.h"
+#include "opcode.h"
+#include "table.h"
+
+namespace decode
+{
+
+#undef INSN
+#define INSN(opcode, flags, mnemonic, ...)                                                         \
+    std::vector<decoder>                                                                           \
+    {                                                                                              \
+        __VA_ARGS__                                                                                \
+    }
+
+// Decoders of each entry of the instruction table, in the same order
+static const std::vector<decoder> operands[]{
+#include "table.inc"
+};
+
+} // namespace decode
+
+static_assert(std::size(decode::operands) == std::size(table));
+
+constexpr uint64_t PREDICATE_MASK = 0xFULL << 16;
+
+// Entries are bucketed by the bits of the opcode they fix in the top of the instruction
+constexpr int BUCKET_SHIFT = 52;
+constexpr size_t NUM_BUCKETS = size_t{1} << (64 - BUCKET_SHIFT);
+
+struct entry
+{
+    const insn* info = nullptr;
+    const std::vector<decode::decoder>* decoders = nullptr;
+
+    // Bits owned by operands, the rest have to match the opcode
+    uint64_t fields = 0;
+    uint64_t fixed = 0;
+
+    // Operands that run in the unpack pass
+    std::vector<size_t> unpackers{};
+
+    bool has_label = false;
+};
+
+struct decode_table
+{
+    std::vector<entry> entries;
+    std::array<std::vector<uint16_t>, NUM_BUCKETS> buckets;
+};
+
+static entry probe_entry(const insn& info, const std::vector<decode::decoder>& decoders)
+{
+    entry result{.info = &info, .decoders = &decoders};
+    disassembly dis;
+    dis.pass = decode_pass::probe;
+    dis.built = info.opcode;
+    for (size_t index = 0; index < decoders.size(); ++index) {
+        dis.needs_unpack = false;
+        decoders[index](dis);
+        if (dis.needs_unpack) {
+            result.unpackers.push_back(index);
+        }
+    }
+    result.fields = dis.fields;
+    result.has_label =
+        std::ranges::find(decoders, decode::decoder{decode::label}) != decoders.end();
+    // Predicates are decoded apart from the operands unless an operand owns them
+    result.fixed = ~dis.fields & (dis.fields & PREDICATE_MASK ? ~0ULL : ~PREDICATE_MASK);
+    return result;
+}
+
+static decode_table build_decode_table()
+{
+    decode_table result;
+    for (size_t index = 0; index < std::size(table); ++index) {
+        result.entries.push_back(probe_entry(table[index], decode::operands[index]));
+
+        // Add the entry to every bucket its fixed bits match
+        const uint64_t fixed = result.entries.back().fixed >> BUCKET_SHIFT;
+        const uint64_t bits = (table[index].opcode >> BUCKET_SHIFT) & fixed;
+        const uint64_t free = ~fixed & (NUM_BUCKETS - 1);
+        uint64_t subset = 0;
+        do {
+            result.buckets[bits | subset].push_back(static_cast<uint16_t>(index));
+            subset = (subset - free) & free;
+        } while (subset != 0);
+    }
+    return result;
+}
+
+static const decode_table& get_decode_table()
+{
+    static const decode_table result = build_decode_table();
+    return result;
+}
+
+// Prints an instruction with an entry, the text is left untouched when the entry doesn't fit
+static bool decode_instruction(const entry& entry, disassembly& dis, uint64_t word)
+{
+    if ((word ^ entry.info->opcode) & entry.fixed) {
+        return false;
+    }
+    dis.value = word & entry.fields;
+    dis.built = word & ~entry.fields;
+    dis.fields = 0;
+    dis.after_number = false;
+    dis.has_operand = false;
+
+    const size_t start = dis.text.size();
+    const uint32_t reuse = dis.reuse;
+    const auto reject = [&] {
+        dis.text.resize(start);
+        dis.reuse = reuse;
+        return false;
+    };
+    if (!entry.unpackers.empty()) {
+        dis.pass = decode_pass::unpack;
+        for (const size_t index : entry.unpackers) {
+            if (!(*entry.decoders)[index](dis)) {
+                return reject();
+            }
+        }
+    }
+    dis.pass = decode_pass::print;
+
+    dis.text += "    ";
+    if (!(entry.fields & PREDICATE_MASK)) {
+        const uint64_t predicate = (word >> 16) & 0xF;
+        if ((entry.info->flags & NO_PRED) && (predicate & 7) != TRUE_PREDICATE) {
+            return reject();
+        }
+        if (predicate != TRUE_PREDICATE) {
+            dis.text += '@';
+            decode::print_predicate(dis, predicate & 7, (predicate & 8) != 0);
+            dis.text += ' ';
+            dis.has_operand = false;
+        }
+    }
+    dis.text += entry.info->mnemonic;
+
+    for (const decode::decoder decoder : *entry.decoders) {
+        if (!decoder(dis)) {
+            return reject();
+        }
+    }
+    // Bits no operand printed would be lost when the text is assembled again
+    if (dis.value != 0) {
+        return reject();
+    }
+    return true;
+}
+
+uint64_t operand_fields(size_t entry)
+{
+    return get_decode_table().entries[entry].fields;
+}
+
+bool has_label_operand(size_t entry)
+{
+    return get_decode_table().entries[entry].has_label;
+}
+
+bool disassemble_instruction(size_t entry, uint64_t word, std::string& text)
+{
+    disassembly dis;
+    dis.text = std::move(text);
+    const bool is_decoded = decode_instruction(get_decode_table().entries[entry], dis, word);
+    text = std::move(dis.text);
+    return is_decoded;
+}
+
+static void print_directive(std::string& text, std::string_view name, uint32_t value)
+{
+    char buffer[8];
+    text += name;
+    text.append(buffer, std::to_chars(buffer, std::end(buffer), value).ptr);
+}
+
+static void print_sched(std::string& text, uint32_t sched)
+{
+    const uint32_t stall = sched & 0xF;
+    const uint32_t yield = (sched >> 4) & 1;
+    const uint32_t write_barrier = (sched >> 5) & 7;
+    const uint32_t read_barrier = (sched >> 8) & 7;
+    const uint32_t wait_barrier = (sched >> 11) & 0x3F;
+    if (stall != 0) {
+        print_directive(text, " @WAIT ", stall);
+    }
+    if (write_barrier != 7) {
+        print_directive(text, " @WB ", write_barrier);
+    }
+    if (read_barrier != 7) {
+        print_directive(text, " @RB ", read_barrier);
+    }
+    if (yield) {
+        text += " @Y";
+    }
+    for (uint32_t barrier = 0; barrier < 6; ++barrier) {
+        if (wait_barrier & (1U << barrier)) {
+            print_directive(text, " @DEP ", barrier);
+        }
+    }
+}
+
+namespace nxas {
+
+std::string disassemble(std::span<const uint64_t> code)
+{
+    const decode_table& decode_table = get_decode_table();
+
+    const size_t remainder = code.size() % 4;
+    const size_t num_instructions = code.size() / 4 * 3 + (remainder != 0 ? remainder - 1 : 0);
+    std::vector<bool> labels(num_instructions);
+    std::vector<size_t> lines;
+    lines.reserve(num_instructions + 1);
+
+    disassembly dis;
+    dis.labels = &labels;
+    dis.text.reserve(num_instructions * 40);
+    for (size_t index = 0; index < num_instructions; ++index) {
+        const size_t word_index = index / 3 * 4 + index % 3 + 1;
+        const uint64_t word = code[word_index];
+        const uint64_t sched_word = code[word_index & ~size_t{3}];
+        const uint32_t sched = static_cast<uint32_t>(sched_word >> (index % 3 * 21)) & 0x1FFFFF;
+        lines.push_back(dis.text.size());
+
+        dis.address = instruction_address(index);
+        dis.reuse = sched >> 17;
+        [[maybe_unused]] bool is_decoded = false;
+        for (const uint16_t entry : decode_table.buckets[word >> BUCKET_SHIFT]) {
+            if (decode_instruction(decode_table.entries[entry], dis, word)) {
+                is_decoded = true;
+                break;
+            }
+        }
+        assert(is_decoded && "RAW decodes every word");
+        print_sched(dis.text, sched & 0x1FFFF);
+        dis.text += ";\n";
+    }
+    lines.push_back(dis.text.size());
+
+    // Labels are known once every instruction is decoded, insert them before their targets
+    std::string result;
+    result.reserve(dis.text.size() + num_instructions);
+    for (size_t index = 0; index < num_instructions; ++index) {
+        if (labels[index]) {
+            char buffer[24] = "L_";
+            char* const end =
+                std::to_chars(buffer + 2, std::end(buffer), instruction_address(index), 16).ptr;
+            result.append(buffer, end);
+            result += ":\n";
+        }
+        result.append(dis.text, lines[index], lines[index + 1] - lines[index]);
+    }
+    return result;
+}
+
+} // namespace nxas
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Entries are indices in the instruction table
+
+// Bits of an instruction owned by the operands of an entry, the opcode of the entry fixes the rest
+uint64_t operand_fields(size_t entry);
+
+bool has_label_operand(size_t entry);
+
+// Appends an indented instruction decoded with an entry, without its scheduling or semicolon.
+// Returns false and leaves the text untouched when the entry doesn't decode the word.
+bool disassemble_instruction(size_t entry, uint64_t word, std::string& text);
@@ -1,72 +1,17 @@
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
 
 #include "context.h"
+#include "dksh.h"
 #include "error.h"
-
-constexpr uint32_t DKSH_MAGIC = 0x48534B44;
-
-struct dksh_header
-{
-    uint32_t magic;
-    uint32_t header_sz;
-    uint32_t control_sz;
-    uint32_t code_sz;
-    uint32_t programs_off;
-    uint32_t num_programs;
-};
-
-struct dksh_program_header
-{
-    uint32_t type;
-    uint32_t entrypoint;
-    uint32_t num_gprs;
-    uint32_t constbuf1_off;
-    uint32_t constbuf1_sz;
-    uint32_t per_warp_scratch_sz;
-    union
-    {
-        struct
-        {
-            uint32_t alt_entrypoint;
-            uint32_t alt_num_gprs;
-        } vert;
-        struct
-        {
-            bool has_table_3d1;
-            bool early_fragment_tests;
-            bool post_depth_coverage;
-            bool persample_invocation;
-            uint32_t table_3d1[4];
-            uint32_t param_d8;
-            uint16_t param_65b;
-            uint16_t param_489;
-        } frag;
-        struct
-        {
-            bool flag_47c;
-            bool has_table_490;
-            bool _padding[2];
-            uint32_t table_490[8];
-        } geom;
-        struct
-        {
-            uint32_t param_c8;
-        } tess_eval;
-        struct
-        {
-            std::array<uint32_t, 3> block_dims;
-            uint32_t shared_mem_sz;
-            uint32_t local_pos_mem_sz;
-            uint32_t local_neg_mem_sz;
-            uint32_t crs_sz;
-            uint32_t num_barriers;
-        } comp;
-    };
-    uint32_t reserved;
-};
+#include "resources.h"
 
 static constexpr size_t align256(size_t value)
 {
@@ -78,14 +23,77 @@ static constexpr size_t align8(size_t value)
     return (value + 0xf) & ~0xf;
 }
 
-void context::write_dksh(size_t code_size, std::vector<uint64_t>& output) const
+// Use the tight size when it's known, warning when it disagrees with the declared one
+static int tight_size(const char* directive, const char* unit, std::optional<int> declared,
+                      std::optional<int> used, int fallback)
+{
+    if (!used) {
+        return declared.value_or(fallback);
+    }
+    if (declared && *declared > *used) {
+        warning("%s %d is larger than the %d %s used", directive, *declared, *used, unit);
+    } else if (declared && *declared < *used) {
+        warning("%s %d is smaller than the %d %s used", directive, *declared, *used, unit);
+    }
+    return *used;
+}
+
+nxas::program_resources context::resolve_resources(const resource_usage& usage) const
+{
+    const bool is_compute = type == program_type::compute;
+
+    nxas::program_resources result;
+    result.num_gprs = tight_size(".num_gprs", "registers", num_gprs, usage.num_gprs, 0);
+    result.local_mem_size = static_cast<int>(
+        align8(tight_size(".local_memory", "bytes", local_mem_size, usage.local_mem_size, 0)));
+    if (!usage.local_mem_size && !local_mem_size) {
+        warning("local memory is addressed with registers and .local_memory is not declared");
+    }
+    if (is_compute) {
+        result.shared_mem_size = static_cast<int>(align256(
+            tight_size(".shared_memory", "bytes", shared_mem_size, usage.shared_mem_size, 0)));
+        if (!usage.shared_mem_size && !shared_mem_size) {
+            warning("shared memory is addressed with registers and .shared_memory is not declared");
+        }
+        result.block_dimensions = block_dimensions;
+    }
+    result.crs_size = usage.crs_size.value_or(0x800);
+    result.per_warp_scratch_size = result.local_mem_size * 32 + result.crs_size;
+    result.num_barriers = std::max(num_barriers, usage.num_barriers);
+    result.is_compute = is_compute;
+    return result;
+}
+
+std::optional<int64_t> context::entrypoint_address() const
+{
+    return find_label(entrypoint.value_or("main"));
+}
+
+dksh_program context::dksh(std::span<const uint64_t> code, const resource_usage& usage) const
+{
+    if (!is_dksh) {
+        fatal_error("%s: program is not a DKSH", filename);
+    }
+    const nxas::program_resources resources = resolve_resources(usage);
+    std::vector<uint64_t> result = program_code(code, usage, resources);
+    const size_t header_size = (result.size() - code.size()) * sizeof(uint64_t);
+    return dksh_program{
+        .ctx = this,
+        .resources = resources,
+        .code = std::move(result),
+        .header_size = header_size,
+    };
+}
+
+dksh_program_header context::dksh_header(size_t code_offset,
+                                         const nxas::program_resources& resources) const
 {
     if (!type) {
         fatal_error(
             "no type provided, "
             "valid are types: vertex, tess_control, tess_eval, geometry, fragment, compute");
     }
-    const std::optional entrypoint_code_offset = find_label(entrypoint.value_or("main"));
+    const std::optional entrypoint_code_offset = entrypoint_address();
     if (!entrypoint_code_offset) {
         fatal_error("entrypoint \"%s\" not found", entrypoint.value_or("main").c_str());
     }
@@ -93,18 +101,21 @@ void context::write_dksh(size_t code_size, std::vector<uint64_t>& output) const
         fatal_error("entrypoint is not aligned");
     }
 
-    const int local_pos_sz = align8(local_mem_size);
-    const int local_neg_sz = 0;
-    const int crs_sz = 0x800;
-
     dksh_program_header program_header;
     std::memset(&program_header, 0, sizeof(program_header));
     program_header.type = static_cast<uint32_t>(*type);
-    program_header.entrypoint = *entrypoint_code_offset - 8;
-    program_header.num_gprs = num_gprs;
+    program_header.entrypoint = static_cast<uint32_t>(code_offset + *entrypoint_code_offset - 8);
+    if (*type != program_type::compute) {
+        // Graphics programs are entered through the header that precedes their code
+        if (*entrypoint_code_offset != 8) {
+            fatal_error("graphics entrypoint is not the first instruction");
+        }
+        program_header.entrypoint = static_cast<uint32_t>(code_offset + GFX_HEADER_OFFSET);
+    }
+    program_header.num_gprs = resources.num_gprs;
     program_header.constbuf1_off = 0; // TODO
     program_header.constbuf1_sz = 0;
-    program_header.per_warp_scratch_sz = (local_pos_sz + local_neg_sz) * 32 + crs_sz;
+    program_header.per_warp_scratch_sz = resources.per_warp_scratch_size;
     switch (*type) {
     case program_type::vertex:
         if (second_entrypoint || second_num_gprs) {
@@ -117,28 +128,85 @@ void context::write_dksh(size_t code_size, std::vector<uint64_t>& output) const
         program_header.frag.persample_invocation = persample_invocation;
         break;
     case program_type::compute:
-        program_header.comp.block_dims = block_dimensions;
-        program_header.comp.shared_mem_sz = align256(shared_mem_size);
-        program_header.comp.local_pos_mem_sz = local_pos_sz;
-        program_header.comp.local_neg_mem_sz = local_neg_sz;
-        program_header.comp.crs_sz = crs_sz;
-        program_header.comp.num_barriers = num_barriers;
+        program_header.comp.block_dims = resources.block_dimensions;
+        program_header.comp.shared_mem_sz = resources.shared_mem_size;
+        program_header.comp.local_pos_mem_sz = resources.local_mem_size;
+        program_header.comp.local_neg_mem_sz = 0;
+        program_header.comp.crs_sz = resources.crs_size;
+        program_header.comp.num_barriers = resources.num_barriers;
         break;
     default:
         break;
     }
-    static constexpr size_t dksh_size = sizeof(dksh_header) + sizeof(dksh_program_header);
+    return program_header;
+}
+
+std::vector<size_t> dksh_code_offsets(std::span<const dksh_program> programs)
+{
+    // Every program starts aligned inside the shared code section
+    std::vector<size_t> code_offsets;
+    size_t code_size = 0;
+    for (const dksh_program& program : programs) {
+        code_offsets.push_back(code_size);
+        code_size += align256(program.code.size() * sizeof(uint64_t));
+    }
+    return code_offsets;
+}
+
+// Bytes taken by the header and program headers before the shared code section
+static size_t control_size(std::span<const dksh_program> programs)
+{
+    return align256(sizeof(dksh_header) + programs.size() * sizeof(dksh_program_header));
+}
+
+static size_t code_section_size(std::span<const dksh_program> programs,
+                                std::span<const size_t> code_offsets)
+{
+    if (programs.empty()) {
+        return 0;
+    }
+    return code_offsets.back() + align256(programs.back().code.size() * sizeof(uint64_t));
+}
+
+size_t dksh_words(std::span<const dksh_program> programs)
+{
+    const std::vector<size_t> code_offsets = dksh_code_offsets(programs);
+    const size_t size = control_size(programs) + code_section_size(programs, code_offsets);
+    return size / sizeof(uint64_t);
+}
+
+void write_dksh(std::span<const dksh_program> programs, std::span<uint64_t> output)
+{
+    const std::vector<size_t> code_offsets = dksh_code_offsets(programs);
     dksh_header header;
     header.magic = DKSH_MAGIC;
     header.header_sz = sizeof(dksh_header);
-    header.control_sz = align256(dksh_size);
-    header.code_sz = align256(code_size * sizeof(uint64_t));
+    header.control_sz = static_cast<uint32_t>(control_size(programs));
+    header.code_sz = static_cast<uint32_t>(code_section_size(programs, code_offsets));
     header.programs_off = sizeof(dksh_header);
-    header.num_programs = 1;
+    header.num_programs = static_cast<uint32_t>(programs.size());
+
+    // Only padding is zeroed, the storage may be uninitialized and code overwrites the rest
+    std::ranges::fill(output.first(header.control_sz / sizeof(uint64_t)), 0);
+    char* const output_bytes = reinterpret_cast<char*>(output.data());
+    std::memcpy(output_bytes, &header, sizeof(header));
+    for (size_t index = 0; index < programs.size(); ++index) {
+        const dksh_program& program = programs[index];
+        const dksh_program_header program_header =
+            program.ctx->dksh_header(code_offsets[index], program.resources);
+        std::memcpy(output_bytes + sizeof(header) + index * sizeof(program_header),
+                    &program_header, sizeof(program_header));
+        const std::span program_output =
+            output.subspan((header.control_sz + code_offsets[index]) / sizeof(uint64_t),
+                           align256(program.code.size() * sizeof(uint64_t)) / sizeof(uint64_t));
+        const auto code_end = std::ranges::copy(program.code, program_output.begin()).out;
+        std::fill(code_end, program_output.end(), 0);
+    }
+}
 
-    std::array<uint64_t, align256(dksh_size) / sizeof(uint64_t)> result{};
-    char* const result_bytes = reinterpret_cast<char*>(result.data());
-    std::memcpy(result_bytes, &header, sizeof(header));
-    std::memcpy(result_bytes + sizeof(header), &program_header, sizeof(program_header));
-    output.insert(output.end(), result.begin(), result.end());
+std::vector<uint64_t> write_dksh(std::span<const dksh_program> programs)
+{
+    std::vector<uint64_t> result(dksh_words(programs));
+    write_dksh(programs, result);
+    return result;
 }
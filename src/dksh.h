@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "nxas.h"
+
+class context;
+
+// Graphics programs start with padding and their shader program header, the header ends where the
+// code starts to keep scheduling bundles aligned
+constexpr size_t GFX_HEADER_OFFSET = 0x30;
+constexpr size_t GFX_HEADER_SIZE = 0x80;
+
+constexpr uint32_t DKSH_MAGIC = 0x48534B44;
+
+struct dksh_header
+{
+    uint32_t magic;
+    uint32_t header_sz;
+    uint32_t control_sz;
+    uint32_t code_sz;
+    uint32_t programs_off;
+    uint32_t num_programs;
+};
+
+struct dksh_program_header
+{
+    uint32_t type;
+    uint32_t entrypoint;
+    uint32_t num_gprs;
+    uint32_t constbuf1_off;
+    uint32_t constbuf1_sz;
+    uint32_t per_warp_scratch_sz;
+    union
+    {
+        struct
+        {
+            uint32_t alt_entrypoint;
+            uint32_t alt_num_gprs;
+        } vert;
+        struct
+        {
+            bool has_table_3d1;
+            bool early_fragment_tests;
+            bool post_depth_coverage;
+            bool persample_invocation;
+            uint32_t table_3d1[4];
+            uint32_t param_d8;
+            uint16_t param_65b;
+            uint16_t param_489;
+        } frag;
+        struct
+        {
+            bool flag_47c;
+            bool has_table_490;
+            bool _padding[2];
+            uint32_t table_490[8];
+        } geom;
+        struct
+        {
+            uint32_t param_c8;
+        } tess_eval;
+        struct
+        {
+            std::array<uint32_t, 3> block_dims;
+            uint32_t shared_mem_sz;
+            uint32_t local_pos_mem_sz;
+            uint32_t local_neg_mem_sz;
+            uint32_t crs_sz;
+            uint32_t num_barriers;
+        } comp;
+    };
+    uint32_t reserved;
+};
+
+// Program packed in a DKSH container
+struct dksh_program
+{
+    const context* ctx;
+    nxas::program_resources resources;
+
+    // Code of the program, including its graphics header
+    std::vector<uint64_t> code;
+
+    // Bytes taken by the graphics header before the first scheduling bundle
+    size_t header_size = 0;
+};
+
+// Byte offset of each program inside the shared code section
+std::vector<size_t> dksh_code_offsets(std::span<const dksh_program> programs);
+
+// Words of the DKSH container packing the programs
+size_t dksh_words(std::span<const dksh_program> programs);
+
+// Writes a DKSH container placing the code of every program in a single shared code section, the
+// output is sized by dksh_words
+void write_dksh(std::span<const dksh_program> programs, std::span<uint64_t> output);
+std::vector<uint64_t> write_dksh(std::span<const dksh_program> programs);
@@ -0,0 +1,137 @@
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "embed.h"
+#include "output.h"
+
+constexpr size_t WORDS_PER_LINE = 4;
+
+// Hexadecimal literals are always written with all their digits to keep lines aligned
+constexpr size_t HEX_WORD_SIZE = 18;
+
+// Text around the words of the image, the size of the output is computed from it before writing
+struct embed_syntax
+{
+    std::string prologue;
+    std::string_view line_prefix;
+    std::string_view separator;
+    std::string_view line_end;
+    std::string epilogue;
+};
+
+static embed_syntax syntax(std::string_view name, embed_format format, size_t num_words)
+{
+    const std::string symbol{name};
+    switch (format) {
+    case embed_format::header:
+        // The size is spelled out so code using the symbol compiles the same for empty images
+        return {
+            .prologue = "// Generated by nxas, do not edit\n"
+                        "#pragma once\n"
+                        "\n"
+                        "#include <array>\n"
+                        "#include <cstdint>\n"
+                        "\n"
+                        "inline constexpr std::array<std::uint64_t, " +
+                        std::to_string(num_words) + "> " + symbol + "{{\n",
+            .line_prefix = "    ",
+            .separator = ", ",
+            .line_end = ",\n",
+            .epilogue = "}};\n",
+        };
+    case embed_format::assembly:
+        return {
+            .prologue = "/* Generated by nxas, do not edit */\n"
+                        "    .section .rodata\n"
+                        "    .balign 8\n"
+                        "    .globl " +
+                        symbol + "\n    .type " + symbol + ", %object\n" + symbol + ":\n",
+            .line_prefix = "    .quad ",
+            .separator = ", ",
+            .line_end = "\n",
+            .epilogue = "    .size " + symbol + ", . - " + symbol +
+                        "\n    .section .note.GNU-stack, \"\", %progbits\n",
+        };
+    }
+    return {};
+}
+
+static char* append(char* output, std::string_view text)
+{
+    std::memcpy(output, text.data(), text.size());
+    return output + text.size();
+}
+
+static char* append_hex(char* output, uint64_t value)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    output[0] = '0';
+    output[1] = 'x';
+    for (int digit = 0; digit < 16; ++digit) {
+        output[2 + digit] = digits[(value >> (60 - digit * 4)) & 0xF];
+    }
+    return output + HEX_WORD_SIZE;
+}
+
+std::string embed_symbol_name(std::string_view filename)
+{
+    const size_t slash = filename.find_last_of("/\\");
+    if (slash != std::string_view::npos) {
+        filename.remove_prefix(slash + 1);
+    }
+    filename = filename.substr(0, filename.find('.'));
+
+    std::string name;
+    if (filename.empty() || std::isdigit(static_cast<unsigned char>(filename[0]))) {
+        name += '_';
+    }
+    for (const char character : filename) {
+        name += std::isalnum(static_cast<unsigned char>(character)) ? character : '_';
+    }
+    return name;
+}
+
+bool is_valid_symbol_name(std::string_view name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    for (const char character : name) {
+        if (!std::isalnum(static_cast<unsigned char>(character)) && character != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_embedded(const char* filename, std::span<const uint64_t> image, std::string_view name,
+                    embed_format format)
+{
+    const size_t num_words = image.size();
+    const embed_syntax text = syntax(name, format, num_words);
+    const size_t num_lines = (num_words + WORDS_PER_LINE - 1) / WORDS_PER_LINE;
+    const size_t size = text.prologue.size() + text.epilogue.size() +
+                        num_lines * (text.line_prefix.size() + text.line_end.size()) +
+                        num_words * HEX_WORD_SIZE +
+                        (num_words - num_lines) * text.separator.size();
+
+    output_file file(filename, size);
+    char* output = reinterpret_cast<char*>(file.data().data());
+    output = append(output, text.prologue);
+    for (size_t index = 0; index < num_words; ++index) {
+        const size_t column = index % WORDS_PER_LINE;
+        if (column == 0) {
+            output = append(output, text.line_prefix);
+        }
+        output = append_hex(output, image[index]);
+        const bool is_line_end = column == WORDS_PER_LINE - 1 || index + 1 == num_words;
+        output = append(output, is_line_end ? text.line_end : text.separator);
+    }
+    append(output, text.epilogue);
+    file.commit();
+}
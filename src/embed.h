@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+enum class embed_format
+{
+    // C++ header defining a constexpr std::array
+    header,
+
+    // GNU assembler source defining a global symbol in read only data
+    assembly,
+};
+
+// Name of the symbol defined for an output file, its name without directories or extension
+std::string embed_symbol_name(std::string_view filename);
+
+bool is_valid_symbol_name(std::string_view name);
+
+// Writes an assembled image as source code defining a symbol with its contents
+void write_embedded(const char* filename, std::span<const uint64_t> image, std::string_view name,
+                    embed_format format);
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Writes the functions of nxas::builder adding the instructions of each mnemonic of the table,
+// nxas.h includes them in the builder. It's built before the library and only reads the table.
+
+struct entry_spelling
+{
+    const char* mnemonic;
+    const char* operands;
+};
+
+#define INSN(opcode, flags, mnemonic, ...) entry_spelling{mnemonic, #__VA_ARGS__}
+static const entry_spelling entries[]{
+#include "table.inc"
+};
+#undef INSN
+
+// Splits operands spelled like "sgpr<8>, comma, abs<46, sgpr<8>>" at the commas outside brackets
+static std::vector<std::string_view> split_operands(std::string_view spelling)
+{
+    std::vector<std::string_view> operands;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t index = 0; index <= spelling.size(); ++index) {
+        if (index == spelling.size() || (spelling[index] == ',' && depth == 0)) {
+            std::string_view operand = spelling.substr(start, index - start);
+            operand.remove_prefix(std::min(operand.find_first_not_of(' '), operand.size()));
+            operand = operand.substr(0, operand.find_last_not_of(' ') + 1);
+            if (!operand.empty()) {
+                operands.push_back(operand);
+            }
+            start = index + 1;
+        } else if (spelling[index] == '<') {
+            ++depth;
+        } else if (spelling[index] == '>') {
+            --depth;
+        }
+    }
+    return operands;
+}
+
+// Operands read by entries without commas. Modifiers can't be told from operands by their
+// spelling, these are the ones that read an operand after the mnemonic and its modifiers.
+struct uncomma_operand
+{
+    std::string_view name;
+    int min_operands;
+    int max_operands;
+};
+
+static const uncomma_operand uncomma_operands[]{
+    {"dgpr", 1, 1},
+    {"uinteger", 1, 1},
+    {"label", 1, 1},
+    {"cc_text", 1, 1},
+    {"nop::mask", 1, 1},
+    // CC and its test are optional, like in EXIT CC.EQ
+    {"flow_tests", 0, 1},
+    // Both words of a raw instruction are read by the same operand
+    {"raw", 2, 2},
+};
+
+// Numbers of operands an entry takes, written between the commas of its text
+static std::pair<int, int> count_operands(std::string_view spelling)
+{
+    const std::vector<std::string_view> operands = split_operands(spelling);
+    const int commas = static_cast<int>(std::ranges::count(operands, "comma"));
+    if (commas > 0) {
+        return {commas + 1, commas + 1};
+    }
+    std::pair<int, int> result{0, 0};
+    for (const std::string_view operand : operands) {
+        const std::string_view name = operand.substr(0, operand.find('<'));
+        for (const uncomma_operand& known : uncomma_operands) {
+            if (known.name == name) {
+                result = {known.min_operands, known.max_operands};
+            }
+        }
+    }
+    return result;
+}
+
+static std::string lowercase(std::string_view text)
+{
+    std::string result;
+    for (const char character : text) {
+        result += static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+    }
+    return result;
+}
+
+static void write_function(std::FILE* file, std::string_view mnemonic, int num_operands,
+                           const std::vector<size_t>& indices)
+{
+    std::string parameters;
+    std::string pointers;
+    for (int index = 0; index < num_operands; ++index) {
+        const char name = static_cast<char>('a' + index);
+        parameters += std::string{"const operand& "} + name + ", ";
+        pointers += std::string{index > 0 ? ", " : ""} + '&' + name;
+    }
+    std::string list;
+    for (const size_t index : indices) {
+        list += (list.empty() ? "" : ", ") + std::to_string(index);
+    }
+    std::fprintf(file, "void %s(%sstd::initializer_list<std::string_view> modifiers = {})\n{\n",
+                 lowercase(mnemonic).c_str(), parameters.c_str());
+    std::fprintf(file, "    static constexpr uint16_t entries[]{%s};\n", list.c_str());
+    if (num_operands > 0) {
+        std::fprintf(file, "    const operand* const operands[]{%s};\n", pointers.c_str());
+        std::fprintf(file, "    add_entries(entries, modifiers, operands);\n}\n\n");
+    } else {
+        std::fprintf(file, "    add_entries(entries, modifiers, {});\n}\n\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <output file>\n", argv[0]);
+        return 1;
+    }
+    // Entries of each mnemonic by the number of operands they take, in table order
+    std::map<std::string_view, std::map<int, std::vector<size_t>>> functions;
+    for (size_t index = 0; index < std::size(entries); ++index) {
+        const auto [min_operands, max_operands] = count_operands(entries[index].operands);
+        for (int num_operands = min_operands; num_operands <= max_operands; ++num_operands) {
+            functions[entries[index].mnemonic][num_operands].push_back(index);
+        }
+    }
+
+    std::FILE* const file = std::fopen(argv[1], "w");
+    if (!file) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    std::fprintf(file, "// Generated by nxas-emitters from table.inc, don't edit\n\n");
+    for (const auto& [mnemonic, overloads] : functions) {
+        for (const auto& [num_operands, indices] : overloads) {
+            write_function(file, mnemonic, num_operands, indices);
+        }
+    }
+    if (std::fclose(file) != 0) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    return 0;
+}
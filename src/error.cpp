@@ -1,69 +1,144 @@
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
-#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "error.h"
+#include "memory_usage.h"
+#include "nxas.h"
 #include "token.h"
 
+static thread_local bool is_quiet = false;
+
+quiet_errors::quiet_errors() : was_quiet{is_quiet}
+{
+    is_quiet = true;
+}
+
+quiet_errors::~quiet_errors()
+{
+    is_quiet = was_quiet;
+}
+
+// Errors at a position are printed as "file:line:column: error: message", lines and columns
+// start at one
+[[noreturn]] static void raise_at(const char* filename, int line, int column,
+                                  const std::string& message)
+{
+    const std::string location = "\33[1m" + std::string{filename} + ":\33[1m" +
+                                 std::to_string(line) + ':' + std::to_string(column) + ": ";
+    throw nxas::assembly_error(location + "\33[1;31merror:\33[0m " + message, filename, line,
+                               column, strip_colors(message));
+}
+
 void error::raise()
 {
-    std::fputs(message.get(), stderr);
-    std::fputc('\n', stderr);
-    std::exit(EXIT_FAILURE);
+    assert(message);
+    raise_at(filename, line, column, message.get());
 }
 
 error fail(const token& token, const char* fmt, ...)
 {
-    static const char errfmt[] = "\33[1m%s:\33[1m%d:%d: \33[1;31merror:\33[0m ";
-
-    const int line = token.line + 1;
-    const int column = token.column + 1;
+    error error;
+    error.is_failure = true;
+    if (is_quiet) {
+        return error;
+    }
+    error.filename = token.filename;
+    error.line = token.line + 1;
+    error.column = token.column + 1;
 
-    const int first_length = std::snprintf(NULL, 0, errfmt, token.filename, line, column);
     std::va_list ap;
     va_start(ap, fmt);
-    const int second_length = std::vsnprintf(NULL, 0, fmt, ap);
+    const int length = std::vsnprintf(NULL, 0, fmt, ap) + 1;
     va_end(ap);
 
-    const int length = first_length + second_length + 1;
-    error error;
-    error.message = std::make_unique<char[]>(length);
+    {
+        ACCOUNT_MEMORY(diagnostics);
+        error.message = std::make_unique<char[]>(length);
+    }
 
-    std::snprintf(error.message.get(), length, errfmt, token.filename, line, column);
     va_start(ap, fmt);
-    std::vsnprintf(error.message.get() + first_length, length - first_length, fmt, ap);
+    std::vsnprintf(error.message.get(), length, fmt, ap);
     va_end(ap);
 
     return error;
 }
 
-// TODO: deduplicate this code
+static std::string format(const char* fmt, std::va_list ap)
+{
+    std::va_list copy;
+    va_copy(copy, ap);
+    const int length = std::vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+
+    std::string result(length, '\0');
+    std::vsnprintf(result.data(), length + 1, fmt, ap);
+    return result;
+}
 
 void fatal_error(const token& token, const char* fmt, ...)
 {
-    std::fprintf(stderr, "\33[1m%s:\33[1m%d:%d: ", token.filename, token.line + 1,
-                 token.column + 1);
-    std::fprintf(stderr, "\33[1;31merror:\33[0m ");
-
     std::va_list ap;
     va_start(ap, fmt);
-    std::vfprintf(stderr, fmt, ap);
+    const std::string message = format(fmt, ap);
     va_end(ap);
-    std::fputc('\n', stderr);
 
-    std::exit(EXIT_FAILURE);
+    raise_at(token.filename, token.line + 1, token.column + 1, message);
 }
 
 void fatal_error(const char* fmt, ...)
 {
-    std::fprintf(stderr, "\33[1;31merror:\33[0m ");
+    std::va_list ap;
+    va_start(ap, fmt);
+    const std::string message = format(fmt, ap);
+    va_end(ap);
+
+    throw nxas::assembly_error("\33[1;31merror:\33[0m " + message, {}, 0, 0,
+                               strip_colors(message));
+}
+
+std::string strip_colors(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (size_t index = 0; index < text.size(); ++index) {
+        if (text[index] == '\33' && index + 1 < text.size() && text[index + 1] == '[') {
+            const size_t end = text.find('m', index);
+            if (end == std::string_view::npos) {
+                break;
+            }
+            index = end;
+            continue;
+        }
+        result += text[index];
+    }
+    return result;
+}
+
+static thread_local std::vector<std::string>* warning_sink = nullptr;
+
+void set_warning_sink(std::vector<std::string>* sink)
+{
+    warning_sink = sink;
+}
+
+void warning(const char* fmt, ...)
+{
+    if (warning_sink) {
+        std::va_list ap;
+        va_start(ap, fmt);
+        warning_sink->push_back(format(fmt, ap));
+        va_end(ap);
+        return;
+    }
+    std::fprintf(stderr, "\33[1;35mwarning:\33[0m ");
 
     std::va_list ap;
     va_start(ap, fmt);
     std::vfprintf(stderr, fmt, ap);
     va_end(ap);
     std::fputc('\n', stderr);
-
-    std::exit(EXIT_FAILURE);
 }
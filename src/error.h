@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #define CHECK(result)                                                                              \
     do {                                                                                           \
@@ -19,13 +22,32 @@ class error
     error() = default;
     operator bool() const
     {
-        return static_cast<bool>(message);
+        return is_failure;
     }
 
     [[noreturn]] void raise();
 
   private:
     std::unique_ptr<char[]> message;
+    const char* filename = nullptr;
+    int line = 0;
+    int column = 0;
+    bool is_failure = false;
+};
+
+// Errors of the calling thread carry no message while it's alive, for failures that are expected
+// and only reported when nothing else succeeds
+class quiet_errors
+{
+  public:
+    quiet_errors();
+    ~quiet_errors();
+
+    quiet_errors(const quiet_errors&) = delete;
+    quiet_errors& operator=(const quiet_errors&) = delete;
+
+  private:
+    bool was_quiet;
 };
 
 error fail(const token& token, const char* fmt, ...);
@@ -33,3 +55,11 @@ error fail(const token& token, const char* fmt, ...);
 [[noreturn]] void fatal_error(const token& token, const char* fmt, ...);
 
 [[noreturn]] void fatal_error(const char* fmt, ...);
+
+void warning(const char* fmt, ...);
+
+// Text without the escape sequences that color it in terminals
+std::string strip_colors(std::string_view text);
+
+// Collects the warnings of the calling thread instead of printing them, null prints them again
+void set_warning_sink(std::vector<std::string>* sink);
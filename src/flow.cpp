@@ -0,0 +1,100 @@
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "flow.h"
+#include "opcode.h"
+#include "table.h"
+
+static bool has_flow_tests(std::string_view mnemonic)
+{
+    for (const char* name : {"BRA", "SYNC", "CONT", "BRK", "KIL", "RET", "LONGJMP", "EXIT"}) {
+        if (mnemonic == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool is_unconditional(const opcode& op)
+{
+    if (((op.value >> 16) & 0xF) != TRUE_PREDICATE) {
+        return false;
+    }
+    return !has_flow_tests(op.info->mnemonic) || (op.value & 0x1F) == 15;
+}
+
+bool has_label(const opcode& op)
+{
+    for (const char* name : {"BRA", "SSY", "PBK", "CAL", "PCNT"}) {
+        if (std::string_view{op.info->mnemonic} == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<size_t> branch_target(std::span<const opcode> opcodes, size_t index)
+{
+    const int64_t address = instruction_address(index);
+    const std::optional target = instruction_index(label_target(opcodes[index].value, address));
+    if (!target || *target >= opcodes.size()) {
+        return {};
+    }
+    return target;
+}
+
+std::vector<std::vector<size_t>> control_flow(std::span<const opcode> opcodes)
+{
+    // Gather where SYNC, BRK, CONT and RET can land
+    std::vector<size_t> sync_targets;
+    std::vector<size_t> break_targets;
+    std::vector<size_t> continue_targets;
+    std::vector<size_t> return_targets;
+    for (size_t index = 0; index < opcodes.size(); ++index) {
+        const std::string_view mnemonic = opcodes[index].info->mnemonic;
+        const std::optional target = branch_target(opcodes, index);
+        if (mnemonic == "SSY" && target) {
+            sync_targets.push_back(*target);
+        } else if (mnemonic == "PBK" && target) {
+            break_targets.push_back(*target);
+        } else if (mnemonic == "PCNT" && target) {
+            continue_targets.push_back(*target);
+        } else if (mnemonic == "CAL" && index + 1 < opcodes.size()) {
+            return_targets.push_back(index + 1);
+        }
+    }
+
+    std::vector<std::vector<size_t>> result(opcodes.size());
+    for (size_t index = 0; index < opcodes.size(); ++index) {
+        const opcode& op = opcodes[index];
+        const std::string_view mnemonic = op.info->mnemonic;
+        std::vector<size_t>& successors = result[index];
+
+        bool falls_through = !is_unconditional(op);
+        if (mnemonic == "BRA" || mnemonic == "CAL") {
+            if (const std::optional target = branch_target(opcodes, index)) {
+                successors.push_back(*target);
+            } else {
+                // Branches outside of the program can't be followed
+                falls_through = true;
+            }
+        } else if (mnemonic == "SYNC") {
+            successors = sync_targets;
+        } else if (mnemonic == "BRK") {
+            successors = break_targets;
+        } else if (mnemonic == "CONT") {
+            successors = continue_targets;
+        } else if (mnemonic == "RET") {
+            successors = return_targets;
+        } else if (mnemonic != "EXIT" && mnemonic != "LONGJMP") {
+            falls_through = true;
+        }
+        if (falls_through && index + 1 < opcodes.size()) {
+            successors.push_back(index + 1);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct opcode;
+
+// True when the instruction always executes, it's not guarded by a predicate or a CC test
+bool is_unconditional(const opcode& op);
+
+// True when the instruction has a label operand
+bool has_label(const opcode& op);
+
+// Instruction targeted by the label operand of a flow control instruction
+std::optional<size_t> branch_target(std::span<const opcode> opcodes, size_t index);
+
+// Instructions that can execute right after each instruction
+std::vector<std::vector<size_t>> control_flow(std::span<const opcode> opcodes);
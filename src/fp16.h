@@ -22,6 +22,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <limits>
 
 template <std::float_round_style Rounding = std::round_to_nearest>
@@ -70,3 +71,29 @@ uint16_t fp32_to_fp16(float value)
     }
     return hbits;
 }
+
+inline float fp16_to_fp32(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exp = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+    uint32_t bits;
+    if (exp == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exp != 0) {
+        bits = sign | ((exp + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Normalize subnormals
+        exp = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exp;
+        }
+        bits = sign | (exp << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
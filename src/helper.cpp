@@ -8,13 +8,20 @@
 #include "fp16.h"
 #include "helper.h"
 #include "operand.h"
+#include "regalloc.h"
 #include "token.h"
 
-static error assemble_gpr(context& ctx, token& token, opcode& op, int address)
+static error assemble_gpr(context& ctx, token& token, opcode& op, int address, bool is_dest)
 {
+    if (token.type == token_type::virtual_register) {
+        add_virtual_gpr(ctx, token, op, address, is_dest);
+        token = ctx.tokenize();
+        return try_reuse(ctx, token, op, address);
+    }
     CHECK(confirm_type(token, token_type::regster));
 
     op.add_bits(static_cast<uint64_t>(token.data.regster) << address);
+    op.add_gpr(address, is_dest);
 
     token = ctx.tokenize();
     return try_reuse(ctx, token, op, address);
@@ -88,6 +95,34 @@ std::optional<uint64_t> find_in_table(const token& token, const char* const* tab
     return {};
 }
 
+void add_virtual_gpr(context& ctx, const token& token, opcode& op, int address, bool is_dest)
+{
+    // Leave R0 encoded until the register is allocated
+    const std::optional instruction = instruction_index(ctx.pc);
+    assert(instruction && ctx.virtual_gprs);
+    ctx.virtual_gprs->push_back(virtual_gpr{
+        .source = token,
+        .instruction = *instruction,
+        .address = address,
+        .is_dest = is_dest,
+    });
+    op.add_gpr(address, is_dest);
+}
+
+const virtual_gpr* find_virtual_gpr(const context& ctx, int address)
+{
+    const std::optional instruction = instruction_index(ctx.pc);
+    for (auto it = ctx.virtual_gprs->rbegin(); it != ctx.virtual_gprs->rend(); ++it) {
+        if (it->instruction != instruction) {
+            break;
+        }
+        if (it->address == address) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
 error try_reuse(context& ctx, token& token, opcode& op, int address)
 {
     if (!equal(token, ".reuse")) {
@@ -113,12 +148,12 @@ error try_reuse(context& ctx, token& token, opcode& op, int address)
 
 error assemble_dest_gpr(context& ctx, token& token, opcode& op, int address)
 {
-    return assemble_gpr(ctx, token, op, address);
+    return assemble_gpr(ctx, token, op, address, true);
 }
 
 error assemble_source_gpr(context& ctx, token& token, opcode& op, int address)
 {
-    return assemble_gpr(ctx, token, op, address);
+    return assemble_gpr(ctx, token, op, address, false);
 }
 
 error assemble_signed_20bit_immediate(context& ctx, token& token, opcode& op)
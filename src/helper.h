@@ -11,6 +11,7 @@
 
 class context;
 struct opcode;
+struct virtual_gpr;
 
 #define DEFINE_INSTRUCTION(name) error parse_##name(context& ctx, opcode& op)
 
@@ -28,6 +29,10 @@ error convert_integer(const token& token, int64_t min, int64_t max, uint64_t* re
 std::optional<uint64_t> find_in_table(const token& token, const char* const* table,
                                       std::string_view prefix);
 
+void add_virtual_gpr(context& ctx, const token& token, opcode& op, int address, bool is_dest);
+
+const virtual_gpr* find_virtual_gpr(const context& ctx, int address);
+
 error try_reuse(context& ctx, token& token, opcode& op, int address);
 
 error assemble_dest_gpr(context& ctx, token& token, opcode& op, int address);
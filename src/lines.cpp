@@ -0,0 +1,207 @@
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "error.h"
+#include "nxas.h"
+
+// Layout of a line table:
+//
+//   u32 magic, u8 version, uleb128 number of sequences
+//   per sequence: null terminated file name, then opcodes until END_SEQUENCE
+//
+// Each sequence starts at address 0, line 1 and column 1. Addresses advance in units of 8 bytes,
+// the size of an instruction slot. Special opcodes advance the address and the line at once and
+// emit a row, like the special opcodes of DWARF line programs.
+constexpr uint32_t LINE_TABLE_MAGIC = 0x544C584E; // NXLT
+constexpr uint8_t LINE_TABLE_VERSION = 1;
+
+// Ends the sequence
+constexpr uint8_t END_SEQUENCE = 0;
+
+// Emits a row, followed by the address advance as uleb128 and the line advance as sleb128
+constexpr uint8_t ADVANCE_ROW = 1;
+
+// Sets the column of the next rows, followed by the column as uleb128
+constexpr uint8_t SET_COLUMN = 2;
+
+constexpr int OPCODE_BASE = 3;
+constexpr int LINE_BASE = -3;
+constexpr int LINE_RANGE = 12;
+
+constexpr uint32_t ADDRESS_UNIT = 8;
+
+static void write_uleb(std::vector<uint8_t>& output, uint64_t value)
+{
+    do {
+        const uint8_t byte = value & 0x7F;
+        value >>= 7;
+        output.push_back(byte | (value != 0 ? 0x80 : 0));
+    } while (value != 0);
+}
+
+static void write_sleb(std::vector<uint8_t>& output, int64_t value)
+{
+    bool more = true;
+    while (more) {
+        const uint8_t byte = value & 0x7F;
+        value >>= 7;
+        more = !((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40)));
+        output.push_back(byte | (more ? 0x80 : 0));
+    }
+}
+
+class line_table_reader
+{
+  public:
+    explicit line_table_reader(std::span<const uint8_t> data_) : data{data_}
+    {
+    }
+
+    uint8_t u8()
+    {
+        if (offset == data.size()) {
+            fatal_error("line table is truncated");
+        }
+        return data[offset++];
+    }
+
+    uint64_t uleb()
+    {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            const uint8_t byte = u8();
+            if (shift < 64) {
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            }
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    int64_t sleb()
+    {
+        int64_t value = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = u8();
+            if (shift < 64) {
+                value |= static_cast<int64_t>(byte & 0x7F) << shift;
+            }
+            shift += 7;
+        } while (byte & 0x80);
+        if (shift < 64 && (byte & 0x40)) {
+            value |= -(int64_t{1} << shift);
+        }
+        return value;
+    }
+
+    std::string string()
+    {
+        std::string value;
+        while (const char character = static_cast<char>(u8())) {
+            value += character;
+        }
+        return value;
+    }
+
+  private:
+    std::span<const uint8_t> data;
+    size_t offset = 0;
+};
+
+namespace nxas {
+
+std::vector<uint8_t> encode_line_table(std::span<const line_sequence> sequences)
+{
+    std::vector<uint8_t> output;
+    for (int shift = 0; shift < 32; shift += 8) {
+        output.push_back(static_cast<uint8_t>(LINE_TABLE_MAGIC >> shift));
+    }
+    output.push_back(LINE_TABLE_VERSION);
+    write_uleb(output, sequences.size());
+
+    for (const line_sequence& sequence : sequences) {
+        output.insert(output.end(), sequence.filename.begin(), sequence.filename.end());
+        output.push_back(0);
+
+        uint32_t address = 0;
+        int line = 1;
+        int column = 1;
+        for (const source_position& position : sequence.positions) {
+            if (position.address < address || position.address % ADDRESS_UNIT != 0) {
+                fatal_error("line table positions are not sorted instruction addresses");
+            }
+            if (position.column != column) {
+                output.push_back(SET_COLUMN);
+                write_uleb(output, static_cast<uint64_t>(position.column));
+                column = position.column;
+            }
+            const uint32_t address_advance = (position.address - address) / ADDRESS_UNIT;
+            const int line_advance = position.line - line;
+            const int64_t special = OPCODE_BASE + (line_advance - LINE_BASE) +
+                                    static_cast<int64_t>(address_advance) * LINE_RANGE;
+            if (line_advance >= LINE_BASE && line_advance < LINE_BASE + LINE_RANGE &&
+                special <= 0xFF) {
+                output.push_back(static_cast<uint8_t>(special));
+            } else {
+                output.push_back(ADVANCE_ROW);
+                write_uleb(output, address_advance);
+                write_sleb(output, line_advance);
+            }
+            address = position.address;
+            line = position.line;
+        }
+        output.push_back(END_SEQUENCE);
+    }
+    return output;
+}
+
+std::vector<line_sequence> decode_line_table(std::span<const uint8_t> data)
+{
+    line_table_reader reader(data);
+    uint32_t magic = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        magic |= static_cast<uint32_t>(reader.u8()) << shift;
+    }
+    if (magic != LINE_TABLE_MAGIC) {
+        fatal_error("not a line table");
+    }
+    if (const uint8_t version = reader.u8(); version != LINE_TABLE_VERSION) {
+        fatal_error("unsupported line table version %u", version);
+    }
+    const uint64_t num_sequences = reader.uleb();
+    if (num_sequences > data.size()) {
+        fatal_error("line table is truncated");
+    }
+    std::vector<line_sequence> sequences(num_sequences);
+    for (line_sequence& sequence : sequences) {
+        sequence.filename = reader.string();
+
+        uint32_t address = 0;
+        int line = 1;
+        int column = 1;
+        while (const uint8_t opcode = reader.u8()) {
+            if (opcode == SET_COLUMN) {
+                column = static_cast<int>(reader.uleb());
+                continue;
+            }
+            if (opcode == ADVANCE_ROW) {
+                address += static_cast<uint32_t>(reader.uleb()) * ADDRESS_UNIT;
+                line += static_cast<int>(reader.sleb());
+            } else {
+                const int adjusted = opcode - OPCODE_BASE;
+                address += static_cast<uint32_t>(adjusted / LINE_RANGE) * ADDRESS_UNIT;
+                line += LINE_BASE + adjusted % LINE_RANGE;
+            }
+            sequence.positions.push_back({.address = address, .line = line, .column = column});
+        }
+    }
+    return sequences;
+}
+
+} // namespace nxas
@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "error.h"
+#include "nxas.h"
+#include "output.h"
+
+static std::vector<uint8_t> read_file(const char* filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        fatal_error("%s: failed to open", filename);
+    }
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+}
+
+static int run(int argc, char** argv)
+{
+    std::vector<nxas::object_file> objects;
+    const char* output_file = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        // Parse output file
+        if (std::strcmp(argv[i], "-o") == 0) {
+            if (output_file) {
+                fatal_error("command line output file already provided");
+            }
+            if (++i == argc) {
+                fatal_error("expected command line syntax: \"-o\" <output file>");
+            }
+            output_file = argv[i];
+            continue;
+        }
+        // There's no modifier, it's an object
+        objects.push_back({.data = read_file(argv[i]), .filename = argv[i]});
+    }
+    if (objects.empty()) {
+        fatal_error("no input objects");
+    }
+    if (!output_file) {
+        fatal_error("no output file");
+    }
+    const std::vector<uint64_t> binary = nxas::link(objects);
+    write_output(output_file, binary.data(), binary.size() * sizeof(uint64_t));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    try {
+        return run(argc, argv);
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <atomic>
+
+#include "memory_usage.h"
+
+// Identifiers are unique across threads so blocks freed by another thread are never taken for
+// blocks of its accounting
+static std::atomic<uint64_t> next_accounting_id{1};
+
+static thread_local memory_accounting* current_accounting = nullptr;
+static thread_local memory_kind current_kind = memory_kind::other;
+
+memory_accounting::memory_accounting(nxas::memory_statistics* statistics)
+    : statistics{statistics},
+      id{statistics ? next_accounting_id.fetch_add(1, std::memory_order_relaxed) : 0}
+{
+    if (statistics) {
+        *statistics = {};
+    }
+}
+
+active_accounting::active_accounting(memory_accounting& accounting) : parent{current_accounting}
+{
+    current_accounting = accounting.statistics ? &accounting : nullptr;
+}
+
+active_accounting::~active_accounting()
+{
+    current_accounting = parent;
+}
+
+memory_attribution::memory_attribution(memory_kind kind) : parent{current_kind}
+{
+    current_kind = kind;
+}
+
+memory_attribution::~memory_attribution()
+{
+    current_kind = parent;
+}
+
+static nxas::memory_usage& kind_usage(nxas::memory_statistics& statistics, memory_kind kind)
+{
+    switch (kind) {
+    case memory_kind::labels:
+        return statistics.labels;
+    case memory_kind::opcodes:
+        return statistics.opcodes;
+    case memory_kind::output:
+        return statistics.output;
+    case memory_kind::diagnostics:
+        return statistics.diagnostics;
+    case memory_kind::other:
+        break;
+    }
+    return statistics.other;
+}
+
+// Neither function may allocate, they run inside operator new and delete
+uint64_t account_allocation(size_t bytes)
+{
+    memory_accounting* const accounting = current_accounting;
+    if (!accounting) {
+        return 0;
+    }
+    nxas::memory_statistics& statistics = *accounting->statistics;
+    nxas::memory_usage& usage = kind_usage(statistics, current_kind);
+    ++usage.allocations;
+    usage.bytes += bytes;
+    accounting->live_bytes += bytes;
+    statistics.peak_bytes = std::max(statistics.peak_bytes, accounting->live_bytes);
+    return accounting->id;
+}
+
+void account_deallocation(uint64_t owner, size_t bytes)
+{
+    memory_accounting* const accounting = current_accounting;
+    if (owner != 0 && accounting && accounting->id == owner) {
+        accounting->live_bytes -= bytes;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "nxas.h"
+
+// What an allocation is attributed to, allocations outside of every attribution are other
+enum class memory_kind
+{
+    labels,
+    opcodes,
+    output,
+    diagnostics,
+    other,
+};
+
+// Counts the allocations made on a thread while it's active into the statistics of a report, an
+// accounting without statistics counts nothing. Blocks belong to the accounting that allocated
+// them, freeing them lowers its live bytes only while it's active.
+class memory_accounting
+{
+  public:
+    explicit memory_accounting(nxas::memory_statistics* statistics);
+
+    memory_accounting(const memory_accounting&) = delete;
+    memory_accounting& operator=(const memory_accounting&) = delete;
+
+  private:
+    friend class active_accounting;
+    friend uint64_t account_allocation(size_t bytes);
+    friend void account_deallocation(uint64_t owner, size_t bytes);
+
+    nxas::memory_statistics* statistics;
+    uint64_t id;
+    size_t live_bytes = 0;
+};
+
+// Makes an accounting the one of the current thread until the scope ends, programs assembled
+// together resume their accounting for each of their phases
+class active_accounting
+{
+  public:
+    explicit active_accounting(memory_accounting& accounting);
+    ~active_accounting();
+
+    active_accounting(const active_accounting&) = delete;
+    active_accounting& operator=(const active_accounting&) = delete;
+
+  private:
+    memory_accounting* parent;
+};
+
+class memory_attribution
+{
+  public:
+    explicit memory_attribution(memory_kind kind);
+    ~memory_attribution();
+
+    memory_attribution(const memory_attribution&) = delete;
+    memory_attribution& operator=(const memory_attribution&) = delete;
+
+  private:
+    memory_kind parent;
+};
+
+#define ACCOUNT_MEMORY(kind) const memory_attribution scoped_memory_attribution(memory_kind::kind)
+
+// Called by the replaced global operator new and delete. The owner of a block is zero when no
+// accounting was active while allocating it.
+uint64_t account_allocation(size_t bytes);
+void account_deallocation(uint64_t owner, size_t bytes);
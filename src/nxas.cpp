@@ -1,52 +1,50 @@
 #include <algorithm>
+#include <cassert>
+#include <deque>
 #include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "assemble.h"
 #include "context.h"
+#include "dedup.h"
+#include "dksh.h"
 #include "error.h"
+#include "memory_usage.h"
+#include "object.h"
 #include "opcode.h"
 #include "parse.h"
+#include "peephole.h"
+#include "regalloc.h"
+#include "resources.h"
+#include "table.h"
+#include "time_report.h"
 #include "token.h"
+#include "trace.h"
+#include "yield.h"
 
-namespace nxas {
-
-static uint64_t generate_sched(std::span<const opcode> opcodes, size_t index,
-                               size_t num_instructions, size_t address)
+static uint64_t generate_sched(std::span<const opcode> opcodes, size_t index, size_t address)
 {
-    if (index + address >= num_instructions) {
+    if (index + address >= opcodes.size()) {
         return 0x7E0ULL << (address * 21);
     }
     const opcode& op = opcodes[index + address];
     return (op.sched.raw | (static_cast<uint64_t>(op.reuse) << 17)) << (address * 21);
 }
 
-std::vector<uint64_t> assemble(const std::string& code, const char* filename)
+std::vector<uint64_t> bundle(std::span<const opcode> opcodes)
 {
-    // Prepare our context
-    context ctx(filename, code.c_str());
-
-    // To determine the number of instructions to allocate we count the number of semicolons this
-    // is possible because every instruction ends with a semicolon on the number of decoding
-    // instructions we allocate one extra because one instruction might be bugged and it won't have
-    // a semicolon (which will trigger a fatal)
-    const size_t max_decode_instructions = std::ranges::count(code, ';') + 1;
-    std::vector<opcode> opcodes(max_decode_instructions);
-
-    size_t index = 0;
-    while (parse_instruction(ctx, opcodes[index++])) {
-    }
-    assert(index == max_decode_instructions);
-    const size_t num_instructions = index - 1;
-
+    TIME_PHASE(bundle);
+    ACCOUNT_MEMORY(output);
     std::vector<uint64_t> blob;
-    blob.reserve(max_decode_instructions * 4 / 3 + 4);
-    for (index = 0; index < num_instructions; ++index) {
+    blob.reserve(opcodes.size() * 4 / 3 + 4);
+    for (size_t index = 0; index < opcodes.size(); ++index) {
         if (index % 3 == 0) {
             uint64_t sched = 0;
             for (size_t address = 0; address < 3; ++address) {
-                sched |= generate_sched(opcodes, index, num_instructions, address);
+                sched |= generate_sched(opcodes, index, address);
             }
             blob.push_back(sched);
         }
@@ -55,7 +53,262 @@ std::vector<uint64_t> assemble(const std::string& code, const char* filename)
     while (blob.size() % 4) {
         blob.push_back(0x50B0000000070F00ULL);
     }
-    return ctx.binary(blob);
+    return blob;
+}
+
+// To determine the number of instructions to allocate we count the number of semicolons this is
+// possible because every instruction ends with a semicolon on the number of decoding instructions
+// we allocate one extra because one instruction might be bugged and it won't have a semicolon
+// (which will trigger a fatal)
+static size_t max_instructions(std::string_view code)
+{
+    return std::ranges::count(code, ';') + 1;
+}
+
+parsed_program parse_program(context& ctx, std::string_view code)
+{
+    return parse_program(ctx, max_instructions(code));
+}
+
+parsed_program parse_program(context& ctx, size_t max_decode_instructions)
+{
+    std::vector<virtual_gpr> virtual_gprs;
+    ctx.virtual_gprs = &virtual_gprs;
+
+    parsed_program program;
+    {
+        ACCOUNT_MEMORY(opcodes);
+        program.opcodes.resize(max_decode_instructions);
+        program.spans.reserve(max_decode_instructions);
+    }
+
+    size_t index = 0;
+    {
+        TIME_PHASE(parse);
+        instruction_span span{.begin = ctx.offset(), .end = 0, .line = ctx.current_line()};
+        while (parse_instruction(ctx, program.opcodes[index++])) {
+            ctx.skip_line_end();
+            span.end = ctx.offset();
+            program.spans.push_back(span);
+            span = {.begin = span.end, .end = 0, .line = ctx.current_line()};
+        }
+    }
+    assert(index == max_decode_instructions);
+    program.opcodes.resize(index - 1);
+    if (!virtual_gprs.empty()) {
+        allocate_registers(program.opcodes, virtual_gprs);
+        program.has_virtual_gprs = true;
+    }
+    ctx.virtual_gprs = nullptr;
+    return program;
+}
+
+encoded_program finish_program(context& ctx, std::vector<opcode> opcodes,
+                               const nxas::options& options, nxas::report* report)
+{
+    size_t num_instructions = opcodes.size();
+    if (options.optimize) {
+        const size_t remaining = remove_redundant_instructions(ctx, opcodes);
+        if (report) {
+            report->removed_instructions = num_instructions - remaining;
+        }
+        num_instructions = remaining;
+    }
+    if (options.yield_interval > 0) {
+        auto changes = place_yields(std::span(opcodes).first(num_instructions),
+                                    options.yield_interval);
+        if (report) {
+            report->yields = std::move(changes);
+        }
+    }
+    const resource_usage usage = analyze_resources(std::span(opcodes).first(num_instructions));
+
+    opcodes.resize(num_instructions);
+    return {std::move(opcodes), usage};
+}
+
+namespace nxas {
+
+static std::vector<source_position> source_positions(std::span<const opcode> opcodes)
+{
+    std::vector<source_position> positions;
+    positions.reserve(opcodes.size());
+    for (size_t index = 0; index < opcodes.size(); ++index) {
+        positions.push_back({
+            .address = static_cast<uint32_t>(instruction_address(index)),
+            .line = opcodes[index].line + 1,
+            .column = opcodes[index].column + 1,
+        });
+    }
+    return positions;
+}
+
+static encoded_program encode(context& ctx, size_t max_instructions, const char* filename,
+                              const options& options, report* report)
+{
+    TRACE_PHASE("encode", filename);
+    parsed_program parsed = parse_program(ctx, max_instructions);
+    return finish_program(ctx, std::move(parsed.opcodes), options, report);
 }
 
 } // namespace nxas
+
+// Bundles the instructions of a program and writes its binary with the headers of its options
+static void emit_program(context& ctx, const encoded_program& program, const char* filename,
+                         nxas::report* report, const binary_storage& storage)
+{
+    if (report) {
+        report->lines = nxas::source_positions(program.opcodes);
+    }
+    TRACE_PHASE("emit", filename);
+    const std::vector<uint64_t> bundled = bundle(program.opcodes);
+    ctx.binary(bundled, program.usage, report ? &report->resources : nullptr,
+               [&](size_t num_words) {
+                   ACCOUNT_MEMORY(output);
+                   return storage(num_words);
+               });
+}
+
+void assemble_program(context& ctx, size_t max_instructions, const char* filename,
+                      const nxas::options& options, nxas::report* report,
+                      const binary_storage& storage)
+{
+    emit_program(ctx, nxas::encode(ctx, max_instructions, filename, options, report), filename,
+                 report, storage);
+}
+
+std::vector<uint64_t> assemble_program(context& ctx, size_t max_instructions, const char* filename,
+                                       const nxas::options& options, nxas::report* report)
+{
+    std::vector<uint64_t> binary;
+    assemble_program(ctx, max_instructions, filename, options, report, [&binary](size_t num_words) {
+        binary.resize(num_words);
+        return std::span(binary);
+    });
+    return binary;
+}
+
+std::vector<uint64_t> assemble_opcodes(context& ctx, std::vector<opcode> opcodes,
+                                       const char* filename, const nxas::options& options,
+                                       nxas::report* report)
+{
+    encoded_program program;
+    {
+        TRACE_PHASE("encode", filename);
+        program = finish_program(ctx, std::move(opcodes), options, report);
+    }
+    std::vector<uint64_t> binary;
+    emit_program(ctx, program, filename, report, [&binary](size_t num_words) {
+        binary.resize(num_words);
+        return std::span(binary);
+    });
+    return binary;
+}
+
+void assemble_in_place(const std::string& code, const char* filename,
+                       const nxas::options& options, nxas::report* report,
+                       const binary_storage& storage)
+{
+    TRACE_FILE(filename);
+    memory_accounting accounting(report ? &report->memory : nullptr);
+    const active_accounting counting(accounting);
+    context ctx(filename, code.c_str());
+    assemble_program(ctx, max_instructions(code), filename, options, report, storage);
+}
+
+namespace nxas {
+
+std::vector<uint64_t> assemble(const std::string& code, const char* filename,
+                               const options& options, report* report)
+{
+    TRACE_FILE(filename);
+    memory_accounting accounting(report ? &report->memory : nullptr);
+    const active_accounting counting(accounting);
+    context ctx(filename, code.c_str());
+    return assemble_program(ctx, max_instructions(code), filename, options, report);
+}
+
+std::vector<uint8_t> assemble_object(const std::string& code, const char* filename,
+                                     const options& options)
+{
+    if (options.optimize) {
+        fatal_error("relocatable objects can't be optimized");
+    }
+    TRACE_FILE(filename);
+    context ctx(filename, code.c_str());
+    std::vector<external_label> externals;
+    ctx.external_labels = &externals;
+    encoded_program program = encode(ctx, max_instructions(code), filename, options, nullptr);
+
+    // Calls to other objects need stack entries that are only known after linking
+    for (const external_label& label : externals) {
+        if (std::string_view{program.opcodes[label.instruction].info->mnemonic} == "CAL") {
+            program.usage.crs_size.reset();
+        }
+    }
+    TRACE_PHASE("emit", filename);
+    return write_object(ctx, bundle(program.opcodes), program.usage, externals);
+}
+
+std::vector<uint64_t> assemble_dksh(std::span<const source> sources, const options& options,
+                                    std::vector<report>* reports)
+{
+    std::vector<uint64_t> binary;
+    assemble_dksh_in_place(sources, options, reports, [&binary](size_t num_words) {
+        binary.resize(num_words);
+        return std::span(binary);
+    });
+    return binary;
+}
+
+} // namespace nxas
+
+void assemble_dksh_in_place(std::span<const nxas::source> sources, const nxas::options& options,
+                            std::vector<nxas::report>* reports, const binary_storage& storage)
+{
+    if (reports) {
+        reports->assign(sources.size(), {});
+    }
+    // Each program resumes its accounting while it's encoded and while its code is emitted
+    std::deque<memory_accounting> accountings;
+    for (size_t index = 0; index < sources.size(); ++index) {
+        accountings.emplace_back(reports ? &(*reports)[index].memory : nullptr);
+    }
+    // Contexts are referenced by the programs until the container is written
+    std::deque<context> contexts;
+    std::vector<packed_program> packed;
+    std::vector<resource_usage> usages;
+    for (size_t index = 0; index < sources.size(); ++index) {
+        const nxas::source& source = sources[index];
+        nxas::report* const report = reports ? &(*reports)[index] : nullptr;
+        TRACE_FILE(source.filename.c_str());
+        const active_accounting counting(accountings[index]);
+        context& ctx = contexts.emplace_back(source.filename.c_str(), source.code.c_str());
+        encoded_program program = nxas::encode(ctx, max_instructions(source.code),
+                                               source.filename.c_str(), options, report);
+        packed.push_back({.ctx = &ctx, .opcodes = std::move(program.opcodes), .references = {}});
+        usages.push_back(program.usage);
+    }
+    if (options.deduplicate) {
+        deduplicate(packed);
+    }
+
+    std::vector<dksh_program> programs;
+    programs.reserve(packed.size());
+    for (size_t index = 0; index < packed.size(); ++index) {
+        TRACE_PHASE("emit", sources[index].filename.c_str());
+        const active_accounting counting(accountings[index]);
+        const std::vector<uint64_t> code = bundle(packed[index].opcodes);
+        {
+            ACCOUNT_MEMORY(output);
+            programs.push_back(packed[index].ctx->dksh(code, usages[index]));
+        }
+        if (reports) {
+            (*reports)[index].resources = programs.back().resources;
+            (*reports)[index].shared_instructions = packed[index].removed_instructions;
+            (*reports)[index].lines = nxas::source_positions(packed[index].opcodes);
+        }
+    }
+    link_shared_code(packed, programs);
+    write_dksh(programs, storage(dksh_words(programs)));
+}
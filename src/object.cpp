@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "context.h"
+#include "error.h"
+#include "nxas.h"
+#include "object.h"
+#include "opcode.h"
+#include "resources.h"
+
+constexpr uint32_t OBJECT_MAGIC = 0x424F584E; // NXOB
+constexpr uint32_t OBJECT_VERSION = 1;
+
+// Label defined or referenced by an object, addresses are relative to its code
+struct object_label
+{
+    std::string name;
+    uint32_t address;
+};
+
+struct parsed_object
+{
+    std::string options;
+    resource_usage usage;
+    std::vector<object_label> symbols;
+    std::vector<object_label> relocations;
+    std::vector<uint64_t> code;
+};
+
+class object_writer
+{
+  public:
+    void u32(uint32_t value)
+    {
+        append(&value, sizeof(value));
+    }
+
+    void u64(uint64_t value)
+    {
+        append(&value, sizeof(value));
+    }
+
+    void optional(std::optional<int> value)
+    {
+        u32(static_cast<uint32_t>(value.value_or(-1)));
+    }
+
+    void string(std::string_view value)
+    {
+        u32(static_cast<uint32_t>(value.size()));
+        append(value.data(), value.size());
+    }
+
+    template <size_t size>
+    void bits(const std::bitset<size>& value)
+    {
+        for (size_t word = 0; word < size / 32; ++word) {
+            uint32_t packed = 0;
+            for (size_t bit = 0; bit < 32; ++bit) {
+                packed |= value[word * 32 + bit] ? 1U << bit : 0U;
+            }
+            u32(packed);
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+
+  private:
+    void append(const void* data, size_t size)
+    {
+        const uint8_t* const begin = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    }
+};
+
+class object_reader
+{
+  public:
+    explicit object_reader(const nxas::object_file& file_) : file{file_}
+    {
+    }
+
+    uint32_t u32()
+    {
+        uint32_t value;
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    uint64_t u64()
+    {
+        uint64_t value;
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    std::optional<int> optional()
+    {
+        const int value = static_cast<int>(u32());
+        return value < 0 ? std::nullopt : std::optional(value);
+    }
+
+    std::string string()
+    {
+        std::string value(count(1), '\0');
+        read(value.data(), value.size());
+        return value;
+    }
+
+    // Number of elements of an array, checked against the bytes left before anything is allocated
+    size_t count(size_t element_size)
+    {
+        const size_t value = u32();
+        if (value > (file.data.size() - offset) / element_size) {
+            fatal_error("%s: object is truncated", file.filename.c_str());
+        }
+        return value;
+    }
+
+    template <size_t size>
+    void bits(std::bitset<size>& value)
+    {
+        for (size_t word = 0; word < size / 32; ++word) {
+            const uint32_t packed = u32();
+            for (size_t bit = 0; bit < 32; ++bit) {
+                value[word * 32 + bit] = (packed >> bit) & 1;
+            }
+        }
+    }
+
+  private:
+    void read(void* data, size_t size)
+    {
+        if (size > file.data.size() - offset) {
+            fatal_error("%s: object is truncated", file.filename.c_str());
+        }
+        std::memcpy(data, file.data.data() + offset, size);
+        offset += size;
+    }
+
+    const nxas::object_file& file;
+    size_t offset = 0;
+};
+
+static void write_usage(object_writer& writer, const resource_usage& usage)
+{
+    writer.u32(static_cast<uint32_t>(usage.num_gprs));
+    writer.optional(usage.local_mem_size);
+    writer.optional(usage.shared_mem_size);
+    writer.optional(usage.crs_size);
+    writer.u32(static_cast<uint32_t>(usage.num_barriers));
+    writer.bits(usage.inputs);
+    writer.bits(usage.outputs);
+    writer.u32(static_cast<uint32_t>(usage.patch_attributes_size));
+    writer.u32((usage.kills ? 1 : 0) | (usage.does_global_store ? 2 : 0) |
+               (usage.does_load_or_store ? 4 : 0) | (usage.does_fp64 ? 8 : 0));
+}
+
+static resource_usage read_usage(object_reader& reader)
+{
+    resource_usage usage;
+    usage.num_gprs = static_cast<int>(reader.u32());
+    usage.local_mem_size = reader.optional();
+    usage.shared_mem_size = reader.optional();
+    usage.crs_size = reader.optional();
+    usage.num_barriers = static_cast<int>(reader.u32());
+    reader.bits(usage.inputs);
+    reader.bits(usage.outputs);
+    usage.patch_attributes_size = static_cast<int>(reader.u32());
+    const uint32_t flags = reader.u32();
+    usage.kills = flags & 1;
+    usage.does_global_store = flags & 2;
+    usage.does_load_or_store = flags & 4;
+    usage.does_fp64 = flags & 8;
+    return usage;
+}
+
+std::vector<uint8_t> write_object(const context& ctx, std::span<const uint64_t> code,
+                                  const resource_usage& usage,
+                                  std::span<const external_label> externals)
+{
+    object_writer writer;
+    writer.u32(OBJECT_MAGIC);
+    writer.u32(OBJECT_VERSION);
+    writer.string(ctx.option_text());
+    write_usage(writer, usage);
+
+    writer.u32(static_cast<uint32_t>(ctx.label_addresses().size()));
+    for (const auto& [name, address] : ctx.label_addresses()) {
+        writer.string(name);
+        writer.u32(static_cast<uint32_t>(address));
+    }
+    writer.u32(static_cast<uint32_t>(externals.size()));
+    for (const external_label& label : externals) {
+        writer.string(label.name);
+        writer.u32(static_cast<uint32_t>(instruction_address(label.instruction)));
+    }
+    writer.u32(static_cast<uint32_t>(code.size()));
+    for (const uint64_t word : code) {
+        writer.u64(word);
+    }
+    return std::move(writer.bytes);
+}
+
+static parsed_object read_object(const nxas::object_file& file)
+{
+    object_reader reader(file);
+    if (reader.u32() != OBJECT_MAGIC) {
+        fatal_error("%s: not an object", file.filename.c_str());
+    }
+    if (reader.u32() != OBJECT_VERSION) {
+        fatal_error("%s: unsupported object version", file.filename.c_str());
+    }
+    parsed_object object;
+    object.options = reader.string();
+    object.usage = read_usage(reader);
+    // Labels are stored as the size of their name and their address
+    for (size_t count = reader.count(8); count > 0; --count) {
+        std::string name = reader.string();
+        object.symbols.push_back({std::move(name), reader.u32()});
+    }
+    for (size_t count = reader.count(8); count > 0; --count) {
+        std::string name = reader.string();
+        object.relocations.push_back({std::move(name), reader.u32()});
+    }
+    object.code.resize(reader.count(sizeof(uint64_t)));
+    for (uint64_t& word : object.code) {
+        word = reader.u64();
+    }
+    if (object.code.size() % 4 != 0) {
+        fatal_error("%s: code is not made of whole bundles", file.filename.c_str());
+    }
+    for (const object_label& relocation : object.relocations) {
+        const std::optional<size_t> instruction = instruction_index(relocation.address);
+        if (!instruction || instruction_address(*instruction) / 8 >= object.code.size()) {
+            fatal_error("%s: label \"%s\" is referenced outside of the code",
+                        file.filename.c_str(), relocation.name.c_str());
+        }
+    }
+    return object;
+}
+
+static std::optional<int> merge_size(std::optional<int> a, std::optional<int> b)
+{
+    if (!a || !b) {
+        return {};
+    }
+    return std::max(*a, *b);
+}
+
+static void merge_usage(resource_usage& usage, const resource_usage& other)
+{
+    usage.num_gprs = std::max(usage.num_gprs, other.num_gprs);
+    usage.local_mem_size = merge_size(usage.local_mem_size, other.local_mem_size);
+    usage.shared_mem_size = merge_size(usage.shared_mem_size, other.shared_mem_size);
+    usage.num_barriers = std::max(usage.num_barriers, other.num_barriers);
+    usage.inputs |= other.inputs;
+    usage.outputs |= other.outputs;
+    usage.patch_attributes_size = std::max(usage.patch_attributes_size,
+                                           other.patch_attributes_size);
+    usage.kills |= other.kills;
+    usage.does_global_store |= other.does_global_store;
+    usage.does_load_or_store |= other.does_load_or_store;
+    usage.does_fp64 |= other.does_fp64;
+}
+
+namespace nxas {
+
+std::vector<uint64_t> link(std::span<const object_file> objects)
+{
+    if (objects.empty()) {
+        fatal_error("no objects to link");
+    }
+    std::vector<parsed_object> parsed;
+    for (const object_file& file : objects) {
+        parsed.push_back(read_object(file));
+    }
+
+    // Objects are placed one after the other, they are made of whole bundles
+    // Every label is exported, a name defined twice is an error even when nothing references it
+    std::vector<int64_t> bases;
+    std::vector<uint64_t> code;
+    std::unordered_map<std::string_view, std::pair<int64_t, size_t>> symbols;
+    for (size_t index = 0; index < parsed.size(); ++index) {
+        const parsed_object& object = parsed[index];
+        const int64_t base = static_cast<int64_t>(code.size() * sizeof(uint64_t));
+        bases.push_back(base);
+        code.insert(code.end(), object.code.begin(), object.code.end());
+        for (const object_label& symbol : object.symbols) {
+            const auto [it, is_new] =
+                symbols.try_emplace(symbol.name, base + symbol.address, index);
+            if (!is_new) {
+                fatal_error("%s: label \"%s\" is already defined by %s",
+                            objects[index].filename.c_str(), symbol.name.c_str(),
+                            objects[it->second.second].filename.c_str());
+            }
+        }
+    }
+
+    for (size_t index = 0; index < parsed.size(); ++index) {
+        const char* const filename = objects[index].filename.c_str();
+        for (const object_label& relocation : parsed[index].relocations) {
+            const auto it = symbols.find(relocation.name);
+            if (it == symbols.end()) {
+                fatal_error("%s: undefined label \"%s\"", filename, relocation.name.c_str());
+            }
+            const int64_t target = it->second.first;
+            const int64_t address = bases[index] + relocation.address;
+            const int64_t offset = target - address - 8;
+            if (offset > static_cast<int64_t>(0x7FFFFF) || offset < -0x800000) {
+                fatal_error("%s: label \"%s\" out of range", filename, relocation.name.c_str());
+            }
+            uint64_t& value = code[static_cast<size_t>(address) / sizeof(uint64_t)];
+            value = set_label_target(value, address, target);
+        }
+    }
+
+    // The first object configures the program and provides its entrypoint
+    resource_usage usage = parsed.front().usage;
+    for (const parsed_object& object : std::span(parsed).subspan(1)) {
+        merge_usage(usage, object.usage);
+    }
+    // Calls between objects are only seen in the linked code
+    usage.crs_size = analyze_crs_size(code);
+    context ctx(objects.front().filename.c_str(), parsed.front().options.c_str());
+    ctx.parse_options();
+    for (const object_label& symbol : parsed.front().symbols) {
+        ctx.define_label(symbol.name, symbol.address);
+    }
+    return ctx.binary(code, usage, nullptr);
+}
+
+} // namespace nxas
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class context;
+struct resource_usage;
+
+// Label operand naming a label defined by another object
+struct external_label
+{
+    size_t instruction;
+    std::string name;
+};
+
+// Serializes the code of a program with its labels, the operands naming labels of other objects
+// and the options it was assembled with
+std::vector<uint8_t> write_object(const context& ctx, std::span<const uint64_t> code,
+                                  const resource_usage& usage,
+                                  std::span<const external_label> externals);
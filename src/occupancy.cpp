@@ -0,0 +1,79 @@
+#include <algorithm>
+
+#include "nxas.h"
+
+namespace nxas {
+
+// Per SM limits of the Maxwell GM20B
+constexpr int MAX_WARPS_PER_SM = 64;
+constexpr int MAX_BLOCKS_PER_SM = 32;
+constexpr int MAX_GPRS_PER_THREAD = 255;
+constexpr int REGISTER_FILE_SIZE = 65536;
+constexpr int REGISTER_ALLOCATION_UNIT = 256;
+constexpr int WARP_ALLOCATION_UNIT = 4;
+constexpr int SHARED_MEMORY_PER_SM = 64 * 1024;
+constexpr int MAX_SHARED_MEMORY_PER_BLOCK = 48 * 1024;
+constexpr int SHARED_MEMORY_ALLOCATION_UNIT = 256;
+constexpr int WARP_SIZE = 32;
+
+static int align_up(int value, int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+occupancy compute_occupancy(const program_resources& resources)
+{
+    occupancy result;
+    result.max_warps_per_sm = MAX_WARPS_PER_SM;
+
+    int threads_per_block = WARP_SIZE;
+    if (resources.is_compute) {
+        const auto& dims = resources.block_dimensions;
+        threads_per_block = static_cast<int>(dims[0] * dims[1] * dims[2]);
+    }
+    result.warps_per_block = std::max(align_up(threads_per_block, WARP_SIZE) / WARP_SIZE, 1);
+    if (result.warps_per_block > MAX_WARPS_PER_SM) {
+        result.limit = occupancy_limit::warps;
+        return result;
+    }
+
+    const auto update = [&result](int blocks, occupancy_limit limit) {
+        if (blocks < result.blocks_per_sm) {
+            result.blocks_per_sm = blocks;
+            result.limit = limit;
+        }
+    };
+    result.blocks_per_sm = MAX_WARPS_PER_SM / result.warps_per_block;
+    result.limit = occupancy_limit::warps;
+
+    // Graphics stages are modelled as blocks of one warp, their warps aren't grouped in blocks
+    // and don't count against the blocks of an SM
+    if (resources.is_compute) {
+        update(MAX_BLOCKS_PER_SM, occupancy_limit::blocks);
+    }
+
+    if (resources.num_gprs > MAX_GPRS_PER_THREAD) {
+        update(0, occupancy_limit::registers);
+    } else if (resources.num_gprs > 0) {
+        const int gprs_per_warp =
+            align_up(resources.num_gprs * WARP_SIZE, REGISTER_ALLOCATION_UNIT);
+        int warps = REGISTER_FILE_SIZE / gprs_per_warp;
+        warps -= warps % WARP_ALLOCATION_UNIT;
+        update(warps / result.warps_per_block, occupancy_limit::registers);
+    }
+
+    if (resources.shared_mem_size > MAX_SHARED_MEMORY_PER_BLOCK) {
+        update(0, occupancy_limit::shared_memory);
+    } else if (resources.shared_mem_size > 0) {
+        const int shared_per_block =
+            align_up(resources.shared_mem_size, SHARED_MEMORY_ALLOCATION_UNIT);
+        update(SHARED_MEMORY_PER_SM / shared_per_block, occupancy_limit::shared_memory);
+    }
+
+    result.warps_per_sm = result.blocks_per_sm * result.warps_per_block;
+    result.scratch_per_sm =
+        static_cast<int64_t>(result.warps_per_sm) * resources.per_warp_scratch_size;
+    return result;
+}
+
+} // namespace nxas
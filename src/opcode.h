@@ -1,7 +1,11 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
+
+struct insn;
 
 constexpr int ZERO_REGISTER = 255;
 constexpr int TRUE_PREDICATE = 7;
@@ -39,11 +43,59 @@ struct opcode
         uint32_t raw = 0;
     } sched;
 
+    // Table entry that encoded this instruction
+    const insn* info = nullptr;
+
+    // Bit offsets where register operands were encoded, used by the analysis passes
+    uint64_t gpr_fields = 0;
+    uint64_t dest_gpr_fields = 0;
+
+    // Position in the source of the first token of the instruction
+    int line = 0;
+    int column = 0;
+
     void add_bits(uint64_t bits);
 
     void add_reuse(unsigned flag);
+
+    void add_gpr(int address, bool is_dest);
 };
 
+// Byte offset of an instruction inside the code, skipping the scheduling words
+constexpr int64_t instruction_address(size_t index)
+{
+    return static_cast<int64_t>((index / 3) * 0x20 + (index % 3) * 8 + 8);
+}
+
+// Inverse of instruction_address, empty when the address points to a scheduling word
+constexpr std::optional<size_t> instruction_index(int64_t address)
+{
+    if (address < 8 || address % 0x20 == 0 || address % 8 != 0) {
+        return {};
+    }
+    return static_cast<size_t>(address / 0x20 * 3 + (address % 0x20) / 8 - 1);
+}
+
+// Absolute address referenced by a label operand of an instruction at the given address
+constexpr int64_t label_target(uint64_t value, int64_t address)
+{
+    int64_t offset = static_cast<int64_t>((value >> 20) & 0x7FFFFF);
+    if ((value >> 43) & 1) {
+        offset -= 0x800000;
+    }
+    return address + 8 + offset;
+}
+
+// Replaces the label operand of an instruction at the given address to reference a new target
+constexpr uint64_t set_label_target(uint64_t value, int64_t address, int64_t target)
+{
+    const int64_t offset = target - address - 8;
+    value &= ~(0xFFFFFFULL << 20);
+    value |= (static_cast<uint64_t>(offset) & 0x7FFFFF) << 20;
+    value |= (offset < 0 ? 1ULL : 0ULL) << 43;
+    return value;
+}
+
 inline void opcode::add_bits(uint64_t bits)
 {
     assert((value & bits) == 0);
@@ -55,3 +107,11 @@ inline void opcode::add_reuse(unsigned flag)
     assert((reuse & flag) == 0);
     reuse |= static_cast<uint8_t>(flag);
 }
+
+inline void opcode::add_gpr(int address, bool is_dest)
+{
+    gpr_fields |= 1ULL << address;
+    if (is_dest) {
+        dest_gpr_fields |= 1ULL << address;
+    }
+}
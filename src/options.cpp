@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "context.h"
 #include "error.h"
 #include "helper.h"
@@ -5,6 +7,11 @@
 
 void context::parse_option(token& token)
 {
+    // Keep the option line to assemble it again when objects are linked
+    const char* const option_begin = token.data.string.data();
+    options.append(option_begin, std::strcspn(option_begin, "\n"));
+    options.push_back('\n');
+
     const int option_line = token.line;
     const auto check_option_line = [option_line, &token] {
         if (token.line != option_line) {
@@ -42,7 +49,7 @@ void context::parse_option(token& token)
         parse_type();
     } else if (equal(token, ".num_gprs")) {
         token = tokenize();
-        if (token.type == token_type::immediate) {
+        if (token.type != token_type::immediate) {
             fatal_error(token, "expected number of general purpose registers");
         }
         num_gprs = static_cast<int>(token.data.immediate);
@@ -68,9 +75,56 @@ void context::parse_option(token& token)
             fatal_error(token, "expected local memory size");
         }
         local_mem_size = static_cast<int>(token.data.immediate);
+    } else if (equal(token, ".threads_per_primitive")) {
+        token = tokenize();
+        if (token.type != token_type::immediate || token.data.immediate < 1 ||
+            token.data.immediate > 32) {
+            fatal_error(token, "expected threads per primitive between 1 and 32");
+        }
+        threads_per_primitive = static_cast<int>(token.data.immediate);
+    } else if (equal(token, ".output_topology")) {
+        token = tokenize();
+        check_option_line();
+        if (equal(token, "points")) {
+            output_topology = 1;
+        } else if (equal(token, "line_strip")) {
+            output_topology = 6;
+        } else if (equal(token, "triangle_strip")) {
+            output_topology = 7;
+        } else {
+            fatal_error(token, "invalid output topology, valid are: points, line_strip, "
+                               "triangle_strip");
+        }
+    } else if (equal(token, ".max_output_vertices")) {
+        token = tokenize();
+        if (token.type != token_type::immediate || token.data.immediate < 0 ||
+            token.data.immediate > 1024) {
+            fatal_error(token, "expected maximum output vertices between 0 and 1024");
+        }
+        max_output_vertices = static_cast<int>(token.data.immediate);
+    } else if (equal(token, ".render_targets")) {
+        token = tokenize();
+        if (token.type != token_type::immediate || token.data.immediate < 0 ||
+            token.data.immediate > 8) {
+            fatal_error(token, "expected number of render targets between 0 and 8");
+        }
+        num_render_targets = static_cast<int>(token.data.immediate);
+    } else if (equal(token, ".writes_depth")) {
+        writes_depth = true;
     }
     token = tokenize();
     if (option_line == token.line) {
         fatal_error(token, "expected new line after option");
     }
 }
+
+void context::parse_options()
+{
+    token token = tokenize();
+    while (token.type == token_type::identifier && token.data.string[0] == '.') {
+        parse_option(token);
+    }
+    if (token.type != token_type::none) {
+        fatal_error(token, "expected option");
+    }
+}
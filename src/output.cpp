@@ -0,0 +1,130 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "error.h"
+#include "output.h"
+#include "trace.h"
+
+#ifdef _WIN32
+
+output_file::output_file(const char* filename_, size_t size_)
+    : filename{filename_}, temporary{filename + ".tmp"}, size{size_}, buffer(size_)
+{
+    contents = buffer.data();
+}
+
+output_file::~output_file() = default;
+
+void output_file::commit()
+{
+    std::ofstream file(temporary, std::ios::binary);
+    if (!file.is_open()) {
+        fatal_error("%s: failed to open", temporary.c_str());
+    }
+    file.write(reinterpret_cast<const char*>(contents), static_cast<std::streamsize>(size));
+    file.close();
+    if (!file) {
+        fatal_error("%s: failed to write", temporary.c_str());
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filename, error);
+    if (error) {
+        fatal_error("%s: failed to rename: %s", temporary.c_str(), error.message().c_str());
+    }
+}
+
+#else
+
+output_file::output_file(const char* filename_, size_t size_)
+    : filename{filename_}, temporary{filename + ".XXXXXX"}, size{size_}
+{
+    fd = mkstemp(temporary.data());
+    if (fd < 0) {
+        fatal_error("%s: failed to create: %s", filename.c_str(), std::strerror(errno));
+    }
+    // The destructor doesn't run when the constructor throws, remove the temporary file here
+    const auto fail = [this](const char* action) {
+        const int error = errno;
+        close(fd);
+        std::remove(temporary.c_str());
+        fatal_error("%s: failed to %s: %s", temporary.c_str(), action, std::strerror(error));
+    };
+    // Temporary files are private, give the output the permissions a new file would have
+    const mode_t mask = umask(0);
+    umask(mask);
+    if (fchmod(fd, 0666 & ~mask) != 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        fail("allocate");
+    }
+    if (size == 0) {
+        return;
+    }
+    void* const mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        fail("map");
+    }
+    contents = static_cast<uint8_t*>(mapping);
+}
+
+output_file::~output_file()
+{
+    if (fd < 0) {
+        return;
+    }
+    // The output was never committed, don't leave the temporary file behind
+    if (contents) {
+        munmap(contents, size);
+    }
+    close(fd);
+    std::remove(temporary.c_str());
+}
+
+void output_file::commit()
+{
+    // The mapping and the descriptor are released before any error is reported, so the
+    // destructor never releases them a second time
+    uint8_t* const mapping = std::exchange(contents, nullptr);
+    const int descriptor = std::exchange(fd, -1);
+    const auto fail = [this](const char* action, int error) {
+        std::remove(temporary.c_str());
+        fatal_error("%s: failed to %s: %s", temporary.c_str(), action, std::strerror(error));
+    };
+    if (mapping && munmap(mapping, size) != 0) {
+        const int error = errno;
+        close(descriptor);
+        fail("unmap", error);
+    }
+    if (close(descriptor) != 0) {
+        fail("write", errno);
+    }
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        fail("rename", errno);
+    }
+}
+
+#endif
+
+void write_output(const char* filename, const void* data, size_t size)
+{
+    TRACE_PHASE("write", filename);
+    output_file file(filename, size);
+    if (size > 0) {
+        std::memcpy(file.data().data(), data, size);
+    }
+    file.commit();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// File written through a temporary file of its final size mapped in memory, the temporary file
+// replaces the output once it's committed so readers never see a partially written file
+class output_file
+{
+  public:
+    output_file(const char* filename_, size_t size_);
+    ~output_file();
+
+    output_file(const output_file&) = delete;
+    output_file& operator=(const output_file&) = delete;
+
+    std::span<uint8_t> data()
+    {
+        return {contents, size};
+    }
+
+    // Unmaps the contents and renames the temporary file over the output
+    void commit();
+
+  private:
+    std::string filename;
+    std::string temporary;
+    size_t size;
+    uint8_t* contents = nullptr;
+    int fd = -1;
+
+    // Contents are buffered when files can't be mapped
+    std::vector<uint8_t> buffer;
+};
+
+// Writes a whole file at once through an output file
+void write_output(const char* filename, const void* data, size_t size);
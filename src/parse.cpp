@@ -1,16 +1,28 @@
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "context.h"
 #include "error.h"
 #include "helper.h"
+#include "object.h"
 #include "opcode.h"
 #include "operand.h"
 #include "parse.h"
+#include "regalloc.h"
 #include "table.h"
+#include "time_report.h"
 #include "token.h"
 
 static error assemble_predicate(const token& token, opcode& op, size_t shift, int is_negable)
@@ -105,6 +117,7 @@ static error assemble_sched(context& ctx, token& token, opcode& op)
 
 static std::pair<error, int> parse_insn(context& ctx, opcode& op, const insn& insn)
 {
+    COUNT_EVENT(candidates);
     op.add_bits(insn.opcode);
 
     token token = ctx.tokenize();
@@ -126,6 +139,481 @@ static std::pair<error, int> parse_insn(context& ctx, opcode& op, const insn& in
     return {confirm_type(token, token_type::semicolon), score};
 }
 
+// Table entries of a mnemonic, entries are parsed in order and the first that succeeds is taken
+struct candidate_list
+{
+    std::vector<uint16_t> table_order;
+    std::vector<uint16_t> parse_order;
+};
+
+#ifdef NXAS_CANDIDATE_PROFILE
+// Operands of each table entry as they are spelled in the table
+#undef INSN
+#define INSN(opcode, flags, mnemonic, ...) #__VA_ARGS__
+static const char* const operand_spellings[]{
+#include "table.inc"
+};
+#undef INSN
+
+// Token an operand accepts, an empty spelling accepts any token of the type
+struct token_pattern
+{
+    token_type type;
+    std::string_view spelling;
+};
+
+// Token sequences an operand accepts, an empty sequence when it can accept no token at all
+using operand_grammar = std::vector<std::vector<token_pattern>>;
+
+// Splits operands spelled like "sgpr<8>, comma, abs<46, sgpr<8>>" at the commas outside brackets
+static std::vector<std::string_view> split_operands(std::string_view spelling)
+{
+    std::vector<std::string_view> operands;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t index = 0; index <= spelling.size(); ++index) {
+        if (index == spelling.size() || (spelling[index] == ',' && depth == 0)) {
+            std::string_view operand = spelling.substr(start, index - start);
+            operand.remove_prefix(std::min(operand.find_first_not_of(' '), operand.size()));
+            operand = operand.substr(0, operand.find_last_not_of(' ') + 1);
+            if (!operand.empty()) {
+                operands.push_back(operand);
+            }
+            start = index + 1;
+        } else if (spelling[index] == '<') {
+            ++depth;
+        } else if (spelling[index] == '>') {
+            --depth;
+        }
+    }
+    return operands;
+}
+
+// Tokens accepted by the operands whose parsing is known, operands that aren't described here
+// can't be told apart from others
+static std::optional<operand_grammar> find_grammar(std::string_view operand)
+{
+    const std::string_view name = operand.substr(0, operand.find('<'));
+    std::vector<std::string_view> arguments;
+    if (name.size() < operand.size()) {
+        const size_t length = operand.size() - name.size() - 2;
+        arguments = split_operands(operand.substr(name.size() + 1, length));
+    }
+    const auto single = [](token_type type) { return operand_grammar{{{type, {}}}}; };
+    if (name == "comma") {
+        return single(token_type::comma);
+    }
+    if (name == "sgpr" || name == "dgpr") {
+        // Registers can be followed by .reuse
+        const token_pattern reg{token_type::regster, {}};
+        const token_pattern virtual_reg{token_type::virtual_register, {}};
+        const token_pattern flag{token_type::identifier, {}};
+        return operand_grammar{{reg}, {virtual_reg}, {reg, flag}, {virtual_reg, flag}};
+    }
+    if (name == "pred" || name == "inverted_pred") {
+        return single(token_type::predicate);
+    }
+    if (name == "imm" || name == "uinteger" || name == "sinteger" || name == "uimm16" ||
+        name == "uimm32" || name == "uimm_extended" || name == "zero") {
+        return single(token_type::immediate);
+    }
+    if (name == "fimm" || name == "fimm32" || name == "dimm20" || name.starts_with("fimm9_") ||
+        name.starts_with("fimm16_")) {
+        operand_grammar grammar{{{token_type::float_immediate, {}}}, {{token_type::immediate, {}}}};
+        for (const std::string_view constant : {"QNAN", "INF"}) {
+            const token_pattern identifier{token_type::identifier, constant};
+            grammar.push_back({identifier});
+            grammar.push_back({{token_type::plus, {}}, identifier});
+            grammar.push_back({{token_type::minus, {}}, identifier});
+        }
+        return grammar;
+    }
+    if (name == "cbuf") {
+        return operand_grammar{{{token_type::identifier, "c"}, {token_type::bracket_left, {}}}};
+    }
+    if (name == "neg") {
+        return operand_grammar{{}, {{token_type::minus, {}}}};
+    }
+    if (name == "tilde") {
+        return operand_grammar{{}, {{token_type::tilde, {}}}};
+    }
+    if (name == "default_rz") {
+        return operand_grammar{{}};
+    }
+    if (name == "abs" && arguments.size() == 2) {
+        std::optional grammar = find_grammar(arguments[1]);
+        if (!grammar) {
+            return std::nullopt;
+        }
+        const size_t num_inner = grammar->size();
+        for (size_t index = 0; index < num_inner; ++index) {
+            std::vector<token_pattern> absolute{{token_type::vbar, {}}};
+            absolute.insert(absolute.end(), (*grammar)[index].begin(), (*grammar)[index].end());
+            absolute.push_back({token_type::vbar, {}});
+            grammar->push_back(std::move(absolute));
+        }
+        return grammar;
+    }
+    return std::nullopt;
+}
+
+// Where parsing a candidate can be: in an operand's token sequence, or past its operands
+struct grammar_position
+{
+    size_t operand;
+    size_t sequence;
+    size_t token;
+
+    auto operator<=>(const grammar_position&) const = default;
+};
+
+class candidate_grammar
+{
+  public:
+    explicit candidate_grammar(std::span<const std::string_view> operands)
+    {
+        for (const std::string_view operand : operands) {
+            grammars.push_back(find_grammar(operand));
+        }
+    }
+
+    // Positions reached from the start of an operand without consuming tokens, false when an
+    // operand on the way isn't known
+    bool start(size_t operand, std::vector<grammar_position>& positions) const
+    {
+        if (operand == grammars.size()) {
+            positions.push_back({operand, 0, 0});
+            return true;
+        }
+        if (!grammars[operand]) {
+            return false;
+        }
+        for (size_t sequence = 0; sequence < grammars[operand]->size(); ++sequence) {
+            if ((*grammars[operand])[sequence].empty()) {
+                if (!start(operand + 1, positions)) {
+                    return false;
+                }
+            } else {
+                positions.push_back({operand, sequence, 0});
+            }
+        }
+        return true;
+    }
+
+    // Token expected at a position, scheduling directives and the semicolon end the operands
+    std::optional<token_pattern> expected(const grammar_position& position) const
+    {
+        if (position.operand == grammars.size()) {
+            return std::nullopt;
+        }
+        return (*grammars[position.operand])[position.sequence][position.token];
+    }
+
+    bool advance(const grammar_position& position, std::vector<grammar_position>& positions) const
+    {
+        const std::vector<token_pattern>& sequence =
+            (*grammars[position.operand])[position.sequence];
+        if (position.token + 1 < sequence.size()) {
+            positions.push_back({position.operand, position.sequence, position.token + 1});
+            return true;
+        }
+        return start(position.operand + 1, positions);
+    }
+
+  private:
+    std::vector<std::optional<operand_grammar>> grammars;
+};
+
+static bool same_token(const token_pattern& first, const token_pattern& second)
+{
+    return first.type == second.type &&
+           (first.spelling.empty() || second.spelling.empty() ||
+            first.spelling == second.spelling);
+}
+
+bool are_disjoint_candidates(size_t first, size_t second)
+{
+    // Operands decide what they consume from the tokens and the fields earlier operands encoded,
+    // opcodes are zero in those fields. Candidates sharing their first operands reach the first
+    // operand they differ in at the same token, both are walked from there a token at a time and
+    // they are disjoint once no token can be accepted by both.
+    const std::vector<std::string_view> first_operands = split_operands(operand_spellings[first]);
+    const std::vector<std::string_view> second_operands =
+        split_operands(operand_spellings[second]);
+    const auto [first_it, second_it] = std::ranges::mismatch(first_operands, second_operands);
+    const candidate_grammar first_grammar{std::span(first_it, first_operands.end())};
+    const candidate_grammar second_grammar{std::span(second_it, second_operands.end())};
+
+    std::vector<grammar_position> first_positions;
+    std::vector<grammar_position> second_positions;
+    if (!first_grammar.start(0, first_positions) || !second_grammar.start(0, second_positions)) {
+        return false;
+    }
+    std::set<std::pair<grammar_position, grammar_position>> pairs;
+    for (const grammar_position& first_position : first_positions) {
+        for (const grammar_position& second_position : second_positions) {
+            pairs.insert({first_position, second_position});
+        }
+    }
+    while (!pairs.empty()) {
+        std::set<std::pair<grammar_position, grammar_position>> next;
+        for (const auto& [first_position, second_position] : pairs) {
+            const std::optional first_token = first_grammar.expected(first_position);
+            const std::optional second_token = second_grammar.expected(second_position);
+            if (!first_token || !second_token) {
+                // Past their operands candidates parse scheduling directives and the semicolon
+                const std::optional other = first_token ? first_token : second_token;
+                if (!other || other->type == token_type::at ||
+                    other->type == token_type::semicolon) {
+                    return false;
+                }
+                continue;
+            }
+            if (!same_token(*first_token, *second_token)) {
+                continue;
+            }
+            first_positions.clear();
+            second_positions.clear();
+            if (!first_grammar.advance(first_position, first_positions) ||
+                !second_grammar.advance(second_position, second_positions)) {
+                return false;
+            }
+            for (const grammar_position& first_next : first_positions) {
+                for (const grammar_position& second_next : second_positions) {
+                    next.insert({first_next, second_next});
+                }
+            }
+        }
+        pairs = std::move(next);
+    }
+    return true;
+}
+
+struct profiled_candidate
+{
+    const char* mnemonic;
+    size_t index;
+    uint64_t successes;
+};
+
+#define CANDIDATE(mnemonic, index, successes) {mnemonic, index, successes},
+static const profiled_candidate profiled_candidates[]{
+#include NXAS_CANDIDATE_PROFILE
+    {"", 0, 0},
+};
+#undef CANDIDATE
+
+// Puts the candidates that succeed the most first. A candidate only moves before the candidates
+// earlier in the table that can't parse the same instructions, so whatever the profile the first
+// candidate in table order that parses an instruction is the one that encodes it. Mnemonics with a
+// candidate the profiled corpus never parsed keep their table order.
+static std::vector<uint16_t> profiled_order(std::string_view mnemonic,
+                                            const std::vector<uint16_t>& table_order)
+{
+    const size_t num_candidates = table_order.size();
+    std::vector<uint64_t> successes(num_candidates);
+    for (const profiled_candidate& candidate : profiled_candidates) {
+        if (mnemonic == candidate.mnemonic && candidate.index < num_candidates) {
+            successes[candidate.index] = candidate.successes;
+        }
+    }
+    if (std::ranges::find(successes, 0) != successes.end()) {
+        return table_order;
+    }
+    // Candidates that have to be placed before each candidate
+    std::vector<std::vector<size_t>> predecessors(num_candidates);
+    for (size_t second = 0; second < num_candidates; ++second) {
+        for (size_t first = 0; first < second; ++first) {
+            if (!are_disjoint_candidates(table_order[first], table_order[second])) {
+                predecessors[second].push_back(first);
+            }
+        }
+    }
+    std::vector<bool> is_placed(num_candidates);
+    std::vector<uint16_t> order;
+    while (order.size() < num_candidates) {
+        std::optional<size_t> best;
+        for (size_t index = 0; index < num_candidates; ++index) {
+            const bool is_ready = std::ranges::all_of(
+                predecessors[index], [&](size_t predecessor) { return is_placed[predecessor]; });
+            if (!is_placed[index] && is_ready && (!best || successes[index] > successes[*best])) {
+                best = index;
+            }
+        }
+        is_placed[*best] = true;
+        order.push_back(table_order[*best]);
+    }
+    return order;
+}
+#endif
+
+static const std::unordered_map<std::string_view, candidate_list>& candidate_lists()
+{
+    static const std::unordered_map<std::string_view, candidate_list> lists = [] {
+        std::unordered_map<std::string_view, candidate_list> result;
+        for (size_t index = 0; index < std::size(table); ++index) {
+            result[table[index].mnemonic].table_order.push_back(static_cast<uint16_t>(index));
+        }
+        for (auto& [mnemonic, list] : result) {
+#ifdef NXAS_CANDIDATE_PROFILE
+            list.parse_order = profiled_order(mnemonic, list.table_order);
+#else
+            list.parse_order = list.table_order;
+#endif
+        }
+        return result;
+    }();
+    return lists;
+}
+
+std::span<const uint16_t> find_candidates(std::string_view mnemonic)
+{
+    const auto& lists = candidate_lists();
+    const auto list = lists.find(mnemonic);
+    return list != lists.end() ? std::span(list->second.parse_order) : std::span<const uint16_t>{};
+}
+
+static candidate_profile* recorded_profile = nullptr;
+
+void record_candidates(candidate_profile* profile)
+{
+    if (profile) {
+        profile->successes.resize(std::size(table));
+    }
+    recorded_profile = profile;
+}
+
+std::string format_candidate_profile(const candidate_profile& profile)
+{
+    std::string result = "// Candidate profile written by nxas --record-candidates, candidates are "
+                         "numbered in table order\n// for their mnemonic\n";
+    const auto candidate_number = [](size_t entry) {
+        const std::vector<uint16_t>& order =
+            candidate_lists().at(table[entry].mnemonic).table_order;
+        return std::ranges::find(order, entry) - order.begin();
+    };
+    char line[96];
+    for (size_t entry = 0; entry < profile.successes.size(); ++entry) {
+        if (profile.successes[entry] != 0) {
+            std::snprintf(line, sizeof(line), "CANDIDATE(\"%s\", %td, %llu)\n",
+                          table[entry].mnemonic, candidate_number(entry),
+                          static_cast<unsigned long long>(profile.successes[entry]));
+            result += line;
+        }
+    }
+    return result;
+}
+
+// Tries the candidates after the one that parsed an instruction to find the others that parse it,
+// the instruction and the tokenizer are left as the first candidate parsed them
+static void record_overlaps(context& ctx, opcode& op, std::span<const uint16_t> candidates,
+                            const context::position& start, const opcode& start_op)
+{
+    ++recorded_profile->successes[candidates[0]];
+
+    const opcode parsed = op;
+    const context::position end = ctx.tell();
+    const size_t num_virtual_gprs = ctx.virtual_gprs->size();
+    const size_t num_external_labels = ctx.external_labels ? ctx.external_labels->size() : 0;
+    std::vector<uint16_t> successes{candidates[0]};
+    for (const uint16_t candidate : candidates.subspan(1)) {
+        ctx.rewind(start);
+        op = start_op;
+        if (!parse_insn(ctx, op, table[candidate]).first) {
+            successes.push_back(candidate);
+        }
+        ctx.virtual_gprs->resize(num_virtual_gprs);
+        if (ctx.external_labels) {
+            ctx.external_labels->resize(num_external_labels);
+        }
+    }
+    for (size_t first = 0; first < successes.size(); ++first) {
+        for (size_t second = first + 1; second < successes.size(); ++second) {
+            recorded_profile->overlaps.insert({successes[first], successes[second]});
+        }
+    }
+    ctx.rewind(end);
+    op = parsed;
+}
+
+void read_candidate_profile(std::string_view text, candidate_profile& profile)
+{
+    profile.successes.resize(std::size(table));
+    const auto entry = [](std::string_view mnemonic, size_t number) -> std::optional<size_t> {
+        const auto list = candidate_lists().find(mnemonic);
+        if (list == candidate_lists().end() || number >= list->second.table_order.size()) {
+            return std::nullopt;
+        }
+        return list->second.table_order[number];
+    };
+    while (!text.empty()) {
+        const std::string_view line = text.substr(0, text.find('\n'));
+        text.remove_prefix(std::min(text.size(), line.size() + 1));
+
+        char mnemonic[16];
+        unsigned long long first;
+        unsigned long long second;
+        const std::string copy{line};
+        if (std::sscanf(copy.c_str(), "CANDIDATE(\"%15[^\"]\", %llu, %llu)", mnemonic, &first,
+                        &second) == 3) {
+            // Candidates of mnemonics no longer in the table are dropped
+            if (const std::optional index = entry(mnemonic, first)) {
+                profile.successes[*index] += second;
+            }
+        }
+    }
+}
+
+void parse_operands(context& ctx, opcode& op, std::span<const uint16_t> order)
+{
+    const context::position saved_position = ctx.tell();
+    const opcode saved_op = op;
+    const size_t saved_virtual_gprs = ctx.virtual_gprs->size();
+    const size_t saved_external_labels = ctx.external_labels ? ctx.external_labels->size() : 0;
+    const auto rewind = [&] {
+        ctx.rewind(saved_position);
+        op = saved_op;
+        ctx.virtual_gprs->resize(saved_virtual_gprs);
+        if (ctx.external_labels) {
+            ctx.external_labels->resize(saved_external_labels);
+        }
+    };
+
+    {
+        // Most instructions fail a candidate before one matches, messages are only formatted
+        // when none of them does
+        const quiet_errors quiet;
+        for (auto it = order.begin(); it != order.end(); ++it) {
+            const insn& insn = table[*it];
+            if (!parse_insn(ctx, op, insn).first) {
+                if (recorded_profile) {
+                    record_overlaps(ctx, op, std::span(it, order.end()), saved_position, saved_op);
+                }
+                // successfully decoded instruction
+                op.info = &insn;
+                return;
+            }
+            COUNT_EVENT(failed_candidates);
+            // failure, rewind the tokenizer
+            rewind();
+        }
+    }
+    error error_message;
+    int error_score = -1;
+    size_t error_entry = 0;
+    for (const uint16_t entry : order) {
+        auto [insn_error, score] = parse_insn(ctx, op, table[entry]);
+        // Messages don't depend on the order candidates are tried in
+        if (score > error_score || (score == error_score && entry < error_entry)) {
+            error_message = std::move(insn_error);
+            error_score = score;
+            error_entry = entry;
+        }
+        rewind();
+    }
+    error_message.raise();
+}
+
 bool parse_instruction(context& ctx, opcode& op)
 {
     token token = ctx.tokenize();
@@ -138,6 +626,8 @@ bool parse_instruction(context& ctx, opcode& op)
     if (ctx.pc % 0x20 == 0) {
         ctx.pc += 8;
     }
+    op.line = token.line;
+    op.column = token.column;
     if (token.type == token_type::at) {
         token = ctx.tokenize();
         if (error message = assemble_predicate(token, op, 16, 1); message) {
@@ -151,35 +641,15 @@ bool parse_instruction(context& ctx, opcode& op)
     if (token.type != token_type::identifier) {
         fatal_error(token, "expected mnemonic");
     }
-    const context saved_context = ctx;
-    const opcode saved_op = op;
-    error error_message;
-    int error_score = -1;
-
-    const size_t num_insns = sizeof(table) / sizeof(table[0]);
-    for (size_t i = 0; i < num_insns; ++i) {
-        const insn& insn = table[i];
-        if (!equal(token, insn.mnemonic)) {
-            continue;
-        }
-        auto [insn_error, score] = parse_insn(ctx, op, insn);
-        if (!insn_error) {
-            // successfully decoded instruction
-            ctx.pc += 8;
-            return true;
-        }
-        if (score > error_score) {
-            error_message = std::move(insn_error);
-            error_score = score;
-        }
-        // failure, restore context
-        ctx = saved_context;
-        op = saved_op;
-    }
-    if (error_message) {
-        error_message.raise();
-    } else {
+    const auto& lists = candidate_lists();
+    const auto list = lists.find(token.data.string);
+    if (list == lists.end()) {
         fatal_error(token, "unknown mnemonic \33[1m%.*s\33[0m", std::size(token.data.string),
                     std::data(token.data.string));
     }
+    // Recording tries candidates in table order, the order the profile is applied to
+    parse_operands(ctx, op,
+                   recorded_profile ? list->second.table_order : list->second.parse_order);
+    ctx.pc += 8;
+    return true;
 }
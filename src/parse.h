@@ -1,6 +1,52 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 class context;
 struct opcode;
 
 bool parse_instruction(context& ctx, opcode& op);
+
+// Parses the modifiers and operands of an instruction with the first table entry in order that
+// accepts them, its predicate is already in op. When none does the message of the entry that
+// read the most operands is raised.
+void parse_operands(context& ctx, opcode& op, std::span<const uint16_t> order);
+
+// Table entries of a mnemonic in the order they are parsed, empty when no entry has the mnemonic
+std::span<const uint16_t> find_candidates(std::string_view mnemonic);
+
+// Table entries that parsed the instructions of a corpus, used to try the entries of a mnemonic
+// that succeed the most first
+struct candidate_profile
+{
+    // Instructions parsed by each entry when entries are tried in table order
+    std::vector<uint64_t> successes;
+
+    // Entries that parsed the same instruction, the first one comes earlier in the table. They
+    // aren't written to the profile, they check which entries are disjoint.
+    std::set<std::pair<size_t, size_t>> overlaps;
+};
+
+#ifdef NXAS_CANDIDATE_PROFILE
+// True when two table entries can't parse the same instruction, told from the tokens their first
+// differing operands start with. Profiles only move an entry before the earlier entries it's
+// disjoint from.
+bool are_disjoint_candidates(size_t first, size_t second);
+#endif
+
+// Records the candidates of the instructions parsed from now on, every candidate of each
+// instruction is tried to find overlaps. Recording stops when the profile is null.
+void record_candidates(candidate_profile* profile);
+
+// Writes a profile the NXAS_CANDIDATE_PROFILE build option reads
+std::string format_candidate_profile(const candidate_profile& profile);
+
+// Adds a profile written before to another, profiles of many runs add up
+void read_candidate_profile(std::string_view text, candidate_profile& profile);
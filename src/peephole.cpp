@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "context.h"
+#include "flow.h"
+#include "helper.h"
+#include "opcode.h"
+#include "peephole.h"
+#include "resources.h"
+#include "table.h"
+
+constexpr uint32_t MAX_STALL = 15;
+
+static uint64_t field(const opcode& op, int offset, int size)
+{
+    return (op.value >> offset) & max_bits(size);
+}
+
+static bool is_mnemonic(const opcode& op, std::string_view mnemonic)
+{
+    return op.info->mnemonic == mnemonic;
+}
+
+// Barriers, yields and reuse flags have effects beyond the instruction itself
+static bool has_control_information(const opcode& op)
+{
+    const auto& sched = op.sched.values;
+    return op.reuse != 0 || sched.yield != 0 || sched.write_barrier != 7 ||
+           sched.read_barrier != 7 || sched.wait_barrier != 0;
+}
+
+static bool is_plain_nop(const opcode& op)
+{
+    return is_mnemonic(op, "NOP") && field(op, 13, 1) == 0;
+}
+
+static bool is_self_move(const opcode& op)
+{
+    // Only the register to register form reads a register at bit 20
+    return (op.value >> 48) == 0x5C98 && field(op, 0, 8) == field(op, 20, 8);
+}
+
+// Instructions that read the register they write through a mirrored operand
+static bool reads_destination(const opcode& op)
+{
+    return is_mnemonic(op, "FFMA32I") || is_mnemonic(op, "HFMA2_32I");
+}
+
+// Textures and surfaces write registers depending on their component mask, and moves can be
+// restricted to some lanes of a quad
+static bool writes_whole_destination(const opcode& op)
+{
+    for (const char* name : {"TEX", "TEXS", "TLD", "TLDS", "TLD4", "TLD4S", "TXD", "TMML", "TXQ",
+                             "SULD"}) {
+        if (is_mnemonic(op, name)) {
+            return false;
+        }
+    }
+    return !is_mnemonic(op, "MOV") || field(op, 39, 4) == 0xF;
+}
+
+static bool accesses(const opcode& op, uint64_t fields, int regster)
+{
+    for (; fields != 0; fields &= fields - 1) {
+        const int address = std::countr_zero(fields);
+        const int first = static_cast<int>(field(op, address, 8));
+        if (first != ZERO_REGISTER && regster >= first &&
+            regster < first + gpr_width(op, address)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool reads_register(const opcode& op, int regster)
+{
+    const uint64_t fields = reads_destination(op) ? op.gpr_fields
+                                                  : op.gpr_fields & ~op.dest_gpr_fields;
+    return accesses(op, fields, regster);
+}
+
+static bool overwrites_register(const opcode& op, int regster)
+{
+    return is_unconditional(op) && writes_whole_destination(op) &&
+           accesses(op, op.dest_gpr_fields, regster);
+}
+
+// Looks for a write to the destination of a move before it's read, without leaving the block
+static bool is_dead_move(std::span<const opcode> opcodes,
+                         std::span<const std::vector<size_t>> successors,
+                         std::span<const char> leaders, size_t index)
+{
+    const int regster = static_cast<int>(field(opcodes[index], 0, 8));
+    if (regster == ZERO_REGISTER) {
+        return true;
+    }
+    for (size_t next = index + 1; next < opcodes.size() && !leaders[next]; ++next) {
+        const opcode& op = opcodes[next];
+        if (reads_register(op, regster)) {
+            return false;
+        }
+        if (overwrites_register(op, regster)) {
+            return true;
+        }
+        if (successors[next].size() != 1 || successors[next][0] != next + 1) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Keeps the cycles taken by a removed instruction stalling the previous one longer
+static bool fold_stall(opcode& previous, const opcode& removed)
+{
+    const uint32_t stall =
+        previous.sched.values.stall + std::max<uint32_t>(removed.sched.values.stall, 1);
+    if (stall > MAX_STALL) {
+        return false;
+    }
+    previous.sched.values.stall = stall;
+    return true;
+}
+
+size_t remove_redundant_instructions(context& ctx, std::span<opcode> opcodes)
+{
+    // Instructions reachable from somewhere other than the previous one start a block
+    const std::vector<std::vector<size_t>> successors = control_flow(opcodes);
+    std::vector<char> leaders(opcodes.size());
+    for (const size_t index : ctx.labeled_instructions()) {
+        if (index < opcodes.size()) {
+            leaders[index] = 1;
+        }
+    }
+    for (size_t index = 0; index < opcodes.size(); ++index) {
+        for (const size_t target : successors[index]) {
+            if (target != index + 1) {
+                leaders[target] = 1;
+            }
+        }
+    }
+
+    // The entrypoint has to stay in its slot of a bundle, instructions in front of it are kept
+    size_t first_removable = 0;
+    if (const std::optional entrypoint = ctx.entrypoint_address()) {
+        first_removable = instruction_index(*entrypoint).value_or(0);
+    }
+
+    // Instructions are only looked ahead of the one being compacted, so it can be done in place.
+    // The first instruction kept has no previous one to stall, nothing before it waits on it.
+    std::vector<size_t> new_indices(opcodes.size() + 1);
+    std::vector<size_t> old_indices;
+    size_t kept = 0;
+    for (size_t index = 0; index < opcodes.size(); ++index) {
+        new_indices[index] = kept;
+        const opcode& op = opcodes[index];
+        const bool is_redundant =
+            is_plain_nop(op) || is_self_move(op) ||
+            (is_mnemonic(op, "MOV") && is_dead_move(opcodes, successors, leaders, index));
+        if (index >= first_removable && is_redundant && !leaders[index] &&
+            !has_control_information(op) &&
+            (kept == 0 ||
+             (opcodes[kept - 1].reuse == 0 && fold_stall(opcodes[kept - 1], op)))) {
+            continue;
+        }
+        old_indices.push_back(index);
+        opcodes[kept++] = op;
+    }
+    new_indices[opcodes.size()] = kept;
+
+    for (size_t index = 0; index < kept; ++index) {
+        opcode& op = opcodes[index];
+        if (!has_label(op)) {
+            continue;
+        }
+        int64_t target = label_target(op.value, instruction_address(old_indices[index]));
+        const std::optional target_index = instruction_index(target);
+        if (target_index && *target_index < new_indices.size()) {
+            target = instruction_address(new_indices[*target_index]);
+        }
+        op.value = set_label_target(op.value, instruction_address(index), target);
+    }
+    ctx.relocate_labels(new_indices);
+    return kept;
+}
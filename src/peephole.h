@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+class context;
+struct opcode;
+
+// Removes self moves, moves overwritten before being read and NOPs without side effects.
+// Remaining instructions are compacted to the front with their labels relocated, returns how
+// many instructions are left.
+size_t remove_redundant_instructions(context& ctx, std::span<opcode> opcodes);
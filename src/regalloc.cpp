@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "error.h"
+#include "flow.h"
+#include "opcode.h"
+#include "regalloc.h"
+#include "resources.h"
+
+struct virtual_register
+{
+    const virtual_gpr* first = nullptr;
+    int size = 1;
+    size_t start = SIZE_MAX;
+    size_t end = 0;
+    bool used_at_start = false;
+    bool defined_at_end = false;
+    int base = -1;
+};
+
+// Register tuples have to be aligned to their size rounded up to a power of two
+static int tuple_alignment(int size)
+{
+    return static_cast<int>(std::bit_ceil(static_cast<unsigned>(size)));
+}
+
+// Sorted register ids of each instruction, sets are sparse because few registers are live at once
+// in programs that allocate, a set per instruction as wide as every register would grow with the
+// square of the program
+using live_sets = std::vector<std::vector<size_t>>;
+
+static void insert(std::vector<size_t>& set, size_t id)
+{
+    const auto it = std::ranges::lower_bound(set, id);
+    if (it == set.end() || *it != id) {
+        set.insert(it, id);
+    }
+}
+
+static bool contains(const std::vector<size_t>& set, size_t id)
+{
+    return std::ranges::binary_search(set, id);
+}
+
+// Each register can be shared by a register that dies and one that is born in the same
+// instruction, more live registers than that can't be allocated
+constexpr size_t MAX_LIVE_REGISTERS = 2 * NUM_USER_REGISTERS;
+
+std::string_view virtual_register_name(const token& token)
+{
+    const std::string_view spelling = token.data.string;
+    return spelling.substr(0, spelling.find(':'));
+}
+
+int virtual_register_component(const token& token)
+{
+    const std::string_view spelling = token.data.string;
+    const size_t colon = spelling.find(':');
+    if (colon == std::string_view::npos) {
+        return 0;
+    }
+    int component = 0;
+    for (const char digit : spelling.substr(colon + 1)) {
+        component = std::min(component * 10 + (digit - '0'), NUM_REGISTERS);
+    }
+    return component;
+}
+
+void allocate_registers(std::span<opcode> opcodes, std::span<const virtual_gpr> gprs)
+{
+    std::unordered_map<std::string_view, size_t> ids;
+    std::vector<virtual_register> registers;
+    std::vector<size_t> gpr_ids;
+    gpr_ids.reserve(gprs.size());
+
+    for (const virtual_gpr& gpr : gprs) {
+        const std::string_view name = virtual_register_name(gpr.source);
+        const int component = virtual_register_component(gpr.source);
+        const auto [it, is_new] = ids.try_emplace(name, registers.size());
+        if (is_new) {
+            registers.push_back(virtual_register{.first = &gpr});
+        }
+        const int width = gpr_width(opcodes[gpr.instruction], gpr.address);
+        if (component % tuple_alignment(width) != 0) {
+            fatal_error(gpr.source, "component %d of %.*s is not aligned to a %d register tuple",
+                        component, static_cast<int>(name.size()), name.data(),
+                        tuple_alignment(width));
+        }
+        virtual_register& reg = registers[it->second];
+        reg.size = std::max(reg.size, component + width);
+        if (reg.size > NUM_USER_REGISTERS) {
+            fatal_error(gpr.source, "virtual register tuple is too large");
+        }
+        gpr_ids.push_back(it->second);
+    }
+
+    // Registers read and completely overwritten by each instruction
+    const size_t num_instructions = opcodes.size();
+    live_sets uses(num_instructions);
+    live_sets kills(num_instructions);
+    live_sets defs(num_instructions);
+    std::vector<uint64_t> virtual_fields(num_instructions);
+    for (size_t i = 0; i < gprs.size(); ++i) {
+        const virtual_gpr& gpr = gprs[i];
+        const size_t id = gpr_ids[i];
+        const opcode& op = opcodes[gpr.instruction];
+        virtual_fields[gpr.instruction] |= 1ULL << gpr.address;
+        if (!gpr.is_dest) {
+            insert(uses[gpr.instruction], id);
+            continue;
+        }
+        insert(defs[gpr.instruction], id);
+
+        // Partial and predicated writes keep the rest of the register alive
+        const int component = virtual_register_component(gpr.source);
+        if (component == 0 && gpr_width(op, gpr.address) >= registers[id].size &&
+            is_unconditional(op)) {
+            insert(kills[gpr.instruction], id);
+        }
+    }
+
+    // Solve liveness backwards until it converges
+    const std::vector<std::vector<size_t>> successors = control_flow(opcodes);
+    live_sets live_in(num_instructions);
+    std::vector<size_t> live_out;
+    std::vector<size_t> merged;
+    std::vector<size_t> value;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t index = num_instructions; index-- > 0;) {
+            live_out.clear();
+            for (const size_t successor : successors[index]) {
+                merged.clear();
+                std::ranges::set_union(live_out, live_in[successor], std::back_inserter(merged));
+                std::swap(live_out, merged);
+            }
+            merged.clear();
+            std::ranges::set_difference(live_out, kills[index], std::back_inserter(merged));
+            value.clear();
+            std::ranges::set_union(uses[index], merged, std::back_inserter(value));
+            if (value.size() > MAX_LIVE_REGISTERS) {
+                const virtual_gpr& gpr = *registers[value.back()].first;
+                const std::string_view name = virtual_register_name(gpr.source);
+                fatal_error(gpr.source, "ran out of registers allocating %.*s",
+                            static_cast<int>(name.size()), name.data());
+            }
+            if (value != live_in[index]) {
+                changed = true;
+                live_in[index] = value;
+            }
+        }
+    }
+
+    // Build live intervals in program order
+    for (size_t index = 0; index < num_instructions; ++index) {
+        merged.clear();
+        std::ranges::set_union(live_in[index], defs[index], std::back_inserter(merged));
+        for (const size_t id : merged) {
+            virtual_register& reg = registers[id];
+            const bool is_used = contains(uses[index], id);
+            const bool is_defined = contains(defs[index], id);
+            if (reg.start == SIZE_MAX) {
+                reg.start = index;
+                reg.used_at_start = is_used;
+            }
+            reg.end = index;
+            reg.defined_at_end = is_defined;
+        }
+    }
+
+    // Registers named explicitly can't be handed out
+    std::array<int, NUM_USER_REGISTERS> busy{};
+    for (size_t index = 0; index < num_instructions; ++index) {
+        const opcode& op = opcodes[index];
+        for (uint64_t fields = op.gpr_fields & ~virtual_fields[index]; fields != 0;
+             fields &= fields - 1) {
+            const int address = std::countr_zero(fields);
+            const int regster = static_cast<int>((op.value >> address) & 0xFF);
+            if (regster == ZERO_REGISTER) {
+                continue;
+            }
+            const int last = std::min(regster + gpr_width(op, address), NUM_USER_REGISTERS);
+            for (int i = regster; i < last; ++i) {
+                busy[i] = 1;
+            }
+        }
+    }
+
+    std::vector<virtual_register*> order;
+    order.reserve(registers.size());
+    for (virtual_register& reg : registers) {
+        order.push_back(&reg);
+    }
+    std::ranges::stable_sort(order, {}, &virtual_register::start);
+
+    std::vector<virtual_register*> active;
+    for (virtual_register* const reg : order) {
+        // Release registers whose last use is before this one is written
+        std::erase_if(active, [reg, &busy](const virtual_register* other) {
+            const bool shares_instruction = other->end == reg->start && !other->defined_at_end &&
+                                            !reg->used_at_start && other->size == 1 &&
+                                            reg->size == 1;
+            if (other->end >= reg->start && !shares_instruction) {
+                return false;
+            }
+            for (int i = 0; i < other->size; ++i) {
+                --busy[other->base + i];
+            }
+            return true;
+        });
+
+        // Pick the lowest free tuple to keep the highest register down
+        const int alignment = tuple_alignment(reg->size);
+        for (int base = 0; base + reg->size <= NUM_USER_REGISTERS; base += alignment) {
+            const auto tuple = std::span(busy).subspan(base, reg->size);
+            if (std::ranges::all_of(tuple, [](int count) { return count == 0; })) {
+                reg->base = base;
+                break;
+            }
+        }
+        if (reg->base < 0) {
+            const std::string_view name = virtual_register_name(reg->first->source);
+            fatal_error(reg->first->source, "ran out of registers allocating %.*s",
+                        static_cast<int>(name.size()), name.data());
+        }
+        for (int i = 0; i < reg->size; ++i) {
+            ++busy[reg->base + i];
+        }
+        active.push_back(reg);
+    }
+
+    for (size_t i = 0; i < gprs.size(); ++i) {
+        const virtual_gpr& gpr = gprs[i];
+        const int component = virtual_register_component(gpr.source);
+        const uint64_t regster = static_cast<uint64_t>(registers[gpr_ids[i]].base + component);
+        opcode& op = opcodes[gpr.instruction];
+        op.value = (op.value & ~(0xFFULL << gpr.address)) | (regster << gpr.address);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "token.h"
+
+struct opcode;
+
+// Register operand naming a virtual register, patched once registers are allocated
+struct virtual_gpr
+{
+    struct token source;
+    size_t instruction;
+    int address;
+    bool is_dest;
+};
+
+// Name of a virtual register token without its component
+std::string_view virtual_register_name(const token& token);
+
+// Register of the tuple referenced by a virtual register token
+int virtual_register_component(const token& token);
+
+void allocate_registers(std::span<opcode> opcodes, std::span<const virtual_gpr> gprs);
@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "disassemble.h"
+#include "flow.h"
+#include "helper.h"
+#include "opcode.h"
+#include "resources.h"
+#include "table.h"
+
+// Keep the same minimum register allocation other Maxwell drivers use
+constexpr int MIN_GPRS = 4;
+
+// Size in bytes of a call, return and sync stack entry
+constexpr int CRS_ENTRY_SIZE = 16;
+
+// Texture and surface vectors depend on the type and mask, assume the largest
+constexpr int MAX_VECTOR_GPRS = 4;
+
+constexpr int MAX_BARRIERS = 16;
+
+// Generic attributes span these bytes of attribute memory
+constexpr int GENERIC_ATTRIBUTES_BEGIN = 0x80;
+constexpr int GENERIC_ATTRIBUTES_END = 0x280;
+
+constexpr int MAX_PATCH_ATTRIBUTES_SIZE = 255 * 16;
+
+constexpr uint64_t PREDICATE_MASK = 0xFULL << 16;
+
+static uint64_t field(const opcode& op, int offset, int size)
+{
+    return (op.value >> offset) & max_bits(size);
+}
+
+static bool is_any(std::string_view mnemonic, std::initializer_list<std::string_view> list)
+{
+    return std::ranges::find(list, mnemonic) != list.end();
+}
+
+static int memory_size_bytes(uint64_t size)
+{
+    static constexpr int sizes[] = {1, 1, 2, 2, 4, 8, 16, 16};
+    return sizes[size & 7];
+}
+
+int gpr_width(const opcode& op, int address)
+{
+    const std::string_view mnemonic = op.info->mnemonic;
+    const bool is_dest = (op.dest_gpr_fields >> address) & 1;
+
+    if (is_any(mnemonic, {"LDG", "STG", "LDS", "STS", "LDL", "STL"})) {
+        if (address == 8) {
+            return is_any(mnemonic, {"LDG", "STG"}) && field(op, 45, 1) ? 2 : 1;
+        }
+        return std::max(memory_size_bytes(field(op, 48, 3)) / 4, 1);
+    }
+    if (is_any(mnemonic, {"ATOM", "RED"})) {
+        if (address == 8) {
+            return field(op, 48, 1) ? 2 : 1;
+        }
+        const uint64_t size = mnemonic == "ATOM" ? field(op, 49, 3) : field(op, 20, 3);
+        return size == 2 || size == 5 ? 2 : 1;
+    }
+    if (mnemonic == "ATOMS") {
+        return address != 8 && field(op, 28, 2) >= 2 ? 2 : 1;
+    }
+    if (is_any(mnemonic, {"ALD", "AST"})) {
+        return address == 0 ? static_cast<int>(field(op, 47, 2)) + 1 : 1;
+    }
+    if (mnemonic == "LDC") {
+        return is_dest && field(op, 48, 3) == 5 ? 2 : 1;
+    }
+    if (is_any(mnemonic, {"DADD", "DFMA", "DMNMX", "DMUL", "DSETP"})) {
+        return 2;
+    }
+    if (mnemonic == "DSET") {
+        return is_dest ? 1 : 2;
+    }
+    if (is_any(mnemonic, {"F2F", "F2I", "I2F"})) {
+        return field(op, is_dest ? 8 : 10, 2) == 3 ? 2 : 1;
+    }
+    if (is_any(mnemonic, {"TEXS", "TLDS", "TLD4S"})) {
+        return 2;
+    }
+    if (is_any(mnemonic, {"TEX", "TLD", "TLD4", "TXD", "TMML", "TXQ"})) {
+        return MAX_VECTOR_GPRS;
+    }
+    if (is_any(mnemonic, {"SULD", "SUST"})) {
+        if (address == 8 || !field(op, 52, 1)) {
+            return MAX_VECTOR_GPRS;
+        }
+        return std::max(memory_size_bytes(field(op, 20, 3)) / 4, 1);
+    }
+    return 1;
+}
+
+static int highest_gpr(const opcode& op)
+{
+    int highest = -1;
+    for (uint64_t fields = op.gpr_fields; fields != 0; fields &= fields - 1) {
+        const int address = std::countr_zero(fields);
+        const int regster = static_cast<int>(field(op, address, 8));
+        if (regster != ZERO_REGISTER) {
+            highest = std::max(highest, regster + gpr_width(op, address) - 1);
+        }
+    }
+    return highest;
+}
+
+static void touch_memory(std::optional<int>& size, const opcode& op, int offset, int bytes)
+{
+    if (!size) {
+        return;
+    }
+    if (field(op, 8, 8) != ZERO_REGISTER) {
+        // Register addressing can't be bounded statically
+        size.reset();
+        return;
+    }
+    size = std::max(*size, offset + bytes);
+}
+
+static void touch_attributes(resource_usage& usage, const opcode& op, bool is_store)
+{
+    std::bitset<NUM_ATTRIBUTE_WORDS>& map = is_store ? usage.outputs : usage.inputs;
+    const int words = static_cast<int>(field(op, 47, 2)) + 1;
+    const bool is_indexed = field(op, 8, 8) != ZERO_REGISTER;
+    if (field(op, 31, 1)) {
+        // Patch attributes are only counted, they don't have a map
+        int size = MAX_PATCH_ATTRIBUTES_SIZE;
+        if (!is_indexed) {
+            size = static_cast<int>(field(op, 20, 10)) + words * 4;
+        }
+        if (is_store) {
+            usage.patch_attributes_size = std::max(usage.patch_attributes_size, size);
+        }
+        return;
+    }
+    if (is_indexed) {
+        for (int address = GENERIC_ATTRIBUTES_BEGIN; address < GENERIC_ATTRIBUTES_END;
+             address += 4) {
+            map.set(address / 4);
+        }
+        return;
+    }
+    const int first = static_cast<int>(field(op, 20, 10)) / 4;
+    for (int index = first; index < std::min(first + words, NUM_ATTRIBUTE_WORDS); ++index) {
+        map.set(index);
+    }
+}
+
+static bool is_fp64(const opcode& op)
+{
+    const std::string_view mnemonic = op.info->mnemonic;
+    if (is_any(mnemonic, {"DADD", "DFMA", "DMNMX", "DMUL", "DSET", "DSETP"})) {
+        return true;
+    }
+    // Conversions encode their destination size at bit 8 and their source size at bit 10
+    const bool is_dest_double = field(op, 8, 2) == 3;
+    const bool is_source_double = field(op, 10, 2) == 3;
+    if (mnemonic == "F2F") {
+        return is_dest_double || is_source_double;
+    }
+    return (mnemonic == "F2I" && is_source_double) || (mnemonic == "I2F" && is_dest_double);
+}
+
+class crs_analysis
+{
+  public:
+    explicit crs_analysis(std::span<const opcode> opcodes_) : opcodes{opcodes_}
+    {
+        // Each SSY, PBK and PCNT pushes an entry that is popped once its target is reached
+        std::vector<int> delta(opcodes.size() + 1);
+        for (size_t index = 0; index < opcodes.size(); ++index) {
+            if (!is_any(opcodes[index].info->mnemonic, {"SSY", "PBK", "PCNT"})) {
+                continue;
+            }
+            const std::optional target = branch_target(opcodes, index);
+            if (target && *target > index) {
+                ++delta[index + 1];
+                --delta[*target];
+            }
+        }
+        depth.resize(opcodes.size());
+        int current = 0;
+        for (size_t index = 0; index < opcodes.size(); ++index) {
+            current += delta[index];
+            depth[index] = current;
+        }
+    }
+
+    std::optional<int> max_entries()
+    {
+        return entries(0, opcodes.size());
+    }
+
+  private:
+    enum class state
+    {
+        unvisited,
+        visiting,
+        unbounded,
+        done,
+    };
+
+    // Entries needed by the instructions in [begin, end)
+    std::optional<int> entries(size_t begin, size_t end)
+    {
+        int result = 0;
+        for (size_t index = begin; index < end; ++index) {
+            int needed = depth[index];
+            if (std::string_view{opcodes[index].info->mnemonic} == "CAL") {
+                const std::optional target = branch_target(opcodes, index);
+                if (!target) {
+                    return {};
+                }
+                const std::optional callee = function_entries(*target);
+                if (!callee) {
+                    return {};
+                }
+                needed += 1 + *callee;
+            }
+            result = std::max(result, needed);
+        }
+        return result;
+    }
+
+    // Entries needed by a function, assumed to run until its first RET
+    std::optional<int> function_entries(size_t entry)
+    {
+        if (states.empty()) {
+            states.resize(opcodes.size(), state::unvisited);
+            results.resize(opcodes.size());
+        }
+        switch (states[entry]) {
+        case state::visiting:
+        case state::unbounded:
+            // Recursion can't be bounded
+            return {};
+        case state::done:
+            return results[entry];
+        case state::unvisited:
+            break;
+        }
+        states[entry] = state::visiting;
+
+        size_t end = entry;
+        while (end < opcodes.size() && std::string_view{opcodes[end].info->mnemonic} != "RET") {
+            ++end;
+        }
+        const std::optional result = entries(entry, std::min(end + 1, opcodes.size()));
+        if (!result) {
+            states[entry] = state::unbounded;
+            return {};
+        }
+        // Stack entries of the caller are already counted at the call site
+        const int base = depth[entry];
+        states[entry] = state::done;
+        results[entry] = std::max(*result - base, 0);
+        return results[entry];
+    }
+
+    std::span<const opcode> opcodes;
+    std::vector<int> depth;
+    std::vector<state> states;
+    std::vector<int> results;
+};
+
+static std::optional<int> crs_size(std::span<const opcode> opcodes)
+{
+    const std::optional entries = crs_analysis(opcodes).max_entries();
+    return entries ? std::optional(*entries * CRS_ENTRY_SIZE) : std::nullopt;
+}
+
+resource_usage analyze_resources(std::span<const opcode> opcodes)
+{
+    resource_usage usage;
+    usage.local_mem_size = 0;
+    usage.shared_mem_size = 0;
+
+    int highest = -1;
+    for (const opcode& op : opcodes) {
+        highest = std::max(highest, highest_gpr(op));
+
+        const std::string_view mnemonic = op.info->mnemonic;
+        if (is_any(mnemonic, {"LDL", "STL"})) {
+            touch_memory(usage.local_mem_size, op, static_cast<int>(field(op, 20, 24)),
+                         memory_size_bytes(field(op, 48, 3)));
+        } else if (is_any(mnemonic, {"LDS", "STS"})) {
+            touch_memory(usage.shared_mem_size, op, static_cast<int>(field(op, 20, 24)),
+                         memory_size_bytes(field(op, 48, 3)));
+        } else if (mnemonic == "ATOMS") {
+            touch_memory(usage.shared_mem_size, op, static_cast<int>(field(op, 30, 22) << 2),
+                         field(op, 28, 2) >= 2 ? 8 : 4);
+        } else if (is_any(mnemonic, {"ALD", "AST"})) {
+            touch_attributes(usage, op, mnemonic == "AST");
+        } else if (mnemonic == "KIL") {
+            usage.kills = true;
+        } else if (mnemonic == "BAR") {
+            // Barrier indices are immediate when bit 43 is set
+            const int barriers = field(op, 43, 1) ? static_cast<int>(field(op, 8, 8)) + 1
+                                                  : MAX_BARRIERS;
+            usage.num_barriers = std::max(usage.num_barriers, barriers);
+        }
+        if (is_any(mnemonic, {"STG", "ST", "RED", "ATOM", "SUST", "SURED", "SUATOM"})) {
+            usage.does_global_store = true;
+            usage.does_load_or_store = true;
+        } else if (is_any(mnemonic, {"LDG", "LD", "SULD"})) {
+            usage.does_load_or_store = true;
+        }
+        usage.does_fp64 |= is_fp64(op);
+    }
+    usage.num_gprs = std::max(highest + 1, MIN_GPRS);
+
+    usage.crs_size = crs_size(opcodes);
+    return usage;
+}
+
+std::optional<int> analyze_crs_size(std::span<const uint64_t> code)
+{
+    // Only instructions that move the stack are told apart, the others stand as a NOP
+    static const std::vector<size_t> entries = [] {
+        std::vector<size_t> result;
+        for (size_t index = 0; index < std::size(table); ++index) {
+            if (is_any(table[index].mnemonic, {"SSY", "PBK", "PCNT", "CAL", "RET"})) {
+                result.push_back(index);
+            }
+        }
+        return result;
+    }();
+    const insn* const other = &*std::ranges::find_if(
+        table, [](const insn& entry) { return std::string_view{entry.mnemonic} == "NOP"; });
+
+    std::vector<opcode> opcodes;
+    opcodes.reserve(code.size());
+    for (size_t word = 0; word < code.size(); ++word) {
+        if (word % 4 == 0) {
+            continue;
+        }
+        opcode& op = opcodes.emplace_back();
+        op.value = code[word];
+        op.info = other;
+        for (const size_t entry : entries) {
+            const uint64_t fixed = ~operand_fields(entry) & ~PREDICATE_MASK;
+            if (((op.value ^ table[entry].opcode) & fixed) == 0) {
+                op.info = &table[entry];
+                break;
+            }
+        }
+    }
+    return crs_size(opcodes);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+struct opcode;
+
+// Attribute memory is tracked in 32-bit words
+constexpr int NUM_ATTRIBUTE_WORDS = 256;
+
+struct resource_usage
+{
+    // Number of general purpose registers needed by the program
+    int num_gprs = 0;
+
+    // Bytes of memory touched, empty when it is addressed with registers
+    std::optional<int> local_mem_size;
+    std::optional<int> shared_mem_size;
+
+    // Bytes of call, return and sync stack needed, empty when it can't be bounded
+    std::optional<int> crs_size;
+
+    int num_barriers = 0;
+
+    // Attribute words read with ALD and written with AST, all generic attributes when indexed
+    std::bitset<NUM_ATTRIBUTE_WORDS> inputs;
+    std::bitset<NUM_ATTRIBUTE_WORDS> outputs;
+
+    // Bytes of per patch attributes written with AST.P
+    int patch_attributes_size = 0;
+
+    bool kills = false;
+    bool does_global_store = false;
+    bool does_load_or_store = false;
+    bool does_fp64 = false;
+};
+
+// Number of consecutive registers accessed by the register operand encoded at the given address
+int gpr_width(const opcode& op, int address);
+
+resource_usage analyze_resources(std::span<const opcode> opcodes);
+
+// Bytes of call, return and sync stack needed by bundled code, empty when it can't be bounded.
+// Objects are analyzed apart, calls between them are only seen once they are linked.
+std::optional<int> analyze_crs_size(std::span<const uint64_t> code);
@@ -0,0 +1,442 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "error.h"
+#include "nxas.h"
+#include "server.h"
+
+// Requests larger than this are taken as a broken stream rather than a program
+constexpr uint32_t MAX_REQUEST_SIZE = uint32_t{256} << 20;
+
+// Fields of a request before its filename
+constexpr uint32_t REQUEST_HEADER_SIZE = 16;
+
+constexpr uint32_t OPTIMIZE_FLAG = 1;
+
+// Readers wait once this many requests per worker are queued, so clients can't exhaust memory
+constexpr size_t QUEUED_REQUESTS_PER_WORKER = 4;
+
+// Time to wait before accepting again when connections can't be accepted, e.g. out of descriptors
+constexpr auto ACCEPT_RETRY_DELAY = std::chrono::milliseconds{100};
+
+// Stream requests are read from, answers of many workers are written whole under its lock
+struct connection
+{
+    int in_fd;
+    int out_fd;
+    bool is_socket;
+    std::mutex write_mutex;
+
+    // Set by the thread reading the connection once it's done with it
+    std::atomic<bool> is_read{false};
+
+    ~connection()
+    {
+#ifndef _WIN32
+        if (is_socket) {
+            close(in_fd);
+        }
+#endif
+    }
+};
+
+struct request
+{
+    std::shared_ptr<connection> source;
+    uint32_t id = 0;
+    nxas::options options;
+    std::string filename;
+    std::string code;
+};
+
+struct diagnostic
+{
+    uint32_t severity = 0;
+    uint32_t line = 0;
+    uint32_t column = 0;
+    std::string message;
+};
+
+class request_queue
+{
+  public:
+    explicit request_queue(size_t capacity_) : capacity{capacity_} {}
+
+    // Waits for room in the queue
+    void push(request&& request)
+    {
+        {
+            std::unique_lock lock{mutex};
+            not_full.wait(lock, [this] { return requests.size() < capacity; });
+            requests.push_back(std::move(request));
+        }
+        not_empty.notify_one();
+    }
+
+    // Waits for a request, empty once the queue is closed and drained
+    std::optional<request> pop()
+    {
+        std::optional<request> result;
+        {
+            std::unique_lock lock{mutex};
+            not_empty.wait(lock, [this] { return is_closed || !requests.empty(); });
+            if (requests.empty()) {
+                return std::nullopt;
+            }
+            result = std::move(requests.front());
+            requests.pop_front();
+        }
+        not_full.notify_one();
+        return result;
+    }
+
+    void close()
+    {
+        {
+            const std::scoped_lock lock{mutex};
+            is_closed = true;
+        }
+        not_empty.notify_all();
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<request> requests;
+    size_t capacity;
+    bool is_closed = false;
+};
+
+#ifndef _WIN32
+
+// Written to by the signal handler and never drained, so every thread waiting for input wakes up
+// and the server shuts down
+static int stop_pipe[2] = {-1, -1};
+
+static void request_stop(int)
+{
+    const char byte = 0;
+    static_cast<void>(write(stop_pipe[1], &byte, 1));
+}
+
+// Waits until a descriptor can be read, returns false once the server is stopping
+static bool wait_for_input(int fd)
+{
+    pollfd fds[]{{.fd = fd, .events = POLLIN, .revents = 0},
+                 {.fd = stop_pipe[0], .events = POLLIN, .revents = 0}};
+    while (poll(fds, std::size(fds), -1) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return fds[1].revents == 0;
+}
+
+#endif
+
+// Returns false when the stream ends or fails before size bytes are read
+static bool read_exactly(int fd, void* data, size_t size)
+{
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        const int result = _read(fd, bytes, static_cast<unsigned>(size));
+#else
+        if (!wait_for_input(fd)) {
+            return false;
+        }
+        const ssize_t result = read(fd, bytes, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (result <= 0) {
+            return false;
+        }
+        bytes += result;
+        size -= static_cast<size_t>(result);
+    }
+    return true;
+}
+
+// Answers to clients that went away are dropped
+static void write_answer(connection& destination, const std::string& answer)
+{
+    const std::scoped_lock lock{destination.write_mutex};
+    const char* data = answer.data();
+    size_t size = answer.size();
+    while (size > 0) {
+#ifdef _WIN32
+        const int result = _write(destination.out_fd, data, static_cast<unsigned>(size));
+#else
+        const ssize_t result = destination.is_socket
+                                   ? send(destination.out_fd, data, size, MSG_NOSIGNAL)
+                                   : write(destination.out_fd, data, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (result <= 0) {
+            return;
+        }
+        data += result;
+        size -= static_cast<size_t>(result);
+    }
+}
+
+static uint32_t read_u32(const char* data)
+{
+    uint32_t value = 0;
+    for (int byte = 3; byte >= 0; --byte) {
+        value = (value << 8) | static_cast<uint8_t>(data[byte]);
+    }
+    return value;
+}
+
+static void append_u32(std::string& output, uint32_t value)
+{
+    for (int byte = 0; byte < 4; ++byte) {
+        output += static_cast<char>((value >> (byte * 8)) & 0xFF);
+    }
+}
+
+static void append_u64(std::string& output, uint64_t value)
+{
+    append_u32(output, static_cast<uint32_t>(value));
+    append_u32(output, static_cast<uint32_t>(value >> 32));
+}
+
+static std::string assemble_request(const request& request)
+{
+    std::vector<std::string> warnings;
+    std::vector<uint64_t> binary;
+    std::optional<diagnostic> error;
+    set_warning_sink(&warnings);
+    try {
+        binary = nxas::assemble(request.code, request.filename.c_str(), request.options);
+    } catch (const nxas::assembly_error& exception) {
+        error = diagnostic{.line = static_cast<uint32_t>(exception.line),
+                           .column = static_cast<uint32_t>(exception.column),
+                           .message = exception.message};
+    } catch (const std::exception& exception) {
+        // Failures outside the assembler's diagnostics, like running out of memory, fail the
+        // request instead of the server
+        error = diagnostic{.message = std::string{"internal error: "} + exception.what()};
+    }
+    set_warning_sink(nullptr);
+
+    std::vector<diagnostic> diagnostics;
+    for (const std::string& warning : warnings) {
+        diagnostics.push_back({.severity = 1, .message = strip_colors(warning)});
+    }
+    if (error) {
+        diagnostics.push_back(std::move(*error));
+    }
+
+    std::string body;
+    append_u32(body, request.id);
+    append_u32(body, error ? 1 : 0);
+    append_u32(body, static_cast<uint32_t>(binary.size()));
+    for (const uint64_t word : binary) {
+        append_u64(body, word);
+    }
+    append_u32(body, static_cast<uint32_t>(diagnostics.size()));
+    for (const diagnostic& diagnostic : diagnostics) {
+        append_u32(body, diagnostic.severity);
+        append_u32(body, diagnostic.line);
+        append_u32(body, diagnostic.column);
+        append_u32(body, static_cast<uint32_t>(diagnostic.message.size()));
+        body += diagnostic.message;
+    }
+    std::string answer;
+    append_u32(answer, static_cast<uint32_t>(body.size()));
+    return answer + body;
+}
+
+// Queues the requests of a connection until it ends, returns false when the stream is broken
+static bool read_requests(const std::shared_ptr<connection>& source, request_queue& queue)
+{
+    for (;;) {
+        char size_field[4];
+        if (!read_exactly(source->in_fd, size_field, sizeof(size_field))) {
+            return true;
+        }
+        const uint32_t size = read_u32(size_field);
+        if (size < REQUEST_HEADER_SIZE || size > MAX_REQUEST_SIZE) {
+            std::fprintf(stderr, "request of %u bytes is malformed\n", size);
+            return false;
+        }
+        std::string data(size, '\0');
+        if (!read_exactly(source->in_fd, data.data(), data.size())) {
+            std::fprintf(stderr, "request ended after its size\n");
+            return false;
+        }
+        const uint32_t filename_size = read_u32(data.data() + 12);
+        if (filename_size > size - REQUEST_HEADER_SIZE) {
+            std::fprintf(stderr, "filename of %u bytes overflows its request\n", filename_size);
+            return false;
+        }
+        request request{
+            .source = source,
+            .id = read_u32(data.data()),
+            .options = {},
+            .filename = data.substr(REQUEST_HEADER_SIZE, filename_size),
+            .code = data.substr(REQUEST_HEADER_SIZE + filename_size),
+        };
+        request.options.optimize = (read_u32(data.data() + 4) & OPTIMIZE_FLAG) != 0;
+        request.options.yield_interval = static_cast<int>(read_u32(data.data() + 8));
+        queue.push(std::move(request));
+    }
+}
+
+#ifndef _WIN32
+
+// Listens before workers start, so failing to listen exits without threads to join
+static int listen_socket(const char* socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (std::strlen(socket_path) >= sizeof(address.sun_path)) {
+        fatal_error("%s: socket path is too long", socket_path);
+    }
+    std::strcpy(address.sun_path, socket_path);
+
+    // A socket left by a server that didn't exit cleanly is replaced, other files are kept
+    struct stat status;
+    if (lstat(socket_path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(socket_path);
+    }
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    const auto* const socket_address = reinterpret_cast<const sockaddr*>(&address);
+    if (listener < 0 || bind(listener, socket_address, sizeof(address)) < 0 ||
+        listen(listener, SOMAXCONN) < 0) {
+        fatal_error("%s: failed to listen: %s", socket_path, std::strerror(errno));
+    }
+    return listener;
+}
+
+// Connections that can't be accepted or served are dropped, the server keeps running until it's
+// stopped and then waits for the connections to be read
+static bool serve_socket(const char* socket_path, int listener, request_queue& queue)
+{
+    std::vector<std::pair<std::shared_ptr<connection>, std::thread>> readers;
+    while (wait_for_input(listener)) {
+        const int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                std::fprintf(stderr, "%s: failed to accept: %s\n", socket_path,
+                             std::strerror(errno));
+                std::this_thread::sleep_for(ACCEPT_RETRY_DELAY);
+            }
+            continue;
+        }
+        // Threads of connections that ended are joined as new ones arrive
+        std::erase_if(readers, [](auto& reader) {
+            if (!reader.first->is_read) {
+                return false;
+            }
+            reader.second.join();
+            return true;
+        });
+        auto source = std::make_shared<connection>(fd, fd, true);
+        try {
+            readers.emplace_back(source, std::thread([source, &queue] {
+                                     read_requests(source, queue);
+                                     source->is_read = true;
+                                 }));
+        } catch (const std::system_error& error) {
+            std::fprintf(stderr, "%s: failed to serve a connection: %s\n", socket_path,
+                         error.what());
+        }
+    }
+    for (auto& [source, thread] : readers) {
+        thread.join();
+    }
+    close(listener);
+    unlink(socket_path);
+    return true;
+}
+
+#endif
+
+int run_server(const char* socket_path, unsigned num_workers)
+{
+#ifdef _WIN32
+    if (socket_path) {
+        fatal_error("Unix domain sockets are not supported on this platform");
+    }
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#else
+    // Clients that go away are noticed by failed writes
+    std::signal(SIGPIPE, SIG_IGN);
+    // Signals never block on a full pipe, one byte in it is enough to stop
+    if (pipe(stop_pipe) != 0 || fcntl(stop_pipe[1], F_SETFL, O_NONBLOCK) != 0) {
+        fatal_error("failed to create a pipe: %s", std::strerror(errno));
+    }
+    struct sigaction action{};
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+#endif
+#ifndef _WIN32
+    const int listener = socket_path ? listen_socket(socket_path) : -1;
+#endif
+    // Build the tables before the first request arrives
+    static_cast<void>(nxas::assemble("EXIT;\n", "warm-up"));
+
+    request_queue queue(num_workers * QUEUED_REQUESTS_PER_WORKER);
+    std::vector<std::thread> workers;
+    for (unsigned index = 0; index < num_workers; ++index) {
+        workers.emplace_back([&queue] {
+            while (std::optional<request> request = queue.pop()) {
+                write_answer(*request->source, assemble_request(*request));
+            }
+        });
+    }
+    const auto read_stdin = [&queue] {
+        return read_requests(std::make_shared<connection>(0, 1, false), queue);
+    };
+#ifdef _WIN32
+    const bool is_intact = read_stdin();
+#else
+    const bool is_intact = socket_path ? serve_socket(socket_path, listener, queue) : read_stdin();
+#endif
+    // Requests read before the server stopped are still answered
+    queue.close();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return is_intact ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Keeps an assembler running and answers requests to assemble programs, read from stdin and
+// answered on stdout, or from every connection to a Unix domain socket when a path is given.
+// Requests are assembled by a pool of workers and answers can be sent out of order. The server
+// shuts down at the end of stdin, or on SIGINT or SIGTERM, once the requests it read are answered.
+//
+// Integers are little endian. A request is:
+//   u32 size            bytes of the request after this field
+//   u32 id              sent back with the answer
+//   u32 flags           bit 0 optimizes the program
+//   u32 yield_interval  zero places no yield hints
+//   u32 filename size   followed by the filename diagnostics name
+//   source              rest of the request
+//
+// An answer is:
+//   u32 size            bytes of the answer after this field
+//   u32 id
+//   u32 status          0 when the program assembled, 1 when it failed
+//   u32 num_words       followed by the 64-bit words of the binary
+//   u32 num_diagnostics followed by each diagnostic:
+//     u32 severity      0 for errors, 1 for warnings
+//     u32 line          starting at one, zero when the diagnostic has no position
+//     u32 column
+//     u32 message size  followed by the message without terminal colors
+int run_server(const char* socket_path, unsigned num_workers);
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "assemble.h"
+#include "context.h"
+#include "error.h"
+#include "flow.h"
+#include "nxas.h"
+#include "opcode.h"
+#include "parse.h"
+#include "regalloc.h"
+#include "time_report.h"
+
+// Offset of the line the given number of lines after the one starting at offset
+static size_t skip_lines(std::string_view code, size_t offset, int num_lines)
+{
+    for (; num_lines > 0 && offset < code.size(); --num_lines) {
+        const size_t new_line = code.find('\n', offset);
+        offset = new_line == std::string_view::npos ? code.size() : new_line + 1;
+    }
+    return offset;
+}
+
+static bool is_blank(std::string_view text)
+{
+    return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+// Options change the program as a whole, they can't be parsed again on their own
+static bool sets_options(std::string_view text)
+{
+    for (size_t index = 0; index < text.size(); ++index) {
+        if (text[index] == '.' && (index == 0 || std::string_view{" \t\r\n;"}.find(
+                                                     text[index - 1]) != std::string_view::npos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Labels are identifiers followed by a colon at the beginning of a line
+static bool defines_labels(std::string_view text, bool is_line_start)
+{
+    for (size_t index = 0; index < text.size(); ++index) {
+        const bool starts_line = index == 0 ? is_line_start : text[index - 1] == '\n';
+        if (!starts_line || !std::isalpha(static_cast<unsigned char>(text[index]))) {
+            continue;
+        }
+        size_t end = index;
+        while (end < text.size() &&
+               (std::isalnum(static_cast<unsigned char>(text[end])) || text[end] == '_')) {
+            ++end;
+        }
+        if (end < text.size() && text[end] == ':') {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace nxas {
+
+struct session::state
+{
+    // Encodes again the instructions touched by an edit already applied to the code, returns
+    // false when the layout of the program changed and it has to be assembled from scratch
+    bool reencode(size_t begin, size_t end, size_t text_size, int line_delta);
+
+    void assemble_all();
+
+    void finish();
+
+    std::string filename;
+    std::string code;
+    nxas::options options;
+    std::optional<context> ctx;
+    parsed_program program;
+    std::vector<uint64_t> binary;
+    size_t encoded_instructions = 0;
+};
+
+bool session::state::reencode(size_t begin, size_t end, size_t text_size, int line_delta)
+{
+    // Virtual registers are allocated and instructions are removed looking at the whole program
+    if (program.has_virtual_gprs || options.optimize) {
+        return false;
+    }
+    std::vector<instruction_span>& spans = program.spans;
+    const size_t num_instructions = spans.size();
+    const size_t first =
+        std::ranges::upper_bound(spans, begin, {}, &instruction_span::end) - spans.begin();
+    if (first == num_instructions) {
+        // Text after the last instruction
+        const bool adds_instructions =
+            std::string_view{code}.substr(begin, text_size).find(';') != std::string_view::npos;
+        encoded_instructions = 0;
+        return !adds_instructions;
+    }
+    const size_t after = std::max<size_t>(
+        std::ranges::lower_bound(spans, end, {}, &instruction_span::begin) - spans.begin(),
+        first + 1);
+
+    // Text of the affected instructions, the edit moves the end of it
+    const size_t region_begin = spans[first].begin;
+    const size_t region_end = std::max(end, spans[after - 1].end) + text_size - (end - begin);
+    const std::string_view text{code};
+    const std::string_view prefix = text.substr(region_begin, begin - region_begin);
+    const std::string_view suffix =
+        text.substr(begin + text_size, region_end - (begin + text_size));
+    const bool is_suffix_line_start = begin + text_size > 0 && text[begin + text_size - 1] == '\n';
+    if (sets_options(prefix) || sets_options(suffix) ||
+        defines_labels(suffix, is_suffix_line_start)) {
+        return false;
+    }
+
+    // Labels before the first instruction keep naming it, move the ones after the edit
+    const size_t num_old = after - first;
+    const size_t num_new = static_cast<size_t>(
+        std::ranges::count(text.substr(region_begin, region_end - region_begin), ';'));
+    const auto relocate = [first, after, num_old, num_new](size_t index) {
+        if (index < first) {
+            return index;
+        }
+        return index < after ? first : index - num_old + num_new;
+    };
+    if (num_new != num_old) {
+        std::vector<size_t> new_indices(num_instructions + 1);
+        for (size_t index = 0; index < new_indices.size(); ++index) {
+            new_indices[index] = relocate(index);
+        }
+        ctx->relocate_labels(new_indices);
+    }
+
+    std::vector<virtual_gpr> virtual_gprs;
+    ctx->virtual_gprs = &virtual_gprs;
+    ctx->seek(code.c_str(), region_begin, spans[first].line, instruction_address(first));
+    std::vector<opcode> opcodes(num_new);
+    std::vector<instruction_span> new_spans;
+    new_spans.reserve(num_new);
+    bool is_parsed = true;
+    {
+        TIME_PHASE(parse);
+        for (size_t index = 0; index < num_new && is_parsed; ++index) {
+            instruction_span span{.begin = ctx->offset(), .end = 0, .line = ctx->current_line()};
+            is_parsed = parse_instruction(*ctx, opcodes[index]);
+            ctx->skip_line_end();
+            span.end = ctx->offset();
+            new_spans.push_back(span);
+        }
+    }
+    ctx->virtual_gprs = nullptr;
+    if (!is_parsed || !virtual_gprs.empty() ||
+        !is_blank(text.substr(ctx->offset(), region_end - ctx->offset()))) {
+        return false;
+    }
+
+    // Fix up the label operands of the instructions that were moved or point past the edit
+    if (num_new != num_old) {
+        for (size_t index = 0; index < num_instructions; ++index) {
+            opcode& op = program.opcodes[index];
+            if ((index >= first && index < after) || !has_label(op)) {
+                continue;
+            }
+            int64_t target = label_target(op.value, instruction_address(index));
+            if (const std::optional target_index = instruction_index(target)) {
+                target = instruction_address(relocate(*target_index));
+            }
+            op.value = set_label_target(op.value, instruction_address(relocate(index)), target);
+        }
+    }
+    const ptrdiff_t offset_delta = static_cast<ptrdiff_t>(text_size - (end - begin));
+    for (size_t index = after; index < num_instructions; ++index) {
+        spans[index].begin += offset_delta;
+        spans[index].end += offset_delta;
+        spans[index].line += line_delta;
+    }
+    // Blanks left at the end of the edit go with the instruction before them, or the next one
+    if (!new_spans.empty()) {
+        new_spans.back().end = region_end;
+    } else if (after < num_instructions) {
+        spans[after].begin = region_begin;
+        spans[after].line = spans[first].line;
+    }
+    program.opcodes.erase(program.opcodes.begin() + first, program.opcodes.begin() + after);
+    program.opcodes.insert(program.opcodes.begin() + first, opcodes.begin(), opcodes.end());
+    spans.erase(spans.begin() + first, spans.begin() + after);
+    spans.insert(spans.begin() + first, new_spans.begin(), new_spans.end());
+
+    encoded_instructions = num_new;
+    return true;
+}
+
+void session::state::assemble_all()
+{
+    ctx.emplace(filename.c_str(), code.c_str());
+    program = parse_program(*ctx, code);
+    encoded_instructions = program.opcodes.size();
+}
+
+void session::state::finish()
+{
+    const encoded_program encoded = finish_program(*ctx, program.opcodes, options, nullptr);
+    binary = ctx->binary(bundle(encoded.opcodes), encoded.usage, nullptr);
+}
+
+session::session(std::string code, std::string filename, const nxas::options& options)
+    : impl{std::make_unique<state>()}
+{
+    impl->filename = std::move(filename);
+    impl->code = std::move(code);
+    impl->options = options;
+    impl->assemble_all();
+    impl->finish();
+}
+
+session::~session() = default;
+
+void session::edit(int line, int num_lines, std::string_view text)
+{
+    if (line < 0 || num_lines < 0) {
+        fatal_error("edits can't start at or span a negative number of lines");
+    }
+    state& state = *impl;
+    const size_t begin = skip_lines(state.code, 0, line);
+    const size_t end = skip_lines(state.code, begin, num_lines);
+    const std::string_view replaced = std::string_view{state.code}.substr(begin, end - begin);
+
+    // Edits defining labels or options change the layout of the whole program
+    const bool keeps_layout = !sets_options(replaced) && !sets_options(text) &&
+                              !defines_labels(replaced, true) && !defines_labels(text, true);
+    const int line_delta = static_cast<int>(std::ranges::count(text, '\n') -
+                                            std::ranges::count(replaced, '\n'));
+    state.code.replace(begin, end - begin, text);
+
+    if (!keeps_layout || !state.reencode(begin, end, text.size(), line_delta)) {
+        state.assemble_all();
+    }
+    state.finish();
+}
+
+const std::string& session::code() const
+{
+    return impl->code;
+}
+
+const std::vector<uint64_t>& session::binary() const
+{
+    return impl->binary;
+}
+
+size_t session::encoded_instructions() const
+{
+    return impl->encoded_instructions;
+}
+
+} // namespace nxas
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "time_report.h"
+
+#ifdef NXAS_TIME_REPORT
+
+using report_clock = std::chrono::steady_clock;
+
+static const char* const phase_names[]{
+    "label pre-scan", "lexing and matching", "control word packing", "output writing", "other",
+};
+static_assert(std::size(phase_names) == NUM_TIME_PHASES + 1);
+
+// Times of every thread, the mutex is only taken when a thread registers and when printing
+static std::mutex threads_mutex;
+static std::vector<std::unique_ptr<thread_times>> threads;
+
+thread_times& register_thread_times()
+{
+    const std::scoped_lock lock{threads_mutex};
+    return *threads.emplace_back(std::make_unique<thread_times>());
+}
+
+// Charges the time since the last switch to the running phase and switches to another one
+static void switch_phase(int phase)
+{
+    thread_times& times = local_times();
+    const report_clock::time_point now = report_clock::now();
+    times.phase_times[times.current_phase] += now - times.phase_start;
+    times.phase_start = now;
+    times.current_phase = phase;
+}
+
+phase_timer::phase_timer(time_phase phase) : parent{local_times().current_phase}
+{
+    switch_phase(static_cast<int>(phase));
+}
+
+phase_timer::~phase_timer()
+{
+    switch_phase(parent);
+}
+
+void print_time_report(std::FILE* file)
+{
+    switch_phase(local_times().current_phase);
+
+    report_clock::duration phase_times[NUM_TIME_PHASES + 1]{};
+    uint64_t counters[NUM_TIME_COUNTERS]{};
+    {
+        const std::scoped_lock lock{threads_mutex};
+        for (const std::unique_ptr<thread_times>& thread : threads) {
+            for (int phase = 0; phase <= NUM_TIME_PHASES; ++phase) {
+                phase_times[phase] += thread->phase_times[phase];
+            }
+            for (int counter = 0; counter < NUM_TIME_COUNTERS; ++counter) {
+                counters[counter] += thread->counters[counter];
+            }
+        }
+    }
+    report_clock::duration total{};
+    for (const report_clock::duration time : phase_times) {
+        total += time;
+    }
+    const auto milliseconds = [](report_clock::duration time) {
+        return std::chrono::duration<double, std::milli>(time).count();
+    };
+    std::fprintf(file, "time report:\n");
+    for (int phase = 0; phase <= NUM_TIME_PHASES; ++phase) {
+        const double time = milliseconds(phase_times[phase]);
+        std::fprintf(file, "  %-22s %10.3f ms %6.1f%%\n", phase_names[phase], time,
+                     total.count() > 0 ? time * 100 / milliseconds(total) : 0.0);
+    }
+    std::fprintf(file, "  %-22s %10.3f ms\n", "total", milliseconds(total));
+
+    const auto counter = [&counters](time_counter counter) {
+        return static_cast<unsigned long long>(counters[static_cast<int>(counter)]);
+    };
+    std::fprintf(file, "  %-22s %10llu\n", "tokens lexed", counter(time_counter::tokens));
+    std::fprintf(file, "  %-22s %10llu\n", "candidates tried", counter(time_counter::candidates));
+    std::fprintf(file, "  %-22s %10llu\n", "failed candidates",
+                 counter(time_counter::failed_candidates));
+}
+
+#else
+
+void print_time_report(std::FILE* file)
+{
+    std::fprintf(file, "time report: nxas was built without NXAS_TIME_REPORT\n");
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// Phases of the assembler timed for --time-report, a phase doesn't count the time of the phases
+// started inside it. Phases are timed around whole passes, lexing is interleaved with parsing and
+// only its tokens are counted.
+enum class time_phase
+{
+    labels,
+    parse,
+    bundle,
+    binary,
+};
+
+enum class time_counter
+{
+    tokens,
+    candidates,
+    failed_candidates,
+};
+
+constexpr int NUM_TIME_PHASES = 4;
+constexpr int NUM_TIME_COUNTERS = 3;
+
+#ifdef NXAS_TIME_REPORT
+
+constexpr bool has_time_report = true;
+
+// Times and counters of a single thread, only the thread updates them so timing takes no locks
+struct thread_times
+{
+    // Time outside of every phase is kept in the last slot
+    std::chrono::steady_clock::duration phase_times[NUM_TIME_PHASES + 1]{};
+    std::chrono::steady_clock::time_point phase_start = std::chrono::steady_clock::now();
+    int current_phase = NUM_TIME_PHASES;
+    uint64_t counters[NUM_TIME_COUNTERS]{};
+};
+
+// Times of a thread are registered when it first uses them and outlive it, the report merges the
+// times of every thread
+thread_times& register_thread_times();
+
+inline thread_local thread_times* current_thread_times = nullptr;
+
+inline thread_times& local_times()
+{
+    if (!current_thread_times) {
+        current_thread_times = &register_thread_times();
+    }
+    return *current_thread_times;
+}
+
+class phase_timer
+{
+  public:
+    explicit phase_timer(time_phase phase);
+    ~phase_timer();
+
+    phase_timer(const phase_timer&) = delete;
+    phase_timer& operator=(const phase_timer&) = delete;
+
+  private:
+    int parent;
+};
+
+#define TIME_PHASE(phase) const phase_timer scoped_phase_timer(time_phase::phase)
+#define COUNT_EVENT(counter) ++local_times().counters[static_cast<int>(time_counter::counter)]
+
+#else
+
+// Instrumentation compiles to nothing unless NXAS_TIME_REPORT is defined
+constexpr bool has_time_report = false;
+
+#define TIME_PHASE(phase) static_cast<void>(0)
+#define COUNT_EVENT(counter) static_cast<void>(0)
+
+#endif
+
+// Prints the time of each phase and the counters collected since the program started, added up
+// over every thread. Threads still assembling must be done before it's called.
+void print_time_report(std::FILE* file);
@@ -1,7 +1,52 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string_view>
 
 #include "token.h"
 
+template <typename T>
+static T read_bytes(const std::vector<uint8_t>& bytes, size_t& offset)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+token packed_tokens::unpack(size_t& offset) const
+{
+    token result{};
+    if (offset == bytes.size()) {
+        result.type = token_type::none;
+        return result;
+    }
+    result.type = static_cast<token_type>(bytes[offset++]);
+    switch (result.type) {
+    case token_type::identifier:
+    case token_type::virtual_register:
+        result.data.string = names[read_bytes<uint32_t>(bytes, offset)];
+        break;
+    case token_type::regster:
+        result.data.regster = bytes[offset++];
+        break;
+    case token_type::predicate: {
+        const uint8_t value = bytes[offset++];
+        result.data.predicate = {.index = value & 7, .negated = value >> 3};
+        break;
+    }
+    case token_type::immediate:
+        result.data.immediate = read_bytes<int64_t>(bytes, offset);
+        break;
+    case token_type::float_immediate:
+        result.data.float_immediate = read_bytes<double>(bytes, offset);
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
 const char* name(token_type type)
 {
     switch (type) {
@@ -13,6 +58,8 @@ const char* name(token_type type)
         return "identifier";
     case token_type::regster:
         return "register";
+    case token_type::virtual_register:
+        return "virtual register";
     case token_type::predicate:
         return "predicate";
     case token_type::immediate:
@@ -42,7 +89,7 @@ const char* name(token_type type)
 
 std::string_view info(const token& token)
 {
-    if (token.type != token_type::identifier) {
+    if (token.type != token_type::identifier && token.type != token_type::virtual_register) {
         return {};
     }
     return token.data.string;
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string_view>
+#include <vector>
 
 enum class token_type
 {
     none,
     identifier,
     regster,
+    virtual_register,
     predicate,
     immediate,
     float_immediate,
@@ -49,3 +53,57 @@ struct token
 const char* name(token_type type);
 
 std::string_view info(const token& token);
+
+// Tokens of code built without text, each is its type in a byte followed by its data. Identifiers
+// and virtual registers are indices in a table of names, lines and columns are counted by the
+// reader like they are from text.
+struct packed_tokens
+{
+    std::vector<uint8_t> bytes;
+    std::vector<std::string_view> names;
+
+    void push(token_type type)
+    {
+        bytes.push_back(static_cast<uint8_t>(type));
+    }
+
+    void push_name(token_type type, uint32_t name)
+    {
+        push_data(type, name);
+    }
+
+    void push_register(uint8_t regster)
+    {
+        push_data(token_type::regster, regster);
+    }
+
+    void push_predicate(int index, bool negated)
+    {
+        push_data(token_type::predicate, static_cast<uint8_t>(index | (negated ? 8 : 0)));
+    }
+
+    void push_immediate(int64_t value)
+    {
+        push_data(token_type::immediate, value);
+    }
+
+    void push_float_immediate(double value)
+    {
+        push_data(token_type::float_immediate, value);
+    }
+
+    // Reads the token at an offset and moves the offset past it, the end reads as nothing
+    token unpack(size_t& offset) const;
+
+  private:
+    template <typename T>
+    void push_data(token_type type, T value)
+    {
+        uint8_t data[sizeof(T)];
+        std::memcpy(data, &value, sizeof(T));
+        push(type);
+        for (const uint8_t byte : data) {
+            bytes.push_back(byte);
+        }
+    }
+};
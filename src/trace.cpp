@@ -0,0 +1,190 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "nxas.h"
+#include "trace.h"
+
+using trace_clock = std::chrono::steady_clock;
+
+struct trace_event
+{
+    const char* name;
+    const char* category;
+    uint32_t file;
+    trace_clock::time_point start;
+    trace_clock::duration duration;
+};
+
+// Events of a single thread, only the thread appends to it so recording takes no locks
+struct trace_buffer
+{
+    int thread_id = 0;
+    std::vector<trace_event> events;
+
+    // Files are copied once per thread, events refer to them by index
+    std::deque<std::string> files;
+    std::unordered_map<std::string_view, uint32_t> file_indices;
+
+    uint32_t intern(const char* file)
+    {
+        // Spans of a file end one after the other, the last file is checked before hashing
+        const std::string_view name = file ? file : "";
+        if (!files.empty() && files.back() == name) {
+            return static_cast<uint32_t>(files.size() - 1);
+        }
+        const auto it = file_indices.find(name);
+        if (it != file_indices.end()) {
+            return it->second;
+        }
+        const uint32_t index = static_cast<uint32_t>(files.size());
+        file_indices.emplace(files.emplace_back(name), index);
+        return index;
+    }
+
+    void clear()
+    {
+        events.clear();
+        files.clear();
+        file_indices.clear();
+    }
+};
+
+static std::atomic<bool> is_tracing = false;
+static trace_clock::time_point trace_start;
+
+// Buffers outlive their threads so events of finished threads are still written, the mutex is
+// only taken when a thread records its first event and when the trace is started or finished
+static std::mutex buffers_mutex;
+static std::vector<std::unique_ptr<trace_buffer>> buffers;
+
+static trace_buffer& thread_buffer()
+{
+    thread_local trace_buffer* buffer = nullptr;
+    if (!buffer) {
+        const std::scoped_lock lock{buffers_mutex};
+        buffers.push_back(std::make_unique<trace_buffer>());
+        buffer = buffers.back().get();
+        buffer->thread_id = static_cast<int>(buffers.size());
+    }
+    return *buffer;
+}
+
+trace_span::trace_span(const char* name_, const char* category_, const char* file_)
+    : name{name_}, category{category_}, file{file_},
+      is_enabled{is_tracing.load(std::memory_order_relaxed)}
+{
+    if (is_enabled) {
+        start = trace_clock::now();
+    }
+}
+
+trace_span::~trace_span()
+{
+    if (!is_enabled) {
+        return;
+    }
+    const trace_clock::time_point end = trace_clock::now();
+    trace_buffer& buffer = thread_buffer();
+    buffer.events.push_back({
+        .name = name,
+        .category = category,
+        .file = buffer.intern(file),
+        .start = start,
+        .duration = end - start,
+    });
+}
+
+static void append_escaped(std::string& json, std::string_view text)
+{
+    json += '"';
+    for (const char character : text) {
+        if (character == '"' || character == '\\') {
+            json += '\\';
+            json += character;
+        } else if (static_cast<unsigned char>(character) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", character);
+            json += buffer;
+        } else {
+            json += character;
+        }
+    }
+    json += '"';
+}
+
+static double microseconds(trace_clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+namespace nxas {
+
+void start_trace()
+{
+    // The mutex doesn't guard the events, threads append to them without it. Clearing them is
+    // only safe because no thread is assembling, as for finish_trace.
+    const std::scoped_lock lock{buffers_mutex};
+    for (const std::unique_ptr<trace_buffer>& buffer : buffers) {
+        buffer->clear();
+    }
+    trace_start = trace_clock::now();
+    is_tracing.store(true, std::memory_order_relaxed);
+}
+
+std::string finish_trace()
+{
+    is_tracing.store(false, std::memory_order_relaxed);
+#ifdef _WIN32
+    const int process_id = _getpid();
+#else
+    const int process_id = static_cast<int>(getpid());
+#endif
+    const std::scoped_lock lock{buffers_mutex};
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool is_first = true;
+    char buffer[160];
+    for (const std::unique_ptr<trace_buffer>& thread : buffers) {
+        if (thread->events.empty()) {
+            continue;
+        }
+        std::snprintf(buffer, sizeof(buffer),
+                      "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,"
+                      "\"args\":{\"name\":\"thread %d\"}}",
+                      is_first ? "" : ",", process_id, thread->thread_id, thread->thread_id);
+        json += buffer;
+        is_first = false;
+
+        for (const trace_event& event : thread->events) {
+            const std::string& file = thread->files[event.file];
+            json += ",\n{\"ph\":\"X\",\"name\":";
+            append_escaped(json, event.name ? std::string_view{event.name} : file);
+            std::snprintf(buffer, sizeof(buffer),
+                          ",\"cat\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                          "\"args\":{\"file\":",
+                          event.category, process_id, thread->thread_id,
+                          microseconds(event.start - trace_start), microseconds(event.duration));
+            json += buffer;
+            append_escaped(json, file);
+            json += "}}";
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+} // namespace nxas
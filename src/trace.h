@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "time_report.h"
+
+// Span recorded in the trace when it ends, nothing is recorded unless a trace was started. Names
+// have to be string literals, files are copied the first time a thread records them and name spans
+// without a name.
+class trace_span
+{
+  public:
+    trace_span(const char* name, const char* category, const char* file);
+    ~trace_span();
+
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+
+  private:
+    const char* name;
+    const char* category;
+    const char* file;
+    std::chrono::steady_clock::time_point start;
+    bool is_enabled;
+};
+
+// Span of a whole file, named by the file so stragglers stand out
+#define TRACE_FILE(file) const trace_span scoped_trace_file(nullptr, "file", file)
+
+// Span of a phase of the file being processed
+#define TRACE_PHASE(name, file) const trace_span scoped_trace_phase(name, "phase", file)
+
+// Phase both timed for --time-report and recorded in the trace, the single hook for a phase of
+// the assembler that both profiles care about
+#define PROFILE_PHASE(phase, name, file)                                                           \
+    TIME_PHASE(phase);                                                                             \
+    TRACE_PHASE(name, file)
@@ -1,33 +1,148 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <span>
 #include <vector>
 
 #include "context.h"
+#include "dksh.h"
 #include "error.h"
+#include "resources.h"
+#include "time_report.h"
 
-std::vector<uint64_t> context::binary(std::span<const uint64_t> code) const
-{
-    constexpr size_t potential_extra_size = 64;
+// Shader program header words
+constexpr size_t SPH_WORDS = 20;
 
-    const bool has_gfx_header = type && *type != program_type::compute;
-    const size_t code_size = code.size() + (has_gfx_header ? 8 : 0);
+// Bits of each attribute word in the input map of fragment programs, selecting interpolation
+constexpr uint32_t INTERPOLATION_PERSPECTIVE = 2;
 
+std::vector<uint64_t> context::binary(std::span<const uint64_t> code,
+                                      const resource_usage& usage,
+                                      nxas::program_resources* resources) const
+{
     std::vector<uint64_t> result;
-    result.reserve(code.size() + potential_extra_size);
+    binary(code, usage, resources, [&result](size_t num_words) {
+        result.resize(num_words);
+        return std::span(result);
+    });
+    return result;
+}
+
+void context::binary(std::span<const uint64_t> code, const resource_usage& usage,
+                     nxas::program_resources* resources, const binary_storage& storage) const
+{
+    TIME_PHASE(binary);
     if (is_dksh) {
-        write_dksh(code_size, result);
+        const dksh_program program = dksh(code, usage);
+        if (resources) {
+            *resources = program.resources;
+        }
+        const std::span programs(&program, 1);
+        write_dksh(programs, storage(dksh_words(programs)));
+        return;
     }
-    if (has_gfx_header) {
-        write_gfx_header(result);
+    const nxas::program_resources resolved = resolve_resources(usage);
+    if (resources) {
+        *resources = resolved;
     }
-    result.insert(result.end(), code.begin(), code.end());
-    if (is_dksh) {
-        result.resize(result.size() + 32 - code.size() % 32);
+    write_program_code(code, usage, resolved, storage(header_words() + code.size()));
+}
+
+size_t context::header_words() const
+{
+    if (type && *type != program_type::compute) {
+        return GFX_HEADER_SIZE / sizeof(uint64_t);
     }
+    return 0;
+}
+
+std::vector<uint64_t> context::program_code(std::span<const uint64_t> code,
+                                            const resource_usage& usage,
+                                            const nxas::program_resources& resources) const
+{
+    std::vector<uint64_t> result(header_words() + code.size());
+    write_program_code(code, usage, resources, result);
     return result;
 }
 
-void context::write_gfx_header(std::vector<uint64_t>& output) const
+void context::write_program_code(std::span<const uint64_t> code, const resource_usage& usage,
+                                 const nxas::program_resources& resources,
+                                 std::span<uint64_t> output) const
+{
+    const size_t num_header_words = header_words();
+    if (num_header_words > 0) {
+        write_gfx_header(usage, resources, output.first(num_header_words));
+    }
+    std::ranges::copy(code, output.begin() + static_cast<ptrdiff_t>(num_header_words));
+}
+
+void context::write_gfx_header(const resource_usage& usage,
+                               const nxas::program_resources& resources,
+                               std::span<uint64_t> output) const
 {
-    fatal_error("write_gfx_header is not implemented");
+    const bool is_fragment = *type == program_type::fragment;
+    const auto flag = [](bool value, int bit) { return value ? 1U << bit : 0U; };
+
+    std::array<uint32_t, SPH_WORDS> sph{};
+    // Program types are numbered from one in the header, fragment programs use the second layout
+    sph[0] = (is_fragment ? 2 : 1) | 3 << 5 | (static_cast<uint32_t>(*type) + 1) << 10 | 1 << 17;
+    sph[0] |= flag(is_fragment && num_render_targets > 1, 14);
+    sph[0] |= flag(usage.kills, 15);
+    sph[0] |= flag(usage.does_global_store, 16);
+    sph[0] |= flag(usage.does_load_or_store, 26);
+    sph[0] |= flag(usage.does_fp64, 27);
+    const uint32_t patch_attributes = static_cast<uint32_t>(usage.patch_attributes_size + 15) / 16;
+    sph[1] = static_cast<uint32_t>(resources.local_mem_size) | patch_attributes << 24;
+    sph[3] = static_cast<uint32_t>(resources.crs_size);
+    switch (*type) {
+    case program_type::tess_control:
+        sph[2] = static_cast<uint32_t>(threads_per_primitive) << 24;
+        // Parallel output reads start past every address
+        sph[4] = 0xFF << 12;
+        break;
+    case program_type::geometry:
+        sph[2] = static_cast<uint32_t>(threads_per_primitive) << 24;
+        sph[3] |= static_cast<uint32_t>(output_topology) << 24;
+        sph[4] = static_cast<uint32_t>(max_output_vertices);
+        break;
+    default:
+        break;
+    }
+
+    if (is_fragment) {
+        for (size_t index = 0; index < usage.inputs.size(); ++index) {
+            if (!usage.inputs[index]) {
+                continue;
+            }
+            const size_t address = index * 4;
+            if (address >= 0x60 && address < 0x80) {
+                sph[5] |= 1U << (24 + (address - 0x60) / 4);
+            } else if (address >= 0x2C0 && address < 0x300) {
+                sph[14] |= 1U << (16 + (address - 0x2C0) / 4);
+            } else if (address >= 0x80 && address < 0x380) {
+                // Fixed function attributes past the system values are packed after colors
+                const size_t bit = index * 2 - (address >= 0x300 ? 32 : 0);
+                sph[4 + bit / 32] |= INTERPOLATION_PERSPECTIVE << (bit % 32);
+            }
+        }
+        for (int target = 0; target < num_render_targets; ++target) {
+            sph[18] |= 0xFU << (target * 4);
+        }
+        sph[19] = flag(writes_depth, 1);
+    } else {
+        // Vertex, tessellation and geometry maps have a bit per attribute word
+        for (size_t index = 0; index < usage.inputs.size(); ++index) {
+            sph[5 + index / 32] |= flag(usage.inputs[index], static_cast<int>(index % 32));
+        }
+        for (size_t index = 0; index < 7 * 32; ++index) {
+            sph[13 + index / 32] |= flag(usage.outputs[index], static_cast<int>(index % 32));
+        }
+    }
+
+    // The header ends right where the first scheduling bundle starts
+    std::ranges::fill(output, 0);
+    std::memcpy(reinterpret_cast<char*>(output.data()) + GFX_HEADER_OFFSET, sph.data(),
+                sizeof(sph));
 }
@@ -0,0 +1,53 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "flow.h"
+#include "opcode.h"
+#include "table.h"
+#include "yield.h"
+
+std::vector<nxas::yield_change> place_yields(std::span<opcode> opcodes, int interval)
+{
+    std::vector<nxas::yield_change> changes;
+    for (size_t branch = 0; branch < opcodes.size(); ++branch) {
+        if (std::string_view{opcodes[branch].info->mnemonic} != "BRA") {
+            continue;
+        }
+        const std::optional target = branch_target(opcodes, branch);
+        if (!target || *target > branch) {
+            continue;
+        }
+        nxas::yield_change change;
+        change.loop_begin = static_cast<uint32_t>(instruction_address(*target));
+        change.loop_end = static_cast<uint32_t>(instruction_address(branch));
+
+        // Hints already in the body, from the source or an enclosing loop, reset the count
+        bool has_yield = false;
+        int run = 0;
+        for (size_t index = *target; index <= branch; ++index) {
+            opcode& op = opcodes[index];
+            if (!op.sched.values.yield && ++run >= interval) {
+                op.sched.values.yield = 1;
+                change.addresses.push_back(static_cast<uint32_t>(instruction_address(index)));
+            }
+            if (op.sched.values.yield) {
+                has_yield = true;
+                run = 0;
+            }
+        }
+        // Short loops still need a chance to yield on every iteration
+        if (!has_yield) {
+            opcodes[branch].sched.values.yield = 1;
+            change.addresses.push_back(change.loop_end);
+        }
+        if (!change.addresses.empty()) {
+            changes.push_back(std::move(change));
+        }
+    }
+    return changes;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "nxas.h"
+
+struct opcode;
+
+// Sets the yield hint inside the body of backward branching loops so no more than the given
+// number of instructions run in a row without one, returns the hints placed on each loop
+std::vector<nxas::yield_change> place_yields(std::span<opcode> opcodes, int interval);
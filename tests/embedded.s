@@ -0,0 +1,5 @@
+.dksh compute
+main:
+    S2R R0, SR_TID.X;
+    IADD32I R0, R0, 0x1;
+    EXIT;
@@ -1,44 +1,1874 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cinttypes>
+#include <csignal>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
-#include <charconv>
-#include <cinttypes>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
+#include "corpus.h"
+#include "embedded.h"
+#include "empty_shader.h"
+#include "error.h"
 #include "nxas.h"
+#include "output.h"
+#include "parse.h"
+#include "time_report.h"
 
-int main(int argc, char** argv)
+struct vector
+{
+    int line = 0;
+    std::string expression{};
+
+    // Expected first instruction, vectors without one have to fail to assemble
+    bool is_failure = false;
+    uint64_t opcode = 0;
+};
+
+static std::string_view trim(std::string_view text)
+{
+    const size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+static bool parse_vector(std::string_view text, vector& result)
+{
+    const size_t space = text.find(' ');
+    if (space == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view expected = text.substr(0, space);
+    result.expression = std::string{trim(text.substr(space + 1))} + ';';
+    if (expected == "fail") {
+        result.is_failure = true;
+        return true;
+    }
+    if (expected.size() < 3 || expected[0] != '0' || (expected[1] != 'x' && expected[1] != 'X')) {
+        return false;
+    }
+    const char* const end = expected.data() + expected.size();
+    const auto res = std::from_chars(expected.data() + 2, end, result.opcode, 16);
+    return res.ec == std::errc{} && res.ptr == end;
+}
+
+// Returns an empty string when the vector passes, otherwise why it failed
+static std::string check(const vector& vector)
 {
-    if (argc < 2) {
-        std::fprintf(stderr, "%s usage: <expression> (<expected opcode>)\n", argv[0]);
+    std::vector<uint64_t> result;
+    try {
+        result = nxas::assemble(vector.expression);
+    } catch (const nxas::assembly_error& error) {
+        return vector.is_failure ? std::string{} : error.what();
+    }
+    if (vector.is_failure) {
+        return "assembled but was expected to fail";
+    }
+
+    // Disassembled code has to assemble back to the same code
+    const std::string text = nxas::disassemble(result);
+    std::vector<uint64_t> reassembled;
+    try {
+        reassembled = nxas::assemble(text);
+    } catch (const nxas::assembly_error& error) {
+        return "disassembly doesn't assemble:\n" + text + error.what();
+    }
+    if (reassembled != result) {
+        return "disassembly doesn't assemble to the same code:\n" + text;
+    }
+    if (result[1] != vector.opcode) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "incorrect opcode 0x%" PRIX64 " vs 0x%" PRIX64,
+                      result[1], vector.opcode);
+        return buffer;
+    }
+    return {};
+}
+
+// Assembles a generated program and checks its disassembly assembles back to the same code
+static int check_corpus(size_t num_instructions)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const std::string code = generate_corpus({.num_instructions = num_instructions});
+    std::vector<uint64_t> result;
+    try {
+        result = nxas::assemble(code, "corpus");
+        // Disassembly doesn't print directives, declare local memory to avoid a warning
+        const std::string text = ".local_memory 0x1000\n" + nxas::disassemble(result);
+        if (nxas::assemble(text, "disassembly") != result) {
+            std::fprintf(stderr, "disassembly of the corpus doesn't assemble to the same code\n");
+            return 1;
+        }
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
         return 1;
     }
-    const std::string expression = std::string(argv[1]) + ';';
-    const char* const expected = argc > 2 ? argv[2] : nullptr;
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("corpus of %zu instructions passed in %.1f ms\n", num_instructions,
+                elapsed.count());
+    return 0;
+}
+
+// Candidates tried in the order of a profile compiled into the parser have to encode every table
+// entry like they do in table order, the order recording a profile tries them in. Entries that
+// parse the same instruction can't be disjoint, the profile could reorder them otherwise.
+static int check_candidates()
+{
+    const std::string code = generate_corpus({.num_instructions = 100000});
+    try {
+        candidate_profile profile;
+        record_candidates(&profile);
+        const std::vector<uint64_t> table_order = nxas::assemble(code, "corpus");
+        record_candidates(nullptr);
+        if (nxas::assemble(code, "corpus") != table_order) {
+            std::fprintf(stderr, "candidates in parse order encode differently than table order\n");
+            return 1;
+        }
+#ifdef NXAS_CANDIDATE_PROFILE
+        for (const auto& [first, second] : profile.overlaps) {
+            if (are_disjoint_candidates(first, second)) {
+                std::fprintf(stderr, "disjoint entries %zu and %zu parsed the same instruction\n",
+                             first, second);
+                return 1;
+            }
+        }
+#endif
+    } catch (const nxas::assembly_error& error) {
+        record_candidates(nullptr);
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    std::printf("candidates encode the same in parse and table order\n");
+    return 0;
+}
+
+static std::string time_report_text()
+{
+    std::FILE* const file = std::tmpfile();
+    if (!file) {
+        return {};
+    }
+    print_time_report(file);
+    std::rewind(file);
+    std::string text;
+    char buffer[256];
+    for (size_t size; (size = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        text.append(buffer, size);
+    }
+    std::fclose(file);
+    return text;
+}
 
-    std::vector<uint64_t> result = nxas::assemble(expression);
-    if (!expected) {
-        return 0;
+// Value of a line of a time report, empty when the report doesn't have it
+static std::optional<double> report_value(const std::string& report, std::string_view name)
+{
+    const size_t line = report.find("\n  " + std::string{name} + ' ');
+    if (line == std::string::npos) {
+        return {};
     }
-    const size_t expected_len = std::strlen(expected);
-    if (expected_len < 3) {
-        std::fprintf(stderr, "Expected opcode is too short\n");
+    return std::strtod(report.c_str() + line + 3 + name.size(), nullptr);
+}
+
+// Every phase and counter is in the time report, they add up over the threads that assembled
+static int check_time_report()
+{
+    if constexpr (!has_time_report) {
+        std::fprintf(stderr, "built without NXAS_TIME_REPORT\n");
         return 1;
     }
-    if (expected[0] != '0' || (expected[1] != 'x' && expected[1] != 'X')) {
-        std::fprintf(stderr, "Expected opcode has to start with '0x'\n");
+    const std::string code = generate_corpus({
+        .num_instructions = 2000,
+        .is_dksh = true,
+        .type = "compute",
+    });
+    bool is_assembled = true;
+    const auto assemble = [&] {
+        try {
+            nxas::assemble(code, "corpus");
+        } catch (const nxas::assembly_error& error) {
+            std::fprintf(stderr, "%s\n", error.what());
+            is_assembled = false;
+        }
+    };
+    assemble();
+    const std::string first = time_report_text();
+    std::thread worker(assemble);
+    worker.join();
+    const std::string second = time_report_text();
+    if (!is_assembled) {
         return 1;
     }
-    uint64_t expected_opcode = 0;
-    const auto res = std::from_chars(expected + 2, expected + expected_len, expected_opcode, 16);
-    if (res.ec != std::errc{}) {
-        std::fprintf(stderr, "Expected opcode is not valid hex\n");
+
+    size_t num_failures = 0;
+    static const char* const lines[] = {
+        "label pre-scan", "lexing and matching", "control word packing", "output writing", "other",
+        "total",          "tokens lexed",        "candidates tried",     "failed candidates",
+    };
+    for (const char* const line : lines) {
+        if (!report_value(first, line) || !report_value(second, line)) {
+            std::fprintf(stderr, "time report has no \"%s\" line:\n%s", line, first.c_str());
+            ++num_failures;
+        }
+    }
+    const double tokens = report_value(first, "tokens lexed").value_or(0);
+    const double candidates = report_value(first, "candidates tried").value_or(0);
+    const double failed = report_value(first, "failed candidates").value_or(0);
+    if (tokens < 2000 || candidates < 2000 || failed >= candidates) {
+        std::fprintf(stderr, "time report counters are off:\n%s", first.c_str());
+        ++num_failures;
+    }
+    for (const char* const counter : {"tokens lexed", "candidates tried", "failed candidates"}) {
+        if (report_value(second, counter) != 2 * report_value(first, counter).value_or(0)) {
+            std::fprintf(stderr, "\"%s\" doesn't count the second thread:\n%s", counter,
+                         second.c_str());
+            ++num_failures;
+        }
+    }
+    std::printf("%s", second.c_str());
+    return num_failures == 0 ? 0 : 1;
+}
+
+// Assembles a program and the text it's expected to be equal to, returns false and prints why when
+// they don't assemble to the same code
+static bool expect_same_code(const char* name, const std::string& code,
+                             const nxas::options& options, const std::string& expected)
+{
+    try {
+        if (nxas::assemble(code, name, options) != nxas::assemble(expected, name)) {
+            std::fprintf(stderr, "%s: doesn't assemble to the same code as:\n%s\n", name,
+                         expected.c_str());
+            return false;
+        }
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return false;
+    }
+    return true;
+}
+
+struct program_pair
+{
+    const char* name;
+    const char* code;
+    const char* expected;
+};
+
+static bool expect_occupancy(const char* name, const nxas::program_resources& resources,
+                             int warps_per_sm, nxas::occupancy_limit limit)
+{
+    const nxas::occupancy result = nxas::compute_occupancy(resources);
+    if (result.warps_per_sm != warps_per_sm || result.limit != limit) {
+        std::fprintf(stderr, "%s: %d warps per SM limited by %d, expected %d limited by %d\n",
+                     name, result.warps_per_sm, static_cast<int>(result.limit), warps_per_sm,
+                     static_cast<int>(limit));
+        return false;
+    }
+    return true;
+}
+
+static int check_occupancy()
+{
+    using nxas::occupancy_limit;
+    const nxas::program_resources vertex{.num_gprs = 4};
+    nxas::program_resources compute{
+        .num_gprs = 32,
+        .block_dimensions = {1024, 1, 1},
+        .is_compute = true,
+    };
+    bool passed = expect_occupancy("vertex", vertex, 64, occupancy_limit::warps) &&
+                  expect_occupancy("fragment", {.num_gprs = 64}, 32, occupancy_limit::registers) &&
+                  expect_occupancy("compute", compute, 64, occupancy_limit::warps);
+
+    // Blocks of 32 warps only fit twice with 32 registers, one more register halves occupancy
+    ++compute.num_gprs;
+    passed = passed && expect_occupancy("one more register", compute, 32,
+                                        occupancy_limit::registers);
+
+    // Small blocks run out of blocks before warps
+    compute.block_dimensions = {32, 1, 1};
+    compute.num_gprs = 16;
+    passed = passed && expect_occupancy("small blocks", compute, 32, occupancy_limit::blocks);
+
+    compute.shared_mem_size = 0x4000;
+    passed = passed && expect_occupancy("shared memory", compute, 4,
+                                        occupancy_limit::shared_memory);
+    std::printf("occupancy %s\n", passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
+
+static bool same_positions(const std::vector<nxas::source_position>& a,
+                           const std::vector<nxas::source_position>& b)
+{
+    return std::ranges::equal(a, b, [](const auto& x, const auto& y) {
+        return x.address == y.address && x.line == y.line && x.column == y.column;
+    });
+}
+
+struct session_edit
+{
+    // First line the edit replaces, the line the text is inserted before when it replaces none
+    const char* line;
+    int num_lines;
+    const char* text;
+
+    // Edits keeping labels and options only encode the instructions they touch
+    bool is_local;
+};
+
+// Line of the code equal to the given text once trimmed, -1 when there is none
+static int find_line(std::string_view code, std::string_view text)
+{
+    int line = 0;
+    for (size_t begin = 0; begin < code.size(); ++line) {
+        const size_t end = std::min(code.find('\n', begin), code.size());
+        if (trim(code.substr(begin, end - begin)) == text) {
+            return line;
+        }
+        begin = end + 1;
+    }
+    return -1;
+}
+
+// Programs edited in a session have to assemble to the same code as their edited text
+static int check_session()
+{
+    static const char code[] = R"(.dksh compute
+main:
+        MOV R0, R1;
+        MOV R1, R1;
+loop:
+        IADD32I R0, R0, 0x1;
+        @P0 BRA loop;
+        @P1 BRA end;
+        NOP;
+        IADD32I R2, R2, 0x2;
+end:
+        EXIT;
+)";
+    static const session_edit edits[] = {
+        {"IADD32I R0, R0, 0x1;", 1, "        IADD32I R0, R0, 0x3;\n", true},
+        {"MOV R1, R1;", 0, "        MOV R3, R4;\n", true},
+        {"NOP;", 1, "", true},
+        {"IADD32I R2, R2, 0x2;", 0, "        @P2 BRA loop; MOV R5, R5;\n", true},
+        {"@P0 BRA loop;", 2, "        @P1 BRA end;\n        IADD32I R4, R4, 0x4;\n"
+                             "        @P0 BRA loop;\n", true},
+        {"loop:", 1, "        NOP;\nloop:\n", false},
+        {"end:", 2, "        EXIT;\nend:\n        EXIT;\n", false},
+        {".dksh compute", 1, ".dksh compute\n.workgroup_size 64 1 1\n", false},
+        {"MOV R1, R1;", 1, "        STL [0x10], R1;\n", true},
+        {"MOV R0, R1;", 0, "again:  MOV R6, R6;\n        @P3 BRA again;\n", false},
+    };
+    size_t num_failures = 0;
+    for (const bool optimize : {false, true}) {
+        nxas::options options;
+        options.optimize = optimize;
+        nxas::session session(code, "session", options);
+        for (const session_edit& edit : edits) {
+            const int line = find_line(session.code(), edit.line);
+            if (line < 0) {
+                std::fprintf(stderr, "session: no line \"%s\" to edit\n", edit.line);
+                return 1;
+            }
+            try {
+                session.edit(line, edit.num_lines, edit.text);
+                const size_t num_instructions = std::ranges::count(session.code(), ';');
+                const bool was_local = session.encoded_instructions() < num_instructions;
+                if (session.binary() != nxas::assemble(session.code(), "session", options) ||
+                    (!optimize && was_local != edit.is_local)) {
+                    std::fprintf(stderr, "session%s: editing \"%s\" encoded %zu instructions, "
+                                         "code doesn't match its text:\n%s\n",
+                                 optimize ? " with -O" : "", edit.line,
+                                 session.encoded_instructions(), session.code().c_str());
+                    ++num_failures;
+                }
+            } catch (const nxas::assembly_error& error) {
+                std::fprintf(stderr, "%s\n", error.what());
+                ++num_failures;
+            }
+        }
+    }
+    std::printf("%zu/%zu session edits passed\n", std::size(edits) * 2 - num_failures,
+                std::size(edits) * 2);
+    return num_failures == 0 ? 0 : 1;
+}
+
+struct sharing_case
+{
+    const char* name;
+    const char* first;
+    const char* second;
+
+    // Instructions of the second program replaced by references to the first one
+    size_t shared_instructions;
+};
+
+// Programs packed together have to share identical functions and tails, unless code outside of
+// them branches in, a reuse flag leads into them or they contain the entrypoint
+static int check_sharing()
+{
+    static const char tail[] = R"(.dksh compute
+main: MOV R0, R1;
+IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x2;
+STG.E [R2], R0;
+EXIT;
+)";
+    static const char function[] = R"(.dksh compute
+main: CAL func;
+EXIT;
+func: IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x2;
+RET;
+)";
+    static const sharing_case cases[] = {
+        {"shared tail", tail, R"(.dksh compute
+main: MOV R0, R3;
+IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x2;
+STG.E [R2], R0;
+EXIT;
+)",
+         3},
+        {"shared function", function, R"(.dksh compute
+main: MOV R5, R6;
+CAL func;
+EXIT;
+func: IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x2;
+RET;
+)",
+         3},
+        {"branch into tail", tail, R"(.dksh compute
+main: @P0 BRA skip;
+MOV R0, R3;
+IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x2;
+STG.E [R2], R0;
+skip: EXIT;
+)",
+         0},
+        {"reuse before tail", tail, R"(.dksh compute
+main: MOV R0, R3;
+IADD32I R0, R0.reuse, 0x1;
+IADD32I R1, R1, 0x2;
+STG.E [R2], R0;
+EXIT;
+)",
+         1},
+        {"entrypoint in tail", tail, R"(.dksh compute
+MOV R0, R3;
+IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x2;
+main: STG.E [R2], R0;
+EXIT;
+)",
+         0},
+    };
+    size_t num_failures = 0;
+    for (const sharing_case& test : cases) {
+        const nxas::source sources[] = {
+            {.code = test.first, .filename = "first"},
+            {.code = test.second, .filename = "second"},
+        };
+        std::vector<nxas::report> reports;
+        std::vector<nxas::report> unshared_reports;
+        bool is_unchanged = false;
+        try {
+            nxas::options options;
+            options.deduplicate = false;
+            is_unchanged = nxas::assemble_dksh(sources, {}, &reports) ==
+                           nxas::assemble_dksh(sources, options, &unshared_reports);
+        } catch (const nxas::assembly_error& error) {
+            std::fprintf(stderr, "%s\n", error.what());
+            ++num_failures;
+            continue;
+        }
+        const size_t shared = reports[1].shared_instructions;
+        if (reports[0].shared_instructions != 0 || shared != test.shared_instructions ||
+            unshared_reports[1].shared_instructions != 0 || (shared == 0) != is_unchanged) {
+            std::fprintf(stderr, "%s: %zu instructions shared, expected %zu\n", test.name, shared,
+                         test.shared_instructions);
+            ++num_failures;
+        }
+    }
+    std::printf("%zu/%zu shared programs passed\n", std::size(cases) - num_failures,
+                std::size(cases));
+    return num_failures == 0 ? 0 : 1;
+}
+
+struct header_fixture
+{
+    const char* name;
+    const char* code;
+
+    // Shader program header words, placed at 0x30 in the header in front of the code
+    std::array<uint32_t, 20> words;
+};
+
+// Graphics programs have to be prefixed by the shader program header of their stage
+static int check_headers()
+{
+    static const header_fixture fixtures[] = {
+        {"vertex", R"(.type vertex
+ALD.128 R4, a[0x80];
+AST.128 a[0x70], R4;
+STG.E [R2], R0;
+EXIT;
+)",
+         {0x04030461, 0, 0, 0, 0, 0, 0xF, 0, 0, 0, 0, 0, 0, 0xF0000000, 0, 0, 0, 0, 0, 0}},
+        {"fragment", R"(.type fragment
+.render_targets 2
+.writes_depth
+ALD R0, a[0x84];
+ALD R1, a[0x64];
+ALD R2, a[0x2C4];
+ALD R3, a[0x300];
+KIL;
+EXIT;
+)",
+         {0x0002D462, 0, 0, 0, 0, 0x02000000, 0x8, 0, 0, 0, 0, 0, 0, 0, 0x00020000, 0x2, 0,
+          0, 0xFF, 0x2}},
+        {"geometry", R"(.type geometry
+.threads_per_primitive 3
+.output_topology triangle_strip
+.max_output_vertices 4
+ALD R0, a[0x70], R8;
+AST a[0x7C], R0;
+EXIT;
+)",
+         {0x00021061, 0, 0x03000000, 0x07000000, 4, 0x10000000, 0, 0, 0, 0, 0, 0, 0,
+          0x80000000, 0, 0, 0, 0, 0, 0}},
+        {"tessellation control", R"(.type tess_control
+.threads_per_primitive 4
+AST.P a[RZ+0x10], R0;
+SSY end;
+NOP;
+end: EXIT;
+)",
+         {0x00020861, 0x02000000, 0x04000000, 0x10, 0xFF000, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0}},
+    };
+    size_t num_failures = 0;
+    for (const header_fixture& fixture : fixtures) {
+        std::vector<uint64_t> binary;
+        try {
+            binary = nxas::assemble(fixture.code, fixture.name);
+        } catch (const nxas::assembly_error& error) {
+            std::fprintf(stderr, "%s\n", error.what());
+            ++num_failures;
+            continue;
+        }
+        std::array<uint32_t, 20> words{};
+        std::memcpy(words.data(), reinterpret_cast<const char*>(binary.data()) + 0x30,
+                    sizeof(words));
+        if (words != fixture.words) {
+            std::fprintf(stderr, "%s: header words differ:\n", fixture.name);
+            for (size_t index = 0; index < words.size(); ++index) {
+                if (words[index] != fixture.words[index]) {
+                    std::fprintf(stderr, "    %2zu: 0x%08X, expected 0x%08X\n", index,
+                                 words[index], fixture.words[index]);
+                }
+            }
+            ++num_failures;
+        }
+    }
+    std::printf("%zu/%zu program headers passed\n", std::size(fixtures) - num_failures,
+                std::size(fixtures));
+    return num_failures == 0 ? 0 : 1;
+}
+
+// Line tables have to decode to the positions they were encoded from
+static int check_lines()
+{
+    static const char code[] = R"(MOV R0, R1;
+
+    IADD32I R0, R0, 0x1;
+loop:   IADD32I R1, R1, 0x1;
+        @P0 BRA loop;
+EXIT;
+)";
+    std::vector<nxas::line_sequence> sequences(2);
+    try {
+        nxas::report report;
+        nxas::assemble(code, "lines", {}, &report);
+        sequences[0] = {.filename = "lines", .positions = std::move(report.lines)};
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
         return 1;
     }
-    if (result[1] != expected_opcode) {
-        std::fprintf(stderr, "Incorrect opcode: 0x%" PRIX64 " vs 0x%" PRIX64 "\n",
-                     result[1], expected_opcode);
+    // Lines going back, long jumps of lines and addresses and wide columns don't fit a special
+    // opcode
+    sequences[1] = {
+        .filename = "jumps",
+        .positions = {{0x8, 1, 1}, {0x10, 100000, 1}, {0x18, 2, 300}, {0x4008, 3, 4},
+                      {0x4010, -5, 1}},
+    };
+
+    bool passed = true;
+    const std::vector<uint8_t> table = nxas::encode_line_table(sequences);
+    try {
+        const std::vector<nxas::line_sequence> decoded = nxas::decode_line_table(table);
+        passed = decoded.size() == sequences.size();
+        for (size_t index = 0; passed && index < decoded.size(); ++index) {
+            passed = decoded[index].filename == sequences[index].filename &&
+                     same_positions(decoded[index].positions, sequences[index].positions);
+        }
+        if (!passed) {
+            std::fprintf(stderr, "line table doesn't decode to its positions\n");
+        }
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        passed = false;
+    }
+    // Every truncation of the table has to be rejected
+    for (size_t size = 0; size < table.size(); ++size) {
+        try {
+            nxas::decode_line_table(std::span(table).first(size));
+            std::fprintf(stderr, "line table truncated to %zu bytes decodes\n", size);
+            passed = false;
+        } catch (const nxas::assembly_error&) {
+        }
+    }
+    std::printf("lines %s\n", passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
+
+// Yield hints have to be placed inside backward loops only, at most every interval instructions
+static int check_yields()
+{
+    static const char loop[] = R"(MOV R0, R1;
+loop: IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x1;
+IADD32I R2, R2, 0x1;
+@P0 BRA loop;
+@P1 BRA end;
+IADD32I R3, R3, 0x1;
+end: EXIT;
+)";
+    static const char hinted[] = R"(MOV R0, R1;
+loop: IADD32I R0, R0, 0x1;
+IADD32I R1, R1, 0x1 @Y;
+IADD32I R2, R2, 0x1;
+@P0 BRA loop @Y;
+@P1 BRA end;
+IADD32I R3, R3, 0x1;
+end: EXIT;
+)";
+    static const char short_loop[] = "loop: IADD32I R0, R0, 0x1;\n@P0 BRA loop;\nEXIT;\n";
+    static const char short_hinted[] = "loop: IADD32I R0, R0, 0x1;\n@P0 BRA loop @Y;\nEXIT;\n";
+    static const char yielding[] =
+        "loop: IADD32I R0, R0, 0x1 @Y;\nIADD32I R1, R1, 0x1;\n@P0 BRA loop;\nEXIT;\n";
+
+    bool passed = expect_same_code("yield loop", loop, {.yield_interval = 2}, hinted) &&
+                  expect_same_code("short loop", short_loop, {.yield_interval = 8}, short_hinted) &&
+                  expect_same_code("yielding loop", yielding, {.yield_interval = 8}, yielding);
+
+    nxas::report report;
+    try {
+        nxas::assemble(loop, "yield loop", {.yield_interval = 2}, &report);
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
         return 1;
     }
+    const std::vector<uint32_t> addresses{0x18, 0x30};
+    if (report.yields.size() != 1 || report.yields[0].loop_begin != 0x10 ||
+        report.yields[0].loop_end != 0x30 || report.yields[0].addresses != addresses) {
+        std::fprintf(stderr, "yield loop: hints aren't reported at 0x18 and 0x30\n");
+        passed = false;
+    }
+    std::printf("yields %s\n", passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
+
+struct resource_case
+{
+    const char* name;
+    const char* code;
+    int num_gprs;
+    int local_mem_size;
+    int shared_mem_size;
+    int crs_size;
+
+    // Text of the warning the program has to raise, null when it has to raise none
+    const char* warning;
+};
+
+// Headers of programs have to describe the resources their code uses
+static int check_resources()
+{
+    static const resource_case cases[] = {
+        {"minimum registers", "EXIT;", 4, 0, 0, 0, nullptr},
+        {"tuple load", "LDG.E.128 R4, [R2];\nEXIT;", 8, 0, 0, 0, nullptr},
+        {"tuple address", "STG.E [R12], R0;\nEXIT;", 14, 0, 0, 0, nullptr},
+        {"double", "DADD R10, R2, R4;\nEXIT;", 12, 0, 0, 0, nullptr},
+        {"zero register", "MOV RZ, R1;\nEXIT;", 4, 0, 0, 0, nullptr},
+        {"local range", "STL.64 [0x10], R4;\nLDL R0, [0x40];\nEXIT;", 6, 0x50, 0, 0, nullptr},
+        {"indexed local", ".local_memory 0x100\nLDL R0, [R1];\nEXIT;", 4, 0x100, 0, 0, nullptr},
+        {"unknown local", "LDL R0, [R1];\nEXIT;", 4, 0, 0, 0,
+         "local memory is addressed with registers and .local_memory is not declared"},
+        {"shared range", "LDS.128 R0, [0x100];\nEXIT;", 4, 0, 0x200, 0, nullptr},
+        {"sync nesting", "SSY end;\nPBK brk;\n@P0 BRK;\nbrk: SYNC;\nend: EXIT;", 4, 0, 0, 0x20,
+         nullptr},
+        {"call nesting", "SSY end;\nCAL func;\nend: EXIT;\nfunc: SSY ret;\nNOP;\nret: RET;", 4,
+         0, 0, 0x30, nullptr},
+        {"recursion", "CAL main;\nEXIT;", 4, 0, 0, 0x800, nullptr},
+        {"looser directive", ".num_gprs 32\nMOV R1, R2;\nEXIT;", 4, 0, 0, 0,
+         ".num_gprs 32 is larger than the 4 registers used"},
+        {"tighter directive", ".shared_memory 0x10\nSTS [0x20], R0;\nEXIT;", 4, 0, 0x100, 0,
+         ".shared_memory 16 is smaller than the 36 bytes used"},
+    };
+    size_t num_failures = 0;
+    for (const resource_case& test : cases) {
+        const std::string code = std::string{".dksh compute\nmain:\n"} + test.code;
+        std::vector<std::string> warnings;
+        nxas::report report;
+        set_warning_sink(&warnings);
+        try {
+            nxas::assemble(code, test.name, {}, &report);
+        } catch (const nxas::assembly_error& error) {
+            warnings.push_back(error.what());
+        }
+        set_warning_sink(nullptr);
+
+        const nxas::program_resources& resources = report.resources;
+        const bool warned = test.warning ? warnings.size() == 1 && warnings[0] == test.warning
+                                         : warnings.empty();
+        if (resources.num_gprs != test.num_gprs ||
+            resources.local_mem_size != test.local_mem_size ||
+            resources.shared_mem_size != test.shared_mem_size ||
+            resources.crs_size != test.crs_size || !warned) {
+            std::fprintf(stderr,
+                         "%s: %d registers, 0x%x bytes of local memory, 0x%x bytes of shared "
+                         "memory and 0x%x bytes of stack, expected %d, 0x%x, 0x%x and 0x%x\n",
+                         test.name, resources.num_gprs, resources.local_mem_size,
+                         resources.shared_mem_size, resources.crs_size, test.num_gprs,
+                         test.local_mem_size, test.shared_mem_size, test.crs_size);
+            for (const std::string& warning : warnings) {
+                std::fprintf(stderr, "    %s\n", warning.c_str());
+            }
+            ++num_failures;
+        }
+    }
+    std::printf("%zu/%zu resource checks passed\n", std::size(cases) - num_failures,
+                std::size(cases));
+    return num_failures == 0 ? 0 : 1;
+}
+
+struct link_case
+{
+    const char* name;
+    const char* main;
+    const char* helper;
+};
+
+// Linked objects have to assemble to the same code as their text assembled as a single file,
+// objects are made of whole bundles
+static int check_link()
+{
+    static const link_case cases[] = {
+        {"call", ".dksh compute\nmain: CAL helper;\nEXIT;\nNOP;\n",
+         "helper: IADD32I R0, R0, 0x1;\nRET;\n"},
+        {"nested call", ".dksh compute\nmain: SSY end;\nCAL helper;\nend: EXIT;\n",
+         "helper: SSY done;\nNOP;\ndone: RET;\n"},
+        {"branch back", ".dksh compute\nmain: BRA helper;\nback: EXIT;\nNOP;\n",
+         "helper: IADD32I R0, R0, 0x1;\nBRA back;\n"},
+    };
+    size_t num_failures = 0;
+    for (const link_case& test : cases) {
+        try {
+            const nxas::object_file objects[] = {
+                {.data = nxas::assemble_object(test.main, "main"), .filename = "main"},
+                {.data = nxas::assemble_object(test.helper, "helper"), .filename = "helper"},
+            };
+            const std::string whole = std::string{test.main} + test.helper;
+            if (nxas::link(objects) != nxas::assemble(whole, test.name)) {
+                std::fprintf(stderr, "%s: linked objects don't match their text:\n%s\n",
+                             test.name, whole.c_str());
+                ++num_failures;
+            }
+        } catch (const nxas::assembly_error& error) {
+            std::fprintf(stderr, "%s\n", error.what());
+            ++num_failures;
+        }
+    }
+
+    // Broken objects and labels defined twice are reported when the objects are loaded
+    const std::vector<uint8_t> helper = nxas::assemble_object("helper: NOP;\n", "helper");
+    std::vector<uint8_t> huge_code = helper;
+    for (size_t offset = 8; offset + 4 <= huge_code.size(); ++offset) {
+        uint32_t count;
+        std::memcpy(&count, huge_code.data() + offset, sizeof(count));
+        if (offset + 4 + count * sizeof(uint64_t) == huge_code.size()) {
+            const uint32_t huge = UINT32_MAX;
+            std::memcpy(huge_code.data() + offset, &huge, sizeof(huge));
+            break;
+        }
+    }
+    const std::vector<uint8_t> truncated(helper.begin(), helper.end() - 8);
+    const std::vector<uint8_t> entry =
+        nxas::assemble_object(".dksh compute\nmain: EXIT;\n", "main");
+    const struct
+    {
+        const char* name;
+        std::vector<nxas::object_file> objects;
+    } broken[] = {
+        {"label defined twice",
+         {{.data = entry, .filename = "main"},
+          {.data = helper, .filename = "helper"},
+          {.data = helper, .filename = "copy"}}},
+        {"huge code size",
+         {{.data = entry, .filename = "main"}, {.data = huge_code, .filename = "huge"}}},
+        {"truncated code",
+         {{.data = entry, .filename = "main"}, {.data = truncated, .filename = "cut"}}},
+    };
+    for (const auto& test : broken) {
+        try {
+            nxas::link(test.objects);
+            std::fprintf(stderr, "%s: linked without an error\n", test.name);
+            ++num_failures;
+        } catch (const nxas::assembly_error&) {
+        }
+    }
+    const size_t num_cases = std::size(cases) + std::size(broken);
+    std::printf("%zu/%zu linked programs passed\n", num_cases - num_failures, num_cases);
+    return num_failures == 0 ? 0 : 1;
+}
+
+// Optimized programs have to assemble to the same code as the text they reduce to, removed
+// instructions stall the previous one instead
+static int check_optimize()
+{
+    static const program_pair pairs[] = {
+        {"self move", "MOV R1, R2;\nMOV R0, R0;\nEXIT;", "MOV R1, R2 @WAIT 1;\nEXIT;"},
+        {"first self move", "MOV R0, R0;\nMOV R1, R2;\nEXIT;", "MOV R1, R2;\nEXIT;"},
+        {"dead move", "S2R R3, SR_LANEID;\nMOV R0, R1;\nMOV R0, R2;\nEXIT;",
+         "S2R R3, SR_LANEID @WAIT 1;\nMOV R0, R2;\nEXIT;"},
+        {"read move", "MOV R0, R1;\nIADD R2, R0, R0;\nMOV R0, R2;\nEXIT;",
+         "MOV R0, R1;\nIADD R2, R0, R0;\nMOV R0, R2;\nEXIT;"},
+        {"plain nop", "MOV R1, R2 @WAIT 2;\nNOP @WAIT 3;\nEXIT;", "MOV R1, R2 @WAIT 5;\nEXIT;"},
+        {"scheduled nop", "MOV R1, R2;\nNOP @Y;\nNOP @WB 1;\nNOP @DEP 0;\nEXIT;",
+         "MOV R1, R2;\nNOP @Y;\nNOP @WB 1;\nNOP @DEP 0;\nEXIT;"},
+        {"backward label", "MOV R1, R2;\nNOP;\nloop: IADD32I R1, R1, 0x1;\n@P0 BRA loop;\nEXIT;",
+         "MOV R1, R2 @WAIT 1;\nloop: IADD32I R1, R1, 0x1;\n@P0 BRA loop;\nEXIT;"},
+        {"forward label", "@P0 BRA end;\nMOV R0, R0;\nNOP;\nend: EXIT;",
+         "@P0 BRA end @WAIT 2;\nend: EXIT;"},
+        {"labeled nop", "MOV R1, R2;\nskip: NOP;\n@P0 BRA skip;\nEXIT;",
+         "MOV R1, R2;\nskip: NOP;\n@P0 BRA skip;\nEXIT;"},
+        {"entrypoint", ".dksh compute\nMOV R0, R1;\nNOP;\nNOP;\nmain: MOV R1, R2;\nNOP;\nEXIT;",
+         ".dksh compute\nMOV R0, R1;\nNOP;\nNOP;\nmain: MOV R1, R2 @WAIT 1;\nEXIT;"},
+    };
+    size_t num_failures = 0;
+    for (const program_pair& pair : pairs) {
+        if (!expect_same_code(pair.name, pair.code, {.optimize = true}, pair.expected)) {
+            ++num_failures;
+        }
+    }
+    std::printf("%zu/%zu optimized programs passed\n", std::size(pairs) - num_failures,
+                std::size(pairs));
+    return num_failures == 0 ? 0 : 1;
+}
+
+// Virtual registers have to share physical registers once their lifetimes end and only then
+static int check_allocator()
+{
+    static const program_pair pairs[] = {
+        {"reuse", "MOV32I %a, 0x1;\nSTG.E [RZ], %a;\nMOV32I %b, 0x2;\nSTG.E [RZ], %b;\nEXIT;",
+         "MOV32I R0, 0x1;\nSTG.E [RZ], R0;\nMOV32I R0, 0x2;\nSTG.E [RZ], R0;\nEXIT;"},
+        {"overlapping", "MOV32I %a, 0x1;\nMOV32I %b, 0x2;\nMOV32I %c, 0x3;\nSTG.E [RZ], %a;\n"
+                        "STG.E [RZ], %b;\nSTG.E [RZ], %c;\nEXIT;",
+         "MOV32I R0, 0x1;\nMOV32I R1, 0x2;\nMOV32I R2, 0x3;\nSTG.E [RZ], R0;\nSTG.E [RZ], R1;\n"
+         "STG.E [RZ], R2;\nEXIT;"},
+        {"aligned tuple", "MOV32I %s, 0x1;\nLDG.E.64 %pair, [RZ];\nSTG.E [RZ], %s;\n"
+                          "STG.E.64 [RZ], %pair;\nEXIT;",
+         "MOV32I R0, 0x1;\nLDG.E.64 R2, [RZ];\nSTG.E [RZ], R0;\nSTG.E.64 [RZ], R2;\nEXIT;"},
+        {"backward branch", "MOV32I %a, 0x1;\nloop: STG.E [RZ], %a;\nMOV32I %b, 0x2;\n"
+                            "STG.E [RZ], %b;\n@P0 BRA loop;\nEXIT;",
+         "MOV32I R0, 0x1;\nloop: STG.E [RZ], R0;\nMOV32I R1, 0x2;\nSTG.E [RZ], R1;\n"
+         "@P0 BRA loop;\nEXIT;"},
+        {"same instruction", "MOV32I %a, 0x1;\nIADD %b, %a, RZ;\nSTG.E [RZ], %b;\nEXIT;",
+         "MOV32I R0, 0x1;\nIADD R0, R0, RZ;\nSTG.E [RZ], R0;\nEXIT;"},
+    };
+    size_t num_failures = 0;
+    for (const program_pair& pair : pairs) {
+        if (!expect_same_code(pair.name, pair.code, {}, pair.expected)) {
+            ++num_failures;
+        }
+    }
+
+    // Each register live at once takes a physical register, one more than there are fails
+    const auto overlapping = [](int count) {
+        std::string code;
+        for (int i = 0; i < count; ++i) {
+            code += "MOV32I %v" + std::to_string(i) + ", 0x1;\n";
+        }
+        for (int i = 0; i < count; ++i) {
+            code += "STG.E [RZ], %v" + std::to_string(i) + ";\n";
+        }
+        return code + "EXIT;\n";
+    };
+    nxas::report report;
+    try {
+        nxas::assemble(overlapping(6), "six registers", {}, &report);
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+    }
+    if (report.resources.num_gprs != 6) {
+        std::fprintf(stderr, "six registers: %d registers, expected 6\n",
+                     report.resources.num_gprs);
+        ++num_failures;
+    }
+    try {
+        nxas::assemble(overlapping(256), "too many registers");
+        std::fprintf(stderr, "too many registers: assembled\n");
+        ++num_failures;
+    } catch (const nxas::assembly_error& error) {
+        if (!error.message.starts_with("ran out of registers allocating %v")) {
+            std::fprintf(stderr, "%s\n", error.what());
+            ++num_failures;
+        }
+    }
+    std::printf("%zu/%zu allocator checks passed\n", std::size(pairs) + 2 - num_failures,
+                std::size(pairs) + 2);
+    return num_failures == 0 ? 0 : 1;
+}
+
+static std::string labeled_program(int num_blocks)
+{
+    std::string code;
+    for (int i = 0; i < num_blocks; ++i) {
+        const std::string index = std::to_string(i);
+        code += "l" + index + ": MOV32I %v" + index + ", 0x1;\nSTG.E [RZ], %v" + index + ";\n";
+    }
+    return code + "EXIT;\n";
+}
+
+static bool is_same_usage(const nxas::memory_usage& lhs, const nxas::memory_usage& rhs)
+{
+    return lhs.allocations == rhs.allocations && lhs.bytes == rhs.bytes;
+}
+
+// Memory is counted by the allocator, so every kind of data grows with the program it's made for
+// and assembling the same program again counts the same allocations. The first assembly also
+// allocates state kept for the later ones, so it isn't compared.
+static int check_memory()
+{
+    struct kind
+    {
+        const char* name;
+        nxas::memory_usage nxas::memory_statistics::*usage;
+    };
+    static const kind kinds[] = {
+        {"labels", &nxas::memory_statistics::labels},
+        {"opcodes", &nxas::memory_statistics::opcodes},
+        {"output", &nxas::memory_statistics::output},
+        {"other", &nxas::memory_statistics::other},
+    };
+    nxas::report small;
+    nxas::report large;
+    nxas::report again;
+    try {
+        nxas::assemble(labeled_program(100), "first", {}, &small);
+        nxas::assemble(labeled_program(100), "small", {}, &small);
+        nxas::assemble(labeled_program(1000), "large", {}, &large);
+        nxas::assemble(labeled_program(100), "small", {}, &again);
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    size_t num_failures = 0;
+    size_t total_bytes = 0;
+    for (const kind& kind : kinds) {
+        const nxas::memory_usage& before = small.memory.*kind.usage;
+        const nxas::memory_usage& after = large.memory.*kind.usage;
+        if (before.allocations == 0 || after.bytes <= before.bytes) {
+            std::fprintf(stderr, "%s: %zu bytes in %zu allocations grew to %zu bytes\n", kind.name,
+                         before.bytes, before.allocations, after.bytes);
+            ++num_failures;
+        }
+        if (!is_same_usage(before, again.memory.*kind.usage)) {
+            std::fprintf(stderr, "%s: %zu bytes, %zu assembling again\n", kind.name, before.bytes,
+                         (again.memory.*kind.usage).bytes);
+            ++num_failures;
+        }
+        total_bytes += after.bytes;
+    }
+    if (small.memory.diagnostics.allocations != 0 || large.memory.diagnostics.allocations != 0) {
+        std::fprintf(stderr, "diagnostics: formatted for programs that assemble\n");
+        ++num_failures;
+    }
+    if (small.memory.peak_bytes == 0 || large.memory.peak_bytes <= small.memory.peak_bytes ||
+        large.memory.peak_bytes > total_bytes) {
+        std::fprintf(stderr, "peak: %zu bytes grew to %zu bytes of %zu allocated\n",
+                     small.memory.peak_bytes, large.memory.peak_bytes, total_bytes);
+        ++num_failures;
+    }
+
+    // Programs assembled together count their own allocations
+    const nxas::source sources[] = {
+        {.code = ".dksh compute\nmain: NOP;\n" + labeled_program(100), .filename = "small"},
+        {.code = ".dksh compute\nmain: NOP;\n" + labeled_program(1000), .filename = "large"},
+    };
+    std::vector<nxas::report> reports;
+    try {
+        nxas::assemble_dksh(sources, {}, &reports);
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    if (reports[0].memory.opcodes.bytes == 0 ||
+        reports[1].memory.opcodes.bytes <= reports[0].memory.opcodes.bytes ||
+        reports[1].memory.peak_bytes <= reports[0].memory.peak_bytes) {
+        std::fprintf(stderr, "dksh: %zu opcode bytes and a peak of %zu grew to %zu and %zu\n",
+                     reports[0].memory.opcodes.bytes, reports[0].memory.peak_bytes,
+                     reports[1].memory.opcodes.bytes, reports[1].memory.peak_bytes);
+        ++num_failures;
+    }
+    std::printf("%zu/%zu memory checks passed\n", std::size(kinds) * 2 + 3 - num_failures,
+                std::size(kinds) * 2 + 3);
+    return num_failures == 0 ? 0 : 1;
+}
+
+// Builds a program without text and checks it assembles to the same binary as its text
+static int check_builder()
+{
+    static const char text[] = R"(.dksh compute
+main:
+        S2R R0, SR_LANEID;
+        MOV32I R1, 0x3f800000;
+        SSY end;
+loop:
+        @!P0 FFMA.FTZ.SAT R2.CC, R0, -R1, c[0x3][0x10];
+        FADD R3, -|R2|, 0.5 @WAIT 3 @Y;
+        IADD.X R4, R3.reuse, -c[0x0][0x8];
+        IADD32I R5, R4, -0x10;
+        LOP.AND PT, R6, R5, ~R4;
+        LDG.E R7, [R6+0x4];
+        STG.E [R6], R7;
+        LDC.32 R8, c[0x0][R5-0x8];
+        ALD R9, a[0x70];
+        MOV %a:1, R9;
+        FMUL R10, %a:1, 2.5;
+        @P1 BRA loop;
+        SYNC;
+end:
+        EXIT;
+)";
+    using namespace nxas;
+    builder emit(".dksh compute\n");
+    const label main = emit.make_label("main");
+    const label loop = emit.make_label();
+    const label end = emit.make_label();
+    emit.place(main);
+    emit.s2r(gpr(0), keyword("SR_LANEID"));
+    emit.mov32i(gpr(1), immediate(0x3f800000));
+    emit.ssy(end);
+    emit.place(loop);
+    emit.guard(0, true).ffma(gpr(2).modifier("CC"), gpr(0), neg(gpr(1)), constant_buffer(3, 0x10),
+                             {"FTZ", "SAT"});
+    emit.schedule({.stall = 3, .yield = true}).fadd(gpr(3), neg(abs(gpr(2))), float_immediate(0.5));
+    emit.iadd(gpr(4), gpr(3, true), neg(constant_buffer(0, 8)), {"X"});
+    emit.iadd32i(gpr(5), gpr(4), immediate(-0x10));
+    emit.lop(predicate(PT), gpr(6), gpr(5), inv(gpr(4)), {"AND"});
+    emit.ldg(gpr(7), address(gpr(6), 4), {"E"});
+    emit.add("STG", {"E"}, {address(gpr(6)), gpr(7)});
+    emit.add("LDC", {"32"}, {gpr(8), constant_buffer(0, gpr(5), -8)});
+    emit.ald(gpr(9), attribute(0x70));
+    emit.mov(virtual_register("a", 1), gpr(9));
+    emit.fmul(gpr(10), virtual_register("a", 1), float_immediate(2.5));
+    emit.guard(1).bra(loop);
+    emit.sync();
+    emit.place(end);
+    emit.exit();
+
+    try {
+        report built_report;
+        report text_report;
+        const options options{.optimize = true};
+        const std::vector<uint64_t> built = emit.finish(options, &built_report);
+        if (built != assemble(text, "builder", options, &text_report)) {
+            std::fprintf(stderr, "built program doesn't assemble to the same code as its text\n");
+            return 1;
+        }
+        if (built_report.resources.num_gprs != text_report.resources.num_gprs) {
+            std::fprintf(stderr, "built program doesn't use the same resources as its text\n");
+            return 1;
+        }
+    } catch (const assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+
+    // Rejected instructions aren't added, branches to labels never placed fail when finishing
+    builder rejected;
+    try {
+        rejected.guard(0).add("IADD", {}, {gpr(0)});
+        std::fprintf(stderr, "instruction without enough operands was added\n");
+        return 1;
+    } catch (const assembly_error&) {
+    }
+    rejected.bra(rejected.make_label("nowhere"));
+    try {
+        (void)rejected.finish();
+        std::fprintf(stderr, "branch to a label never placed was assembled\n");
+        return 1;
+    } catch (const assembly_error& error) {
+        if (rejected.size() != 1 || error.line != 1) {
+            std::fprintf(stderr, "label never placed isn't reported at its branch\n");
+            return 1;
+        }
+    }
+    std::printf("built program matches its text\n");
+    return 0;
+}
+
+// Checks of whole programs, run with --<name>
+struct program_check
+{
+    const char* name;
+    int (*run)();
+};
+
+// Names of the files in a directory, sorted
+static std::vector<std::string> list_directory(const std::filesystem::path& directory)
+{
+    std::vector<std::string> names;
+    for (const std::filesystem::directory_entry& entry :
+         std::filesystem::directory_iterator(directory)) {
+        names.push_back(entry.path().filename().string());
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static std::vector<uint8_t> read_bytes(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>{file}, {}};
+}
+
+// Outputs are written to a mapped temporary file renamed over the output, failures must leave the
+// previous output alone and no temporary file behind
+static int check_output()
+{
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / ("nxas_output_" + std::to_string(stamp));
+    std::filesystem::create_directory(directory);
+    const std::string path = (directory / "out.bin").string();
+    size_t num_failures = 0;
+    const auto expect = [&](bool condition, const char* what) {
+        if (!condition) {
+            std::fprintf(stderr, "output: %s\n", what);
+            ++num_failures;
+        }
+    };
+    const auto expect_error = [&](const auto& write, const char* what) {
+        try {
+            write();
+            std::fprintf(stderr, "output: %s didn't fail\n", what);
+            ++num_failures;
+        } catch (const nxas::assembly_error&) {
+        }
+    };
+
+    const std::vector<uint8_t> first{1, 2, 3, 4, 5, 6, 7, 8};
+    write_output(path.c_str(), first.data(), first.size());
+    expect(read_bytes(path) == first, "written contents differ");
+
+    const std::vector<uint8_t> second(1 << 20, 0xA5);
+    write_output(path.c_str(), second.data(), second.size());
+    expect(read_bytes(path) == second, "replaced contents differ");
+
+    write_output(path.c_str(), nullptr, 0);
+    expect(std::filesystem::file_size(path) == 0, "empty output isn't empty");
+    write_output(path.c_str(), first.data(), first.size());
+
+    // Outputs destroyed without a commit are discarded
+    {
+        output_file file(path.c_str(), second.size());
+        std::memset(file.data().data(), 0, second.size());
+    }
+    expect(read_bytes(path) == first, "uncommitted output replaced the file");
+    expect(list_directory(directory) == std::vector<std::string>{"out.bin"},
+           "uncommitted output left a temporary file");
+
+    // Renaming over a directory fails after the temporary file is written
+    const std::filesystem::path blocked = directory / "blocked";
+    std::filesystem::create_directory(blocked);
+    expect_error([&] { write_output(blocked.string().c_str(), first.data(), first.size()); },
+                 "renaming over a directory");
+    expect(list_directory(directory) == std::vector<std::string>{"blocked", "out.bin"},
+           "failed rename left a temporary file");
+
+    expect_error(
+        [&] {
+            write_output((directory / "missing" / "out.bin").string().c_str(), first.data(),
+                         first.size());
+        },
+        "writing to a missing directory");
+
+#ifndef _WIN32
+    // Files can't grow past the size limit, allocating the temporary file fails
+    rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &limit);
+    const rlimit small{.rlim_cur = 1 << 16, .rlim_max = limit.rlim_max};
+    const auto previous_handler = std::signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &small);
+    expect_error([&] { write_output(path.c_str(), second.data(), second.size()); },
+                 "writing past the file size limit");
+    setrlimit(RLIMIT_FSIZE, &limit);
+    std::signal(SIGXFSZ, previous_handler);
+    expect(read_bytes(path) == first, "failed allocation replaced the file");
+    expect(list_directory(directory) == std::vector<std::string>{"blocked", "out.bin"},
+           "failed allocation left a temporary file");
+#endif
+
+    std::filesystem::remove_all(directory);
+    std::printf("%s\n", num_failures == 0 ? "output files passed" : "output files failed");
+    return num_failures == 0 ? 0 : 1;
+}
+
+// Value of a JSON document, only as much as checking generated documents needs
+struct json_value
+{
+    enum class kind
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object,
+    };
+    kind type = kind::null;
+    double number = 0;
+    std::string text;
+    std::vector<json_value> elements;
+    std::vector<std::pair<std::string, json_value>> members;
+
+    const json_value* find(std::string_view name) const
+    {
+        for (const auto& [key, value] : members) {
+            if (key == name) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Strict recursive descent reader, returns false on anything that isn't valid JSON
+class json_reader
+{
+  public:
+    explicit json_reader(std::string_view text_) : text{text_} {}
+
+    bool document(json_value& result)
+    {
+        return value(result) && (skip_spaces(), offset == text.size());
+    }
+
+  private:
+    void skip_spaces()
+    {
+        while (offset < text.size() && std::strchr(" \t\r\n", text[offset])) {
+            ++offset;
+        }
+    }
+
+    bool consume(std::string_view token)
+    {
+        if (text.substr(offset, token.size()) != token) {
+            return false;
+        }
+        offset += token.size();
+        return true;
+    }
+
+    bool string(std::string& result)
+    {
+        if (!consume("\"")) {
+            return false;
+        }
+        while (offset < text.size() && text[offset] != '"') {
+            const char character = text[offset++];
+            if (static_cast<unsigned char>(character) < 0x20) {
+                return false;
+            }
+            if (character != '\\') {
+                result += character;
+                continue;
+            }
+            if (offset == text.size()) {
+                return false;
+            }
+            const char escape = text[offset++];
+            if (escape == 'u') {
+                unsigned code = 0;
+                const char* const begin = text.data() + offset;
+                const auto [end, ec] = std::from_chars(begin, begin + 4, code, 16);
+                if (offset + 4 > text.size() || ec != std::errc{} || end != begin + 4) {
+                    return false;
+                }
+                offset += 4;
+                result += static_cast<char>(code);
+            } else if (std::strchr("\"\\/bfnrt", escape)) {
+                result += escape;
+            } else {
+                return false;
+            }
+        }
+        return consume("\"");
+    }
+
+    bool value(json_value& result)
+    {
+        skip_spaces();
+        if (offset == text.size()) {
+            return false;
+        }
+        switch (text[offset]) {
+        case '{':
+            ++offset;
+            result.type = json_value::kind::object;
+            skip_spaces();
+            if (consume("}")) {
+                return true;
+            }
+            do {
+                std::pair<std::string, json_value> member;
+                skip_spaces();
+                if (!string(member.first) || (skip_spaces(), !consume(":")) ||
+                    !value(member.second)) {
+                    return false;
+                }
+                result.members.push_back(std::move(member));
+                skip_spaces();
+            } while (consume(","));
+            return consume("}");
+        case '[':
+            ++offset;
+            result.type = json_value::kind::array;
+            skip_spaces();
+            if (consume("]")) {
+                return true;
+            }
+            do {
+                if (!value(result.elements.emplace_back())) {
+                    return false;
+                }
+                skip_spaces();
+            } while (consume(","));
+            return consume("]");
+        case '"':
+            result.type = json_value::kind::string;
+            return string(result.text);
+        default:
+            break;
+        }
+        if (consume("true") || consume("false")) {
+            result.type = json_value::kind::boolean;
+            return true;
+        }
+        if (consume("null")) {
+            return true;
+        }
+        const char* const begin = text.data() + offset;
+        const auto [end, ec] = std::from_chars(begin, text.data() + text.size(), result.number);
+        if (ec != std::errc{}) {
+            return false;
+        }
+        result.type = json_value::kind::number;
+        offset += static_cast<size_t>(end - begin);
+        return true;
+    }
+
+    std::string_view text;
+    size_t offset = 0;
+};
+
+// Checks a trace is valid JSON in the trace event format, returns the spans of files by name with
+// the thread that recorded them
+static std::optional<std::vector<std::pair<std::string, double>>> read_trace(
+    const std::string& trace)
+{
+    json_value root;
+    if (!json_reader(trace).document(root)) {
+        std::fprintf(stderr, "trace is not valid JSON:\n%s\n", trace.c_str());
+        return std::nullopt;
+    }
+    const json_value* const events = root.find("traceEvents");
+    if (!events || events->type != json_value::kind::array) {
+        std::fprintf(stderr, "trace has no event array\n");
+        return std::nullopt;
+    }
+    const auto has = [](const json_value& event, const char* name, json_value::kind type) {
+        const json_value* const member = event.find(name);
+        return member && member->type == type;
+    };
+    std::vector<std::pair<std::string, double>> files;
+    for (const json_value& event : events->elements) {
+        if (!has(event, "ph", json_value::kind::string) ||
+            !has(event, "name", json_value::kind::string) ||
+            !has(event, "pid", json_value::kind::number) ||
+            !has(event, "tid", json_value::kind::number) ||
+            !has(event, "args", json_value::kind::object)) {
+            std::fprintf(stderr, "trace event is missing fields\n");
+            return std::nullopt;
+        }
+        if (event.find("ph")->text == "M") {
+            continue;
+        }
+        if (event.find("ph")->text != "X" || !has(event, "cat", json_value::kind::string) ||
+            !has(event, "ts", json_value::kind::number) ||
+            !has(event, "dur", json_value::kind::number) || event.find("dur")->number < 0 ||
+            !has(*event.find("args"), "file", json_value::kind::string)) {
+            std::fprintf(stderr, "trace span is malformed\n");
+            return std::nullopt;
+        }
+        if (event.find("cat")->text == "file") {
+            files.emplace_back(event.find("args")->find("file")->text,
+                               event.find("tid")->number);
+        }
+    }
+    return files;
+}
+
+#ifndef _WIN32
+
+// Runs a program with the given input, returns what it wrote to stdout once it exits successfully
+static std::optional<std::string> run_program(const std::vector<std::string>& arguments,
+                                              const std::string& input)
+{
+    int input_pipe[2];
+    int output_pipe[2];
+    if (pipe(input_pipe) != 0 || pipe(output_pipe) != 0) {
+        return std::nullopt;
+    }
+    const pid_t child = fork();
+    if (child == 0) {
+        dup2(input_pipe[0], 0);
+        dup2(output_pipe[1], 1);
+        close(input_pipe[0]);
+        close(input_pipe[1]);
+        close(output_pipe[0]);
+        close(output_pipe[1]);
+        std::vector<char*> argv;
+        for (const std::string& argument : arguments) {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(input_pipe[0]);
+    close(output_pipe[1]);
+    // Input is written while the output is read, so neither pipe fills up and blocks the program
+    std::thread writer([&] {
+        for (size_t offset = 0; offset < input.size();) {
+            const ssize_t result =
+                write(input_pipe[1], input.data() + offset, input.size() - offset);
+            if (result <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(result);
+        }
+        close(input_pipe[1]);
+    });
+    std::string output;
+    char buffer[4096];
+    for (ssize_t size; (size = read(output_pipe[0], buffer, sizeof(buffer))) > 0;) {
+        output.append(buffer, static_cast<size_t>(size));
+    }
+    writer.join();
+    close(output_pipe[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::fprintf(stderr, "%s exited with status %d\n", arguments[0].c_str(), status);
+        return std::nullopt;
+    }
+    return output;
+}
+
+static void append_u32(std::string& output, uint32_t value)
+{
+    for (int byte = 0; byte < 4; ++byte) {
+        output += static_cast<char>((value >> (byte * 8)) & 0xFF);
+    }
+}
+
+// Request to the server as described in server.h, with default options
+static std::string server_request(uint32_t id, std::string_view filename, std::string_view code)
+{
+    std::string body;
+    append_u32(body, id);
+    append_u32(body, 0);
+    append_u32(body, 0);
+    append_u32(body, static_cast<uint32_t>(filename.size()));
+    body += filename;
+    body += code;
+    std::string request;
+    append_u32(request, static_cast<uint32_t>(body.size()));
+    return request + body;
+}
+
+#endif
+
+// Traces of assemblies on several threads have to be valid trace event JSON with a span for each
+// file, the server records one for each request it answers
+static int check_trace(const char* nxas_path)
+{
+    const char* const filenames[] = {"first.s", "second \"quoted\".s"};
+    nxas::start_trace();
+    try {
+        nxas::assemble("MOV R0, R1;\nEXIT;\n", filenames[0]);
+        std::thread([&] { nxas::assemble("L: BRA L;\n", filenames[1]); }).join();
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        static_cast<void>(nxas::finish_trace());
+        return 1;
+    }
+    const std::optional files = read_trace(nxas::finish_trace());
+    if (!files) {
+        return 1;
+    }
+    const std::vector<std::pair<std::string, double>>& spans = *files;
+    if (spans.size() != 2 || spans[0].first != filenames[0] || spans[1].first != filenames[1] ||
+        spans[0].second == spans[1].second) {
+        std::fprintf(stderr, "trace doesn't have a span of each file on its thread\n");
+        return 1;
+    }
+    // Starting a trace drops the spans of the previous one
+    nxas::start_trace();
+    const std::optional empty = read_trace(nxas::finish_trace());
+    if (!empty || !empty->empty()) {
+        std::fprintf(stderr, "a new trace kept the spans of the previous one\n");
+        return 1;
+    }
+
+#ifndef _WIN32
+    const std::string trace_path =
+        (std::filesystem::temp_directory_path() / ("nxas_trace_" + std::to_string(getpid())))
+            .string();
+    const std::string requests = server_request(1, "request one.s", "EXIT;\n") +
+                                 server_request(2, "request two.s", "NOP;\nEXIT;\n");
+    if (!run_program({nxas_path, "--server", "--jobs", "2", "--trace", trace_path}, requests)) {
+        return 1;
+    }
+    std::ifstream file(trace_path);
+    const std::string server_trace{std::istreambuf_iterator<char>{file}, {}};
+    std::filesystem::remove(trace_path);
+    const std::optional server_files = read_trace(server_trace);
+    if (!server_files) {
+        return 1;
+    }
+    for (const char* const request : {"request one.s", "request two.s"}) {
+        if (std::none_of(server_files->begin(), server_files->end(),
+                         [&](const auto& span) { return span.first == request; })) {
+            std::fprintf(stderr, "server trace has no span of %s\n", request);
+            return 1;
+        }
+    }
+#else
+    static_cast<void>(nxas_path);
+#endif
+    std::printf("traces passed\n");
     return 0;
 }
+
+#ifndef _WIN32
+
+struct server_diagnostic
+{
+    uint32_t severity = 0;
+    uint32_t line = 0;
+    uint32_t column = 0;
+    std::string message;
+};
+
+struct server_answer
+{
+    uint32_t status = 0;
+    std::vector<uint64_t> code;
+    std::vector<server_diagnostic> diagnostics;
+};
+
+class answer_reader
+{
+  public:
+    explicit answer_reader(std::string_view data_) : data{data_} {}
+
+    bool empty() const
+    {
+        return data.empty();
+    }
+
+    uint32_t u32()
+    {
+        uint32_t value = 0;
+        for (int byte = 0; byte < 4; ++byte) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(take(1)[0])) << (byte * 8);
+        }
+        return value;
+    }
+
+    uint64_t u64()
+    {
+        const uint64_t low = u32();
+        return low | static_cast<uint64_t>(u32()) << 32;
+    }
+
+    // Throws on data cut short, so a truncated answer fails the check
+    std::string_view take(size_t size)
+    {
+        if (size > data.size()) {
+            throw std::out_of_range("answer cut short");
+        }
+        const std::string_view result = data.substr(0, size);
+        data.remove_prefix(size);
+        return result;
+    }
+
+  private:
+    std::string_view data;
+};
+
+// Answers of the server as described in server.h, by request id
+static std::optional<std::map<uint32_t, server_answer>> read_answers(std::string_view output)
+{
+    std::map<uint32_t, server_answer> answers;
+    try {
+        answer_reader stream{output};
+        while (!stream.empty()) {
+            const uint32_t size = stream.u32();
+            answer_reader frame{stream.take(size)};
+            const uint32_t id = frame.u32();
+            server_answer answer;
+            answer.status = frame.u32();
+            answer.code.resize(frame.u32());
+            for (uint64_t& word : answer.code) {
+                word = frame.u64();
+            }
+            answer.diagnostics.resize(frame.u32());
+            for (server_diagnostic& diagnostic : answer.diagnostics) {
+                diagnostic.severity = frame.u32();
+                diagnostic.line = frame.u32();
+                diagnostic.column = frame.u32();
+                diagnostic.message = frame.take(frame.u32());
+            }
+            if (!frame.empty() || !answers.emplace(id, std::move(answer)).second) {
+                std::fprintf(stderr, "answer %u is malformed or repeated\n", id);
+                return std::nullopt;
+            }
+        }
+    } catch (const std::out_of_range& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return std::nullopt;
+    }
+    return answers;
+}
+
+static bool expect_error(const std::map<uint32_t, server_answer>& answers, uint32_t id,
+                         uint32_t line, uint32_t column, std::string_view message)
+{
+    const auto it = answers.find(id);
+    if (it == answers.end()) {
+        std::fprintf(stderr, "request %u wasn't answered\n", id);
+        return false;
+    }
+    const server_answer& answer = it->second;
+    if (answer.status != 1 || !answer.code.empty() || answer.diagnostics.size() != 1) {
+        std::fprintf(stderr, "request %u didn't fail with one diagnostic\n", id);
+        return false;
+    }
+    const server_diagnostic& diagnostic = answer.diagnostics[0];
+    if (diagnostic.severity != 0 || diagnostic.line != line || diagnostic.column != column ||
+        diagnostic.message != message) {
+        std::fprintf(stderr, "request %u: expected %u:%u: %.*s, got %u:%u: %s\n", id, line, column,
+                     static_cast<int>(message.size()), message.data(), diagnostic.line,
+                     diagnostic.column, diagnostic.message.c_str());
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+// The server reads requests from stdin and answers each with its code or the position and text of
+// its error, without the terminal colors of the command line
+static int check_server(const char* nxas_path)
+{
+#ifndef _WIN32
+    const char* const valid = "MOV R0, R1;\nEXIT;\n";
+    const std::string requests = server_request(1, "valid.s", valid) +
+                                 server_request(2, "mnemonic.s", "NOP;\nFOO R0;\n") +
+                                 server_request(3, "directive.s",
+                                                ".dksh compute\n.workgroup_size 1 x 1\nEXIT;\n");
+    const std::optional output = run_program({nxas_path, "--server", "--jobs", "2"}, requests);
+    if (!output) {
+        return 1;
+    }
+    const std::optional answers = read_answers(*output);
+    if (!answers) {
+        return 1;
+    }
+    if (answers->size() != 3) {
+        std::fprintf(stderr, "expected 3 answers, got %zu\n", answers->size());
+        return 1;
+    }
+    const auto valid_answer = answers->find(1);
+    if (valid_answer == answers->end() || valid_answer->second.status != 0 ||
+        !valid_answer->second.diagnostics.empty() ||
+        valid_answer->second.code != nxas::assemble(valid, "valid.s")) {
+        std::fprintf(stderr, "valid request wasn't answered with its code\n");
+        return 1;
+    }
+    if (!expect_error(*answers, 2, 2, 1, "unknown mnemonic FOO") ||
+        !expect_error(*answers, 3, 2, 19, "expected workgroup sizes")) {
+        return 1;
+    }
+#else
+    static_cast<void>(nxas_path);
+#endif
+    std::printf("server passed\n");
+    return 0;
+}
+
+// Images of every size have the same type, an empty shader is an empty std::array
+static_assert(std::is_same_v<decltype(embedded), const std::array<uint64_t, embedded.size()>>);
+static_assert(std::is_same_v<decltype(empty_shader), const std::array<uint64_t, 0>>);
+
+// The shader nxas_embed_shaders assembled while building the tester has to match its text
+// assembled now
+static int check_embedded()
+{
+    std::ifstream file(NXAS_EMBEDDED_SHADER);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "%s: failed to open\n", NXAS_EMBEDDED_SHADER);
+        return 1;
+    }
+    const std::string text{std::istreambuf_iterator<char>{file}, {}};
+    try {
+        const std::vector<uint64_t> code = nxas::assemble(text, NXAS_EMBEDDED_SHADER);
+        if (!std::equal(code.begin(), code.end(), embedded.begin(), embedded.end())) {
+            std::fprintf(stderr, "%s: embedded shader doesn't match its text\n",
+                         NXAS_EMBEDDED_SHADER);
+            return 1;
+        }
+    } catch (const nxas::assembly_error& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    std::printf("embedded shader of %zu words passed\n", embedded.size());
+    return 0;
+}
+
+static const program_check program_checks[] = {
+    {"occupancy", check_occupancy},
+    {"optimize", check_optimize},
+    {"resources", check_resources},
+    {"session", check_session},
+    {"sharing", check_sharing},
+    {"yields", check_yields},
+    {"builder", check_builder},
+    {"allocator", check_allocator},
+    {"memory", check_memory},
+    {"headers", check_headers},
+    {"lines", check_lines},
+    {"link", check_link},
+    {"candidates", check_candidates},
+    {"embedded", check_embedded},
+    {"output", check_output},
+    {"time-report", check_time_report},
+};
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "--corpus") == 0) {
+        return check_corpus(std::strtoull(argv[2], nullptr, 10));
+    }
+    if (argc == 3 && std::strcmp(argv[1], "--trace") == 0) {
+        return check_trace(argv[2]);
+    }
+    if (argc == 3 && std::strcmp(argv[1], "--server") == 0) {
+        return check_server(argv[2]);
+    }
+    for (const program_check& check : program_checks) {
+        if (argc == 2 && argv[1][0] == '-' && argv[1][1] == '-' &&
+            std::strcmp(argv[1] + 2, check.name) == 0) {
+            return check.run();
+        }
+    }
+    if (argc != 2 || argv[1][0] == '-') {
+        std::fprintf(stderr,
+                     "%s usage: <vector file> | --corpus <instructions> | --trace <nxas> | "
+                     "--server <nxas>",
+                     argv[0]);
+        for (const program_check& check : program_checks) {
+            std::fprintf(stderr, " | --%s", check.name);
+        }
+        std::fprintf(stderr, "\n");
+        return 1;
+    }
+    std::ifstream file(argv[1]);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "%s: failed to open\n", argv[1]);
+        return 1;
+    }
+    std::vector<vector> vectors;
+    std::string line;
+    for (int line_number = 1; std::getline(file, line); ++line_number) {
+        const std::string_view text = trim(std::string_view{line}.substr(0, line.find('#')));
+        if (text.empty()) {
+            continue;
+        }
+        vector vector{.line = line_number};
+        if (!parse_vector(text, vector)) {
+            std::fprintf(stderr, "%s:%d: expected an opcode or \"fail\" and an instruction\n",
+                         argv[1], line_number);
+            return 1;
+        }
+        vectors.push_back(std::move(vector));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t num_failures = 0;
+    for (const vector& vector : vectors) {
+        const std::string message = check(vector);
+        if (!message.empty()) {
+            std::fprintf(stderr, "%s:%d: %s\n%s\n\n", argv[1], vector.line,
+                         vector.expression.c_str(), message.c_str());
+            ++num_failures;
+        }
+    }
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("%zu/%zu vectors passed in %.1f ms\n", vectors.size() - num_failures,
+                vectors.size(), elapsed.count());
+    return num_failures == 0 ? 0 : 1;
+}